@@ -0,0 +1,34 @@
+#version 450
+// FXAA-style edge smoothing of the resolved scene: luma contrast over the
+// diagonal neighbours finds edges, which are blended along their direction.
+// params[0].x is the relative contrast threshold, params[0].y the longest
+// blend span in pixels.
+layout(location = 0) in vec2 v_uv;
+layout(location = 0) out vec4 out_col;
+layout(set = 2, binding = 0) uniform sampler2D input0;
+layout(set = 3, binding = 0) uniform PostParams { vec4 params[8]; };
+float luma(vec3 c) {
+    return dot(c, vec3(0.299, 0.587, 0.114));
+}
+void main() {
+    vec2 texel = 1.0 / vec2(textureSize(input0, 0));
+    vec4 center = texture(input0, v_uv);
+    float lm = luma(center.rgb);
+    float lnw = luma(texture(input0, v_uv + vec2(-1.0, -1.0) * texel).rgb);
+    float lne = luma(texture(input0, v_uv + vec2(1.0, -1.0) * texel).rgb);
+    float lsw = luma(texture(input0, v_uv + vec2(-1.0, 1.0) * texel).rgb);
+    float lse = luma(texture(input0, v_uv + vec2(1.0, 1.0) * texel).rgb);
+    float lmin = min(lm, min(min(lnw, lne), min(lsw, lse)));
+    float lmax = max(lm, max(max(lnw, lne), max(lsw, lse)));
+    if (lmax - lmin < max(0.0312, lmax * params[0].x)) {
+        out_col = center;
+        return;
+    }
+    vec2 dir = vec2(-((lnw + lne) - (lsw + lse)), (lnw + lsw) - (lne + lse));
+    float reduce = max((lnw + lne + lsw + lse) * (0.25 / 8.0), 1.0 / 128.0);
+    dir = clamp(dir / (min(abs(dir.x), abs(dir.y)) + reduce), vec2(-params[0].y), vec2(params[0].y)) * texel;
+    vec3 a = 0.5 * (texture(input0, v_uv + dir * (1.0 / 3.0 - 0.5)).rgb + texture(input0, v_uv + dir * (2.0 / 3.0 - 0.5)).rgb);
+    vec3 b = a * 0.5 + 0.25 * (texture(input0, v_uv - dir * 0.5).rgb + texture(input0, v_uv + dir * 0.5).rgb);
+    float lb = luma(b);
+    out_col = vec4(lb < lmin || lb > lmax ? a : b, center.a);
+}
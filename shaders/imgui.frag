@@ -0,0 +1,8 @@
+#version 450
+layout(location = 0) in vec2 v_uv;
+layout(location = 1) in vec4 v_col;
+layout(set = 2, binding = 0) uniform sampler2D tex;
+layout(location = 0) out vec4 out_col;
+void main() {
+    out_col = v_col * texture(tex, v_uv);
+}
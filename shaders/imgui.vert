@@ -0,0 +1,12 @@
+#version 450
+layout(location = 0) in vec2 in_pos;
+layout(location = 1) in vec2 in_uv;
+layout(location = 2) in vec4 in_col;
+layout(set = 1, binding = 0) uniform Projection { mat4 proj; };
+layout(location = 0) out vec2 v_uv;
+layout(location = 1) out vec4 v_col;
+void main() {
+    v_uv = in_uv;
+    v_col = in_col;
+    gl_Position = proj * vec4(in_pos, 0.0, 1.0);
+}
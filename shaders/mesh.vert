@@ -0,0 +1,17 @@
+#version 450
+layout(location = 0) in vec3 in_pos;
+layout(location = 1) in vec4 in_normal;
+layout(location = 2) in vec2 in_uv;
+layout(location = 3) in vec2 in_offset;
+layout(location = 4) in float in_scale;
+layout(location = 0) out vec3 v_col;
+layout(std140, set = 1, binding = 0) uniform View {
+    vec2 pan;
+    float zoom;
+};
+void main() {
+    vec3 n = normalize(in_normal.xyz);
+    float light = 0.25 + 0.75 * max(dot(n, normalize(vec3(0.4, 0.6, -0.7))), 0.0);
+    v_col = vec3(light) * vec3(0.8 + 0.2 * in_uv.x, 0.8, 0.8 + 0.2 * in_uv.y);
+    gl_Position = vec4((in_pos.xy * in_scale + in_offset) * zoom + pan, in_pos.z * 0.5 * in_scale + 0.5, 1.0);
+}
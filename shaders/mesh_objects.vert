@@ -0,0 +1,25 @@
+#version 450
+// mesh.vert with the instance data read from the object buffer
+// (ObjectRecord in src/object_buffer.h) instead of an instance stream.
+layout(location = 0) in vec3 in_pos;
+layout(location = 1) in vec4 in_normal;
+layout(location = 2) in vec2 in_uv;
+layout(location = 0) out vec3 v_col;
+struct Object {
+    vec2 offset;
+    float scale;
+    uint material;
+};
+layout(std430, set = 0, binding = 0) readonly buffer Objects { Object objects[]; };
+layout(std140, set = 1, binding = 0) uniform View {
+    vec2 pan;
+    float zoom;
+};
+const vec3 tints[4] = vec3[](vec3(1.0), vec3(1.0, 0.7, 0.7), vec3(0.7, 1.0, 0.7), vec3(0.7, 0.7, 1.0));
+void main() {
+    Object o = objects[gl_InstanceIndex];
+    vec3 n = normalize(in_normal.xyz);
+    float light = 0.25 + 0.75 * max(dot(n, normalize(vec3(0.4, 0.6, -0.7))), 0.0);
+    v_col = vec3(light) * vec3(0.8 + 0.2 * in_uv.x, 0.8, 0.8 + 0.2 * in_uv.y) * tints[o.material & 3u];
+    gl_Position = vec4((in_pos.xy * o.scale + o.offset) * zoom + pan, in_pos.z * 0.5 * o.scale + 0.5, 1.0);
+}
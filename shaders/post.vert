@@ -0,0 +1,8 @@
+#version 450
+// Fullscreen triangle for the post chain; no vertex buffer.
+layout(location = 0) out vec2 v_uv;
+void main() {
+    vec2 p = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    v_uv = vec2(p.x, 1.0 - p.y);
+    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,16 @@
+#version 450
+// One direction of a 9-tap Gaussian; params[0].xy is the step in texels.
+layout(location = 0) in vec2 v_uv;
+layout(location = 0) out vec4 out_col;
+layout(set = 2, binding = 0) uniform sampler2D input0;
+layout(set = 3, binding = 0) uniform PostParams { vec4 params[8]; };
+void main() {
+    vec2 dir = params[0].xy / vec2(textureSize(input0, 0));
+    const float w[5] = float[](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
+    vec4 c = texture(input0, v_uv) * w[0];
+    for (int i = 1; i < 5; i++) {
+        c += texture(input0, v_uv + dir * float(i)) * w[i];
+        c += texture(input0, v_uv - dir * float(i)) * w[i];
+    }
+    out_col = c;
+}
@@ -0,0 +1,7 @@
+// Per-pixel: saturation (params.x) and contrast around mid grey (params.y).
+vec4 apply(vec4 color, vec4 params) {
+    float luma = dot(color.rgb, vec3(0.2126, 0.7152, 0.0722));
+    vec3 c = mix(vec3(luma), color.rgb, params.x);
+    c = (c - 0.5) * params.y + 0.5;
+    return vec4(clamp(c, 0.0, 1.0), color.a);
+}
@@ -0,0 +1,13 @@
+#version 450
+// Unsharp mask: input0 plus params[0].x times its difference from the
+// blurred input1.
+layout(location = 0) in vec2 v_uv;
+layout(location = 0) out vec4 out_col;
+layout(set = 2, binding = 0) uniform sampler2D input0;
+layout(set = 2, binding = 1) uniform sampler2D input1;
+layout(set = 3, binding = 0) uniform PostParams { vec4 params[8]; };
+void main() {
+    vec4 c = texture(input0, v_uv);
+    vec4 blurred = texture(input1, v_uv);
+    out_col = vec4(clamp(c.rgb + (c.rgb - blurred.rgb) * params[0].x, 0.0, 1.0), c.a);
+}
@@ -0,0 +1,6 @@
+// Per-pixel: exposure (params.x) then the ACES filmic fit.
+vec4 apply(vec4 color, vec4 params) {
+    vec3 x = color.rgb * params.x;
+    vec3 y = (x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14);
+    return vec4(clamp(y, 0.0, 1.0), color.a);
+}
@@ -0,0 +1,26 @@
+#version 450
+// Temporal AA: the jittered current frame blended into the accumulated
+// history. There are no motion vectors; clamping the history to the current
+// 3x3 neighbourhood is what keeps moving objects from smearing.
+// params[0].x is the current frame's weight.
+layout(location = 0) in vec2 v_uv;
+layout(location = 0) out vec4 out_col;
+layout(set = 2, binding = 0) uniform sampler2D input0;
+layout(set = 2, binding = 1) uniform sampler2D input1;
+layout(set = 3, binding = 0) uniform PostParams { vec4 params[8]; };
+void main() {
+    vec2 texel = 1.0 / vec2(textureSize(input0, 0));
+    vec4 cur = texture(input0, v_uv);
+    vec3 lo = cur.rgb;
+    vec3 hi = cur.rgb;
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            vec3 s = texture(input0, v_uv + vec2(x, y) * texel).rgb;
+            lo = min(lo, s);
+            hi = max(hi, s);
+        }
+    }
+    vec3 history = clamp(texture(input1, v_uv).rgb, lo, hi);
+    float w = params[7].x > 0.5 ? params[0].x : 1.0;
+    out_col = vec4(mix(history, cur.rgb, w), cur.a);
+}
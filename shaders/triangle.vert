@@ -1,8 +1,14 @@
 #version 450
 layout(location = 0) in vec2 in_pos;
 layout(location = 1) in vec3 in_col;
+layout(location = 2) in vec2 in_offset;
+layout(location = 3) in float in_scale;
 layout(location = 0) out vec3 v_col;
+layout(std140, set = 1, binding = 0) uniform View {
+    vec2 pan;
+    float zoom;
+};
 void main() {
     v_col = in_col;
-    gl_Position = vec4(in_pos, 0.0, 1.0);
+    gl_Position = vec4((in_pos * in_scale + in_offset) * zoom + pan, 0.0, 1.0);
 }
@@ -0,0 +1,22 @@
+#version 450
+// triangle.vert with the instance data read from the object buffer
+// (ObjectRecord in src/object_buffer.h) instead of an instance stream.
+layout(location = 0) in vec2 in_pos;
+layout(location = 1) in vec3 in_col;
+layout(location = 0) out vec3 v_col;
+struct Object {
+    vec2 offset;
+    float scale;
+    uint material;
+};
+layout(std430, set = 0, binding = 0) readonly buffer Objects { Object objects[]; };
+layout(std140, set = 1, binding = 0) uniform View {
+    vec2 pan;
+    float zoom;
+};
+const vec3 tints[4] = vec3[](vec3(1.0), vec3(1.0, 0.7, 0.7), vec3(0.7, 1.0, 0.7), vec3(0.7, 0.7, 1.0));
+void main() {
+    Object o = objects[gl_InstanceIndex];
+    v_col = in_col * tints[o.material & 3u];
+    gl_Position = vec4((in_pos * o.scale + o.offset) * zoom + pan, 0.0, 1.0);
+}
@@ -0,0 +1,142 @@
+#include "arena.h"
+#include <cstdarg>
+#include <cstdint>
+
+struct alignas(std::max_align_t) ArenaBlock {
+    ArenaBlock* next;
+    size_t size;
+    size_t used;
+};
+
+static Uint8* block_data(ArenaBlock* b) {
+    return reinterpret_cast<Uint8*>(b + 1);
+}
+
+static void* bump(Arena& arena, ArenaBlock* b, size_t size, size_t align) {
+    uintptr_t base = (uintptr_t)block_data(b);
+    uintptr_t p = (base + b->used + align - 1) & ~(uintptr_t)(align - 1);
+    if (p + size > base + b->size) return nullptr;
+    arena.used += p + size - (base + b->used);
+    arena.high_water = SDL_max(arena.high_water, arena.used);
+    b->used = p + size - base;
+    return (void*)p;
+}
+
+void* arena_alloc(Arena& arena, size_t size, size_t align) {
+    if (size == 0) size = 1;
+    while (arena.current) {
+        if (void* p = bump(arena, arena.current, size, align)) return p;
+        if (!arena.current->next) break;
+        // A block left over from a rewind or an earlier spill.
+        arena.current = arena.current->next;
+        arena.current->used = 0;
+    }
+    size_t capacity = SDL_max(arena.block_size, size + align);
+    ArenaBlock* b = static_cast<ArenaBlock*>(SDL_malloc(sizeof(ArenaBlock) + capacity));
+    if (!b) return nullptr;
+    b->next = nullptr;
+    b->size = capacity;
+    b->used = 0;
+    if (arena.current)
+        arena.current->next = b;
+    else
+        arena.first = b;
+    arena.current = b;
+    arena.mallocs++;
+    arena.total_mallocs++;
+    return bump(arena, b, size, align);
+}
+
+ArenaMark arena_mark(const Arena& arena) {
+    ArenaMark m;
+    m.block = arena.current;
+    m.block_used = arena.current ? arena.current->used : 0;
+    m.used = arena.used;
+    return m;
+}
+
+void arena_rewind(Arena& arena, const ArenaMark& mark) {
+    // Blocks past the mark's stay in the chain and are reused from the start.
+    if (mark.block) {
+        arena.current = mark.block;
+        arena.current->used = mark.block_used;
+    } else if (arena.first) {
+        arena.current = arena.first;
+        arena.current->used = 0;
+    }
+    arena.used = mark.used;
+}
+
+void arena_reset(Arena& arena) {
+    arena.last_used = arena.used;
+    arena.last_mallocs = arena.mallocs;
+    if (arena.first && arena.current != arena.first) {
+        // Spilled: the next frame gets one block as large as all of these.
+        size_t total = 0;
+        for (ArenaBlock* b = arena.first; b;) {
+            ArenaBlock* next = b->next;
+            total += b->size;
+            SDL_free(b);
+            b = next;
+        }
+        arena.first = arena.current = nullptr;
+        arena.block_size = SDL_max(arena.block_size, total);
+    }
+    if (arena.first) {
+        arena.current = arena.first;
+        arena.current->used = 0;
+    }
+    arena.used = 0;
+    arena.mallocs = 0;
+}
+
+void arena_destroy(Arena& arena) {
+    for (ArenaBlock* b = arena.first; b;) {
+        ArenaBlock* next = b->next;
+        SDL_free(b);
+        b = next;
+    }
+    arena.first = arena.current = nullptr;
+    arena.used = 0;
+}
+
+const char* arena_printf(Arena& arena, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    va_list ap2;
+    va_copy(ap2, ap);
+    int len = SDL_vsnprintf(nullptr, 0, fmt, ap);
+    va_end(ap);
+    char* out = len >= 0 ? static_cast<char*>(arena_alloc(arena, (size_t)len + 1, 1)) : nullptr;
+    if (out) SDL_vsnprintf(out, (size_t)len + 1, fmt, ap2);
+    va_end(ap2);
+    return out ? out : "";
+}
+
+ArenaStats arena_stats(const Arena& arena) {
+    ArenaStats s;
+    s.used = arena.last_used;
+    s.mallocs = arena.last_mallocs;
+    s.high_water = arena.high_water;
+    for (ArenaBlock* b = arena.first; b; b = b->next) {
+        s.capacity += b->size;
+        s.blocks++;
+    }
+    s.total_mallocs = arena.total_mallocs;
+    return s;
+}
+
+namespace {
+
+struct ScratchArena {
+    Arena arena;
+    ~ScratchArena() { arena_destroy(arena); }
+};
+
+thread_local ScratchArena t_scratch;
+
+}
+
+Arena& arena_scratch() {
+    return t_scratch.arena;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <SDL3/SDL.h>
+
+struct ArenaBlock;
+
+struct ArenaStats {
+    // Bytes handed out and blocks malloc'd between the last two resets.
+    Uint64 used = 0;
+    Uint32 mallocs = 0;
+    Uint64 high_water = 0;
+    Uint64 capacity = 0;
+    Uint32 blocks = 0;
+    Uint64 total_mallocs = 0;
+};
+
+// Linear allocator for memory that dies together: allocations bump a pointer
+// through a chain of blocks and are never freed one by one, only rewound to a
+// mark or reset as a whole. Blocks are kept across resets; when a frame spills
+// into more than one, the reset replaces them with a single block of their
+// combined size, so after the first few frames a steady workload allocates
+// from one block and never calls malloc. One thread at a time.
+struct Arena {
+    ArenaBlock* first = nullptr;
+    ArenaBlock* current = nullptr;
+    size_t block_size = 64 * 1024;
+    size_t used = 0;
+    size_t high_water = 0;
+    Uint32 mallocs = 0;
+    Uint64 total_mallocs = 0;
+    // The frame before the last reset, for stats.
+    size_t last_used = 0;
+    Uint32 last_mallocs = 0;
+};
+
+struct ArenaMark {
+    ArenaBlock* block = nullptr;
+    size_t block_used = 0;
+    size_t used = 0;
+};
+
+// Null only when malloc fails.
+void* arena_alloc(Arena& arena, size_t size, size_t align = alignof(std::max_align_t));
+ArenaMark arena_mark(const Arena& arena);
+// Frees everything allocated since `mark` was taken.
+void arena_rewind(Arena& arena, const ArenaMark& mark);
+void arena_reset(Arena& arena);
+void arena_destroy(Arena& arena);
+// printf into the arena; "" when out of memory.
+const char* arena_printf(Arena& arena, SDL_PRINTF_FORMAT_STRING const char* fmt, ...) SDL_PRINTF_VARARG_FUNC(2);
+ArenaStats arena_stats(const Arena& arena);
+
+// The calling thread's scratch arena. The main and render threads reset
+// theirs once per frame; job threads rewind theirs after every job, so a job
+// may use it freely without a scope of its own.
+Arena& arena_scratch();
+
+// Rewinds to where the arena was on construction.
+struct ArenaScope {
+    Arena& arena;
+    ArenaMark mark;
+    explicit ArenaScope(Arena& a) : arena(a), mark(arena_mark(a)) {}
+    ~ArenaScope() { arena_rewind(arena, mark); }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+};
+
+// For standard containers whose storage lives no longer than the arena's
+// next rewind or reset. Growing leaves the old storage behind until then.
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+    Arena* arena;
+
+    explicit ArenaAllocator(Arena& a) : arena(&a) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        void* p = arena_alloc(*arena, n * sizeof(T), alignof(T));
+        if (!p) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+    void deallocate(T*, size_t) {}
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+    return a.arena == b.arena;
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+    return a.arena != b.arena;
+}
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
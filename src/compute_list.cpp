@@ -0,0 +1,58 @@
+#include "compute_list.h"
+#include <cstring>
+
+Uint32 compute_groups(Uint32 items, Uint32 threads) {
+    if (threads == 0) threads = 1;
+    return (items + threads - 1) / threads;
+}
+
+bool compute_set_uniforms(ComputeDispatch& dispatch, const void* data, Uint32 size) {
+    if (size > COMPUTE_MAX_UNIFORM_BYTES) return false;
+    std::memcpy(dispatch.uniforms, data, size);
+    dispatch.uniform_size = size;
+    return true;
+}
+
+void compute_list_push(ComputeList& list, const ComputeDispatch& dispatch) {
+    if (!dispatch.pipeline || dispatch.groups_x == 0 || dispatch.groups_y == 0 || dispatch.groups_z == 0) return;
+    list.dispatches.push_back(dispatch);
+}
+
+static bool same_targets(const ComputeDispatch& a, const ComputeDispatch& b) {
+    if (a.num_rw_buffers != b.num_rw_buffers || a.num_rw_textures != b.num_rw_textures) return false;
+    for (Uint32 i = 0; i < a.num_rw_buffers; i++)
+        if (a.rw_buffers[i].buffer != b.rw_buffers[i].buffer || b.rw_buffers[i].cycle) return false;
+    for (Uint32 i = 0; i < a.num_rw_textures; i++) {
+        const SDL_GPUStorageTextureReadWriteBinding& x = a.rw_textures[i];
+        const SDL_GPUStorageTextureReadWriteBinding& y = b.rw_textures[i];
+        if (x.texture != y.texture || x.mip_level != y.mip_level || x.layer != y.layer || y.cycle) return false;
+    }
+    return true;
+}
+
+void compute_list_record(ComputeList& list, SDL_GPUCommandBuffer* cb) {
+    ComputeListStats stats;
+    SDL_GPUComputePass* pass = nullptr;
+    const ComputeDispatch* prev = nullptr;
+    for (const ComputeDispatch& d : list.dispatches) {
+        if (!pass || !d.independent || !same_targets(*prev, d)) {
+            if (pass) SDL_EndGPUComputePass(pass);
+            pass = SDL_BeginGPUComputePass(cb, d.rw_textures, d.num_rw_textures, d.rw_buffers, d.num_rw_buffers);
+            if (!pass) break;
+            stats.passes++;
+        }
+        SDL_BindGPUComputePipeline(pass, d.pipeline);
+        if (d.num_ro_textures) SDL_BindGPUComputeStorageTextures(pass, 0, d.ro_textures, d.num_ro_textures);
+        if (d.num_ro_buffers) SDL_BindGPUComputeStorageBuffers(pass, 0, d.ro_buffers, d.num_ro_buffers);
+        if (d.uniform_size) SDL_PushGPUComputeUniformData(cb, 0, d.uniforms, d.uniform_size);
+        SDL_DispatchGPUCompute(pass, d.groups_x, d.groups_y, d.groups_z);
+        stats.dispatches++;
+        prev = &d;
+    }
+    if (pass) SDL_EndGPUComputePass(pass);
+    list.last_stats = stats;
+}
+
+void compute_list_reset(ComputeList& list) {
+    list.dispatches.clear();
+}
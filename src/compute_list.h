@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include <SDL3/SDL_gpu.h>
+
+static const Uint32 COMPUTE_MAX_BUFFERS = 4;
+static const Uint32 COMPUTE_MAX_TEXTURES = 4;
+static const Uint32 COMPUTE_MAX_UNIFORM_BYTES = 64;
+
+// One dispatch with everything it binds. Read-write resources are bound when
+// the compute pass begins, and SDL_GPU does not order the dispatches inside a
+// pass against each other, so each dispatch gets a pass of its own unless it
+// is marked independent.
+struct ComputeDispatch {
+    SDL_GPUComputePipeline* pipeline = nullptr;
+    SDL_GPUStorageBufferReadWriteBinding rw_buffers[COMPUTE_MAX_BUFFERS] = {};
+    Uint32 num_rw_buffers = 0;
+    SDL_GPUStorageTextureReadWriteBinding rw_textures[COMPUTE_MAX_TEXTURES] = {};
+    Uint32 num_rw_textures = 0;
+    SDL_GPUBuffer* ro_buffers[COMPUTE_MAX_BUFFERS] = {};
+    Uint32 num_ro_buffers = 0;
+    SDL_GPUTexture* ro_textures[COMPUTE_MAX_TEXTURES] = {};
+    Uint32 num_ro_textures = 0;
+    // Pushed to uniform slot 0 before the dispatch when non-empty.
+    Uint8 uniforms[COMPUTE_MAX_UNIFORM_BYTES] = {};
+    Uint32 uniform_size = 0;
+    Uint32 groups_x = 1;
+    Uint32 groups_y = 1;
+    Uint32 groups_z = 1;
+    // Set by the caller when the dispatch neither reads nor writes anything
+    // the previous one writes (disjoint ranges of the same targets, say); it
+    // then shares that dispatch's pass if it binds the same read-write
+    // resources.
+    bool independent = false;
+};
+
+struct ComputeListStats {
+    Uint32 dispatches = 0;
+    Uint32 passes = 0;
+};
+
+// Compute work recorded into the frame's command buffer ahead of the scene
+// pass, in push order.
+struct ComputeList {
+    std::vector<ComputeDispatch> dispatches;
+    ComputeListStats last_stats;
+};
+
+// Workgroups needed to cover `items` at `threads` per group.
+Uint32 compute_groups(Uint32 items, Uint32 threads);
+
+// Copies `size` bytes into the dispatch's uniform block; false if too large.
+bool compute_set_uniforms(ComputeDispatch& dispatch, const void* data, Uint32 size);
+
+void compute_list_push(ComputeList& list, const ComputeDispatch& dispatch);
+void compute_list_record(ComputeList& list, SDL_GPUCommandBuffer* cb);
+// Resets the dispatches for the next frame.
+void compute_list_reset(ComputeList& list);
@@ -0,0 +1,219 @@
+#include "draw_list.h"
+#include <cstdint>
+#include <cstring>
+
+Uint64 draw_key(Uint32 pass, Uint32 pipeline, Uint32 material, Uint32 buffers, Uint32 depth) {
+    return ((Uint64)(pass & 0xfu) << 60) | ((Uint64)(pipeline & 0xfffu) << 48) | ((Uint64)(material & 0xfffu) << 36) |
+           ((Uint64)(buffers & 0xfffu) << 24) | (Uint64)(depth & 0xffffffu);
+}
+
+Uint32 draw_key_pass(Uint64 key) {
+    return (Uint32)(key >> 60);
+}
+
+Uint32 draw_key_id(const void* p, Uint32 bits) {
+    Uint64 v = (Uint64)(uintptr_t)p;
+    v ^= v >> 33;
+    v *= 0xff51afd7ed558ccdull;
+    v ^= v >> 33;
+    return (Uint32)v & ((1u << bits) - 1u);
+}
+
+void draw_list_push(DrawList& list, const DrawItem& item) {
+    list.items.push_back(item);
+    list.sorted = false;
+}
+
+Uint32 draw_list_stage_uniforms(DrawList& list, const void* data, Uint32 size) {
+    std::vector<Uint8>& area = list.uniform_data;
+    if (list.last_uniform != UINT32_MAX && list.last_uniform + size == area.size() && std::memcmp(area.data() + list.last_uniform, data, size) == 0)
+        return list.last_uniform;
+    Uint32 offset = (Uint32)((area.size() + 15u) & ~(size_t)15u);
+    area.resize(offset + size);
+    std::memcpy(area.data() + offset, data, size);
+    list.last_uniform = offset;
+    return offset;
+}
+
+// LSD radix sort of item indices by key, one byte per pass. Passes where all
+// keys share the byte are skipped, so the usual handful of distinct passes and
+// pipelines costs two or three passes rather than eight.
+void draw_list_sort(DrawList& list) {
+    Uint32 n = (Uint32)list.items.size();
+    list.order.resize(n);
+    list.scratch.resize(n);
+    for (Uint32 i = 0; i < n; i++) list.order[i] = i;
+    list.stats.sort_passes = 0;
+    for (Uint32 shift = 0; shift < 64 && n > 1; shift += 8) {
+        Uint32 hist[256];
+        std::memset(hist, 0, sizeof(hist));
+        for (Uint32 i = 0; i < n; i++) hist[(list.items[i].key >> shift) & 0xff]++;
+        if (hist[(list.items[0].key >> shift) & 0xff] == n) continue;
+        Uint32 sum = 0;
+        for (Uint32 b = 0; b < 256; b++) {
+            Uint32 c = hist[b];
+            hist[b] = sum;
+            sum += c;
+        }
+        for (Uint32 i = 0; i < n; i++) {
+            Uint32 idx = list.order[i];
+            list.scratch[hist[(list.items[idx].key >> shift) & 0xff]++] = idx;
+        }
+        list.order.swap(list.scratch);
+        list.stats.sort_passes++;
+    }
+    list.sorted = true;
+}
+
+static bool same_binding(const SDL_GPUBufferBinding& a, const SDL_GPUBufferBinding& b) {
+    return a.buffer == b.buffer && a.offset == b.offset;
+}
+
+void draw_list_pass_range(const DrawList& list, Uint32 pass, Uint32* begin, Uint32* end) {
+    Uint32 lo = 0, hi = (Uint32)list.order.size();
+    while (lo < hi) {
+        Uint32 mid = (lo + hi) / 2;
+        if (draw_key_pass(list.items[list.order[mid]].key) < pass) lo = mid + 1;
+        else hi = mid;
+    }
+    *begin = lo;
+    hi = (Uint32)list.order.size();
+    while (lo < hi) {
+        Uint32 mid = (lo + hi) / 2;
+        if (draw_key_pass(list.items[list.order[mid]].key) <= pass) lo = mid + 1;
+        else hi = mid;
+    }
+    *end = lo;
+}
+
+void draw_list_emit(DrawList& list, SDL_GPUCommandBuffer* cb, SDL_GPURenderPass* rp, Uint32 pass) {
+    if (!list.sorted) draw_list_sort(list);
+    Uint32 begin, end;
+    draw_list_pass_range(list, pass, &begin, &end);
+    draw_list_emit_range(list, cb, rp, begin, end, list.stats);
+}
+
+void draw_list_emit_range(const DrawList& list, SDL_GPUCommandBuffer* cb, SDL_GPURenderPass* rp, Uint32 begin, Uint32 end, DrawListStats& stats) {
+    SDL_GPUGraphicsPipeline* pipeline = nullptr;
+    SDL_GPUBufferBinding vertex[DRAW_MAX_VERTEX_BUFFERS] = {};
+    Uint32 num_vertex = 0;
+    SDL_GPUBufferBinding index = {};
+    SDL_GPUIndexElementSize index_size = SDL_GPU_INDEXELEMENTSIZE_16BIT;
+    SDL_GPUTextureSamplerBinding samplers[DRAW_MAX_SAMPLERS] = {};
+    Uint32 num_samplers = 0;
+    SDL_GPUBuffer* storage[DRAW_MAX_STORAGE_BUFFERS] = {};
+    Uint32 num_storage = 0;
+    // Offset last pushed per stage and slot; uniform state starts empty with
+    // each command buffer, hence per call.
+    Uint32 pushed[2][DRAW_MAX_UNIFORMS];
+    std::memset(pushed, 0xff, sizeof(pushed));
+
+    for (Uint32 i = begin; i < end; i++) {
+        const DrawItem& it = list.items[list.order[i]];
+        if (!it.pipeline || it.count == 0) continue;
+        stats.items++;
+
+        if (it.pipeline != pipeline) {
+            SDL_BindGPUGraphicsPipeline(rp, it.pipeline);
+            pipeline = it.pipeline;
+            stats.pipeline_binds++;
+        } else {
+            stats.redundant_skipped++;
+        }
+
+        // Rebind from the first slot that differs; leading equal slots stay.
+        Uint32 first_diff = 0;
+        while (first_diff < it.num_vertex && first_diff < num_vertex && same_binding(it.vertex[first_diff], vertex[first_diff])) first_diff++;
+        if (first_diff < it.num_vertex) {
+            SDL_BindGPUVertexBuffers(rp, first_diff, it.vertex + first_diff, it.num_vertex - first_diff);
+            stats.vertex_binds++;
+        } else if (it.num_vertex) {
+            stats.redundant_skipped++;
+        }
+        std::memcpy(vertex, it.vertex, sizeof(vertex));
+        num_vertex = it.num_vertex;
+
+        if (it.index.buffer) {
+            if (!same_binding(it.index, index) || it.index_size != index_size) {
+                SDL_BindGPUIndexBuffer(rp, &it.index, it.index_size);
+                index = it.index;
+                index_size = it.index_size;
+                stats.index_binds++;
+            } else {
+                stats.redundant_skipped++;
+            }
+        }
+
+        if (it.num_samplers) {
+            bool same = it.num_samplers == num_samplers;
+            for (Uint32 i = 0; same && i < it.num_samplers; i++)
+                same = it.samplers[i].texture == samplers[i].texture && it.samplers[i].sampler == samplers[i].sampler;
+            if (!same) {
+                SDL_BindGPUFragmentSamplers(rp, 0, it.samplers, it.num_samplers);
+                std::memcpy(samplers, it.samplers, sizeof(samplers));
+                num_samplers = it.num_samplers;
+                stats.sampler_binds++;
+            } else {
+                stats.redundant_skipped++;
+            }
+        }
+
+        if (it.num_storage) {
+            bool same = it.num_storage == num_storage && std::memcmp(it.storage, storage, it.num_storage * sizeof(SDL_GPUBuffer*)) == 0;
+            if (!same) {
+                SDL_BindGPUVertexStorageBuffers(rp, 0, it.storage, it.num_storage);
+                std::memcpy(storage, it.storage, sizeof(storage));
+                num_storage = it.num_storage;
+                stats.storage_binds++;
+            } else {
+                stats.redundant_skipped++;
+            }
+        }
+
+        for (Uint32 u = 0; u < it.num_uniforms; u++) {
+            const DrawUniform& du = it.uniforms[u];
+            Uint32& last = pushed[du.fragment ? 1 : 0][du.slot];
+            if (last == du.offset) {
+                stats.redundant_skipped++;
+                continue;
+            }
+            const Uint8* data = list.uniform_data.data() + du.offset;
+            if (du.fragment) SDL_PushGPUFragmentUniformData(cb, du.slot, data, du.size);
+            else SDL_PushGPUVertexUniformData(cb, du.slot, data, du.size);
+            last = du.offset;
+            stats.uniform_pushes++;
+            stats.uniform_bytes += du.size;
+        }
+
+        if (it.indirect) {
+            if (it.index.buffer) SDL_DrawGPUIndexedPrimitivesIndirect(rp, it.indirect, it.indirect_offset, 1);
+            else SDL_DrawGPUPrimitivesIndirect(rp, it.indirect, it.indirect_offset, 1);
+            stats.indirect_draws++;
+        } else if (it.index.buffer)
+            SDL_DrawGPUIndexedPrimitives(rp, it.count, it.instance_count, it.first, it.vertex_offset, it.first_instance);
+        else
+            SDL_DrawGPUPrimitives(rp, it.count, it.instance_count, it.first, it.first_instance);
+    }
+}
+
+void draw_list_stats_add(DrawListStats& into, const DrawListStats& from) {
+    into.items += from.items;
+    into.pipeline_binds += from.pipeline_binds;
+    into.vertex_binds += from.vertex_binds;
+    into.index_binds += from.index_binds;
+    into.sampler_binds += from.sampler_binds;
+    into.storage_binds += from.storage_binds;
+    into.redundant_skipped += from.redundant_skipped;
+    into.indirect_draws += from.indirect_draws;
+    into.uniform_pushes += from.uniform_pushes;
+    into.uniform_bytes += from.uniform_bytes;
+}
+
+void draw_list_reset(DrawList& list) {
+    list.items.clear();
+    list.uniform_data.clear();
+    list.last_uniform = UINT32_MAX;
+    list.sorted = false;
+    list.last_stats = list.stats;
+    list.stats = DrawListStats{};
+}
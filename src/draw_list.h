@@ -0,0 +1,99 @@
+#pragma once
+#include <vector>
+#include <SDL3/SDL_gpu.h>
+
+static const Uint32 DRAW_MAX_VERTEX_BUFFERS = 4;
+static const Uint32 DRAW_MAX_SAMPLERS = 4;
+static const Uint32 DRAW_MAX_UNIFORMS = 4;
+static const Uint32 DRAW_MAX_STORAGE_BUFFERS = 2;
+
+// A uniform block staged in the list's per-frame uniform area.
+struct DrawUniform {
+    bool fragment = false;
+    Uint32 slot = 0;
+    Uint32 offset = 0;
+    Uint32 size = 0;
+};
+
+// One draw call with everything it binds. index.buffer == nullptr means a
+// non-indexed draw, in which case `first` is the first vertex. With
+// `indirect` set, the counts come from the command at `indirect_offset`
+// instead (SDL_GPUIndirectDrawCommand, or the indexed one for indexed draws).
+struct DrawItem {
+    Uint64 key = 0;
+    SDL_GPUGraphicsPipeline* pipeline = nullptr;
+    SDL_GPUBufferBinding vertex[DRAW_MAX_VERTEX_BUFFERS] = {};
+    Uint32 num_vertex = 0;
+    SDL_GPUBufferBinding index = {};
+    SDL_GPUIndexElementSize index_size = SDL_GPU_INDEXELEMENTSIZE_16BIT;
+    SDL_GPUTextureSamplerBinding samplers[DRAW_MAX_SAMPLERS] = {};
+    Uint32 num_samplers = 0;
+    // Vertex-stage storage buffers, bound from slot 0.
+    SDL_GPUBuffer* storage[DRAW_MAX_STORAGE_BUFFERS] = {};
+    Uint32 num_storage = 0;
+    Uint32 count = 0;
+    Uint32 instance_count = 1;
+    Uint32 first = 0;
+    Sint32 vertex_offset = 0;
+    Uint32 first_instance = 0;
+    SDL_GPUBuffer* indirect = nullptr;
+    Uint32 indirect_offset = 0;
+    DrawUniform uniforms[DRAW_MAX_UNIFORMS] = {};
+    Uint32 num_uniforms = 0;
+};
+
+struct DrawListStats {
+    Uint32 items = 0;
+    Uint32 pipeline_binds = 0;
+    Uint32 vertex_binds = 0;
+    Uint32 index_binds = 0;
+    Uint32 sampler_binds = 0;
+    Uint32 storage_binds = 0;
+    Uint32 redundant_skipped = 0;
+    Uint32 sort_passes = 0;
+    Uint32 indirect_draws = 0;
+    Uint32 uniform_pushes = 0;
+    Uint32 uniform_bytes = 0;
+};
+
+struct DrawList {
+    std::vector<DrawItem> items;
+    std::vector<Uint32> order;
+    std::vector<Uint32> scratch;
+    // Per-frame linear uniform storage; items refer to it by offset.
+    std::vector<Uint8> uniform_data;
+    Uint32 last_uniform = UINT32_MAX;
+    bool sorted = false;
+    DrawListStats stats;
+    DrawListStats last_stats;
+};
+
+// Sort key, most significant first: pass (4 bits), pipeline (12), material
+// (12), buffers (12), depth (24). Pass-major order lets each render pass emit
+// a contiguous range; depth last only breaks ties between equal state.
+Uint64 draw_key(Uint32 pass, Uint32 pipeline, Uint32 material, Uint32 buffers, Uint32 depth);
+Uint32 draw_key_pass(Uint64 key);
+
+// Folds a pointer into a small id for the pipeline/material/buffers fields.
+Uint32 draw_key_id(const void* p, Uint32 bits);
+
+void draw_list_push(DrawList& list, const DrawItem& item);
+// Copies a uniform block into the frame's uniform area and returns its
+// offset. A block equal to the one staged just before shares its offset, so
+// emission sees no change and skips the push.
+Uint32 draw_list_stage_uniforms(DrawList& list, const void* data, Uint32 size);
+void draw_list_sort(DrawList& list);
+// Range [begin, end) of list.order holding the items of one pass. The list
+// must be sorted.
+void draw_list_pass_range(const DrawList& list, Uint32 pass, Uint32* begin, Uint32* end);
+// Emits the sorted items of one pass, skipping binds that match what the
+// previous item in the same pass already bound.
+// Uniform blocks are pushed to `cb` only when an item's block differs from
+// the last one pushed to that slot.
+void draw_list_emit(DrawList& list, SDL_GPUCommandBuffer* cb, SDL_GPURenderPass* rp, Uint32 pass);
+// Emits order[begin, end) into `rp`, counting into `stats`. Only reads the
+// list, so disjoint ranges can be recorded from several threads at once.
+void draw_list_emit_range(const DrawList& list, SDL_GPUCommandBuffer* cb, SDL_GPURenderPass* rp, Uint32 begin, Uint32 end, DrawListStats& stats);
+void draw_list_stats_add(DrawListStats& into, const DrawListStats& from);
+// Resets the items for the next frame and publishes this frame's stats.
+void draw_list_reset(DrawList& list);
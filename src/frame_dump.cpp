@@ -0,0 +1,160 @@
+#include "frame_dump.h"
+#include <cstring>
+#include "readback_ring.h"
+
+static bool has_suffix(const std::string& s, const char* suffix) {
+    size_t n = std::strlen(suffix);
+    return s.size() >= n && SDL_strcasecmp(s.c_str() + s.size() - n, suffix) == 0;
+}
+
+static void write_y4m(FrameDumper& dump, const FrameDumper::Frame& f) {
+    if (!dump.stream) {
+        dump.stream = std::fopen(dump.path.c_str(), "wb");
+        if (!dump.stream) {
+            dump.dropped++;
+            return;
+        }
+        dump.stream_w = f.width;
+        dump.stream_h = f.height;
+        std::fprintf(dump.stream, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444\n", f.width, f.height, dump.fps);
+    }
+    if (f.width != dump.stream_w || f.height != dump.stream_h) {
+        dump.dropped++;
+        return;
+    }
+    size_t n = (size_t)f.width * f.height;
+    dump.planes.resize(n * 3);
+    Uint8* y = dump.planes.data();
+    Uint8* u = y + n;
+    Uint8* v = u + n;
+    for (size_t i = 0; i < n; i++) {
+        int r = f.rgb[i * 3 + 0], g = f.rgb[i * 3 + 1], b = f.rgb[i * 3 + 2];
+        y[i] = (Uint8)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        u[i] = (Uint8)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        v[i] = (Uint8)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+    std::fputs("FRAME\n", dump.stream);
+    std::fwrite(dump.planes.data(), 1, dump.planes.size(), dump.stream);
+    dump.written++;
+}
+
+static void write_ppm(FrameDumper& dump, const FrameDumper::Frame& f) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%06llu.ppm", (unsigned long long)dump.written.load());
+    FILE* out = std::fopen((dump.path + name).c_str(), "wb");
+    if (!out) {
+        dump.dropped++;
+        return;
+    }
+    std::fprintf(out, "P6\n%u %u\n255\n", f.width, f.height);
+    std::fwrite(f.rgb.data(), 1, f.rgb.size(), out);
+    std::fclose(out);
+    dump.written++;
+}
+
+static void writer_main(FrameDumper* dump) {
+    std::vector<FrameDumper::Frame> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(dump->mutex);
+            dump->wake.wait(lock, [&] { return dump->stop || !dump->queue.empty(); });
+            if (dump->queue.empty()) break;
+            batch.swap(dump->queue);
+        }
+        for (const FrameDumper::Frame& f : batch) {
+            if (dump->y4m)
+                write_y4m(*dump, f);
+            else
+                write_ppm(*dump, f);
+        }
+        std::lock_guard<std::mutex> lock(dump->mutex);
+        for (FrameDumper::Frame& f : batch) dump->spare.push_back(std::move(f));
+        batch.clear();
+    }
+    if (dump->stream) std::fclose(dump->stream);
+    dump->stream = nullptr;
+}
+
+bool frame_dump_start(FrameDumper& dump, const char* path, Uint32 fps) {
+    frame_dump_stop(dump);
+    dump.path = path;
+    dump.y4m = has_suffix(dump.path, ".y4m");
+    dump.fps = fps ? fps : 60;
+    dump.stop = false;
+    dump.written.store(0);
+    dump.dropped.store(0);
+    dump.writer = std::thread(writer_main, &dump);
+    return true;
+}
+
+void frame_dump_stop(FrameDumper& dump) {
+    if (!dump.writer.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(dump.mutex);
+        dump.stop = true;
+    }
+    dump.wake.notify_one();
+    dump.writer.join();
+    dump.queue.clear();
+    dump.spare.clear();
+}
+
+bool frame_dump_active(const FrameDumper& dump) {
+    return dump.writer.joinable();
+}
+
+void frame_dump_readback(void* user, const ReadbackResult& result) {
+    FrameDumper& dump = *(FrameDumper*)user;
+    int r = 0, b = 2;
+    switch (result.format) {
+    case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM:
+    case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM_SRGB:
+        break;
+    case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM:
+    case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM_SRGB:
+        r = 2, b = 0;
+        break;
+    default:
+        dump.dropped++;
+        return;
+    }
+
+    FrameDumper::Frame f;
+    {
+        std::lock_guard<std::mutex> lock(dump.mutex);
+        if (dump.stop || dump.queue.size() >= dump.max_queued) {
+            dump.dropped++;
+            return;
+        }
+        if (!dump.spare.empty()) {
+            f = std::move(dump.spare.back());
+            dump.spare.pop_back();
+        }
+    }
+    f.width = result.width;
+    f.height = result.height;
+    f.rgb.resize((size_t)f.width * f.height * 3);
+    for (Uint32 y = 0; y < f.height; y++) {
+        const Uint8* src = result.pixels + (size_t)y * result.pitch;
+        Uint8* dst = f.rgb.data() + (size_t)y * f.width * 3;
+        for (Uint32 x = 0; x < f.width; x++, src += 4, dst += 3) {
+            dst[0] = src[r];
+            dst[1] = src[1];
+            dst[2] = src[b];
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(dump.mutex);
+        dump.queue.push_back(std::move(f));
+    }
+    dump.wake.notify_one();
+}
+
+FrameDumpStats frame_dump_stats(FrameDumper& dump) {
+    FrameDumpStats st;
+    st.written = dump.written.load();
+    st.dropped = dump.dropped.load();
+    std::lock_guard<std::mutex> lock(dump.mutex);
+    st.queued = (Uint32)dump.queue.size();
+    return st;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <SDL3/SDL.h>
+
+struct ReadbackResult;
+
+struct FrameDumpStats {
+    Uint64 written = 0;
+    // Queue full, unsupported format, or a size change mid-Y4M.
+    Uint64 dropped = 0;
+    Uint32 queued = 0;
+};
+
+// Writes read-back frames to disk on its own thread: one .y4m stream (4:4:4,
+// BT.601) when the path ends in .y4m, otherwise a numbered PPM sequence using
+// the path as prefix. The readback callback only converts to RGB8 into a
+// recycled buffer and queues it, so a slow disk drops frames instead of
+// holding up the render thread.
+struct FrameDumper {
+    struct Frame {
+        std::vector<Uint8> rgb;
+        Uint32 width = 0;
+        Uint32 height = 0;
+    };
+
+    std::string path;
+    bool y4m = false;
+    Uint32 fps = 60;
+    Uint32 max_queued = 8;
+    FILE* stream = nullptr;
+    Uint32 stream_w = 0;
+    Uint32 stream_h = 0;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Frame> queue;
+    std::vector<Frame> spare;
+    bool stop = false;
+    std::atomic<Uint64> written{ 0 };
+    std::atomic<Uint64> dropped{ 0 };
+    // Writer-private scratch for the Y4M planes.
+    std::vector<Uint8> planes;
+};
+
+bool frame_dump_start(FrameDumper& dump, const char* path, Uint32 fps);
+// Writes what is still queued, then joins the writer.
+void frame_dump_stop(FrameDumper& dump);
+bool frame_dump_active(const FrameDumper& dump);
+// ReadbackCallback; `user` is the FrameDumper. 8-bit RGBA and BGRA only.
+void frame_dump_readback(void* user, const ReadbackResult& result);
+FrameDumpStats frame_dump_stats(FrameDumper& dump);
@@ -0,0 +1,130 @@
+#include "gpu_cull.h"
+#include <cstring>
+#include "upload_ring.h"
+
+namespace {
+
+// Matches the uniform block in shaders/cull.comp (std140).
+struct CullUniforms {
+    float view[4];
+    float bound_radius;
+    Uint32 count;
+    Uint32 command_stride;
+    Uint32 command_count;
+    Uint32 record_words;
+    Uint32 pad[3];
+};
+
+static_assert(sizeof(CullUniforms) == 48, "CullUniforms layout");
+
+SDL_GPUBuffer* create_buffer(SDL_GPUDevice* device, SDL_GPUBufferUsageFlags usage, Uint32 size) {
+    SDL_GPUBufferCreateInfo info{};
+    info.usage = usage;
+    info.size = size;
+    return SDL_CreateGPUBuffer(device, &info);
+}
+
+}
+
+bool gpu_cull_init(GpuCull& cull, SDL_GPUDevice* device, Uint32 capacity, Uint32 max_commands) {
+    gpu_cull_destroy(cull);
+    if (capacity == 0 || max_commands == 0) return false;
+    const Uint32 object_size = CULL_MAX_RECORD_WORDS * sizeof(Uint32);
+    cull.device = device;
+    cull.objects = create_buffer(device, SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ, capacity * object_size);
+    cull.visible = create_buffer(device, SDL_GPU_BUFFERUSAGE_VERTEX | SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ | SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE,
+                                 capacity * object_size);
+    cull.commands = create_buffer(device, SDL_GPU_BUFFERUSAGE_INDIRECT | SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ | SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE,
+                                  max_commands * (Uint32)sizeof(SDL_GPUIndexedIndirectDrawCommand));
+    cull.capacity = capacity;
+    cull.max_commands = max_commands;
+    if (!cull.objects || !cull.visible || !cull.commands) {
+        gpu_cull_destroy(cull);
+        return false;
+    }
+    return true;
+}
+
+void gpu_cull_destroy(GpuCull& cull) {
+    if (cull.objects) SDL_ReleaseGPUBuffer(cull.device, cull.objects);
+    if (cull.visible) SDL_ReleaseGPUBuffer(cull.device, cull.visible);
+    if (cull.commands) SDL_ReleaseGPUBuffer(cull.device, cull.commands);
+    cull = GpuCull{};
+}
+
+static bool set_commands(GpuCull& cull, const void* cmds, Uint32 n, Uint32 stride, bool indexed) {
+    if (n == 0 || n > cull.max_commands) return false;
+    cull.command_stride = stride / sizeof(Uint32);
+    cull.command_words.resize((size_t)n * cull.command_stride);
+    std::memcpy(cull.command_words.data(), cmds, (size_t)n * stride);
+    for (Uint32 i = 0; i < n; i++) cull.command_words[(size_t)i * cull.command_stride + 1] = 0;
+    cull.indexed = indexed;
+    return true;
+}
+
+bool gpu_cull_set_commands(GpuCull& cull, const SDL_GPUIndirectDrawCommand* cmds, Uint32 n) {
+    return set_commands(cull, cmds, n, sizeof(SDL_GPUIndirectDrawCommand), false);
+}
+
+bool gpu_cull_set_indexed_commands(GpuCull& cull, const SDL_GPUIndexedIndirectDrawCommand* cmds, Uint32 n) {
+    return set_commands(cull, cmds, n, sizeof(SDL_GPUIndexedIndirectDrawCommand), true);
+}
+
+bool gpu_cull_upload_objects(GpuCull& cull, UploadRing& uploads, const void* objects, Uint32 count, Uint32 record_words) {
+    if (count > cull.capacity || record_words < 3 || record_words > CULL_MAX_RECORD_WORDS) return false;
+    cull.count = count;
+    cull.record_words = record_words;
+    return count == 0 || upload_buffer(uploads, cull.objects, 0, objects, count * record_words * (Uint32)sizeof(Uint32));
+}
+
+Uint32 gpu_cull_command_offset(const GpuCull& cull, Uint32 i) {
+    return i * cull.command_stride * (Uint32)sizeof(Uint32);
+}
+
+bool gpu_cull_dispatch(GpuCull& cull, UploadRing& uploads, ComputeList& list, SDL_GPUComputePipeline* pipeline,
+                       Uint32 threads, const CullView& view) {
+    if (!pipeline || cull.command_words.empty() || cull.count == 0) return false;
+    Uint32 command_count = (Uint32)cull.command_words.size() / cull.command_stride;
+    if (!upload_buffer(uploads, cull.commands, 0, cull.command_words.data(), (Uint32)(cull.command_words.size() * sizeof(Uint32))))
+        return false;
+
+    CullUniforms u{};
+    u.view[0] = view.min[0];
+    u.view[1] = view.min[1];
+    u.view[2] = view.max[0];
+    u.view[3] = view.max[1];
+    u.bound_radius = view.bound_radius;
+    u.count = cull.count;
+    u.command_stride = cull.command_stride;
+    u.command_count = command_count;
+    u.record_words = cull.record_words;
+
+    ComputeDispatch d;
+    d.pipeline = pipeline;
+    d.ro_buffers[0] = cull.objects;
+    d.num_ro_buffers = 1;
+    d.rw_buffers[0].buffer = cull.visible;
+    d.rw_buffers[1].buffer = cull.commands;
+    d.num_rw_buffers = 2;
+    compute_set_uniforms(d, &u, sizeof(u));
+    d.groups_x = compute_groups(cull.count, threads);
+    compute_list_push(list, d);
+    return true;
+}
+
+Uint32 cpu_cull(const float* objects, Uint32 count, Uint32 stride, const CullView& view, std::vector<float>& out) {
+    Uint32 kept = 0;
+    out.resize((size_t)count * stride);
+    float* dst = out.data();
+    for (Uint32 i = 0; i < count; i++) {
+        const float* o = objects + (size_t)i * stride;
+        float r = o[2] * view.bound_radius;
+        if (o[0] + r < view.min[0] || o[0] - r > view.max[0] || o[1] + r < view.min[1] || o[1] - r > view.max[1]) continue;
+        // Words past the first three need not be floats; copy them as bytes.
+        std::memcpy(dst, o, stride * sizeof(float));
+        dst += stride;
+        kept++;
+    }
+    out.resize((size_t)kept * stride);
+    return kept;
+}
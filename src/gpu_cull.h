@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include <SDL3/SDL_gpu.h>
+#include "compute_list.h"
+
+struct UploadRing;
+
+static const Uint32 CULL_MAX_RECORD_WORDS = 4;
+
+// View rectangle and bounds scale shared by the CPU and GPU culling paths.
+// Objects are records starting with (offset.xy, scale); an object's bounding
+// circle is its offset with radius scale * bound_radius. Any words after the
+// first three are carried through culling untouched.
+struct CullView {
+    float min[2] = { -1.0f, -1.0f };
+    float max[2] = { 1.0f, 1.0f };
+    float bound_radius = 1.0f;
+};
+
+// Culling on the GPU for one instanced draw. The objects live in a storage
+// buffer; a compute pass tests each bounding circle against the view, appends
+// the survivors to a compacted instance buffer and adds their count to the
+// instance count of every indirect command, which the scene pass then draws.
+// The commands are re-uploaded with zero instances each frame.
+struct GpuCull {
+    SDL_GPUDevice* device = nullptr;
+    SDL_GPUBuffer* objects = nullptr;
+    SDL_GPUBuffer* visible = nullptr;
+    SDL_GPUBuffer* commands = nullptr;
+    Uint32 capacity = 0;
+    Uint32 count = 0;
+    Uint32 record_words = 3;
+    Uint32 max_commands = 0;
+    // Template commands, either SDL_GPUIndirectDrawCommand or
+    // SDL_GPUIndexedIndirectDrawCommand; both keep num_instances in word 1.
+    std::vector<Uint32> command_words;
+    Uint32 command_stride = 0;
+    bool indexed = false;
+};
+
+bool gpu_cull_init(GpuCull& cull, SDL_GPUDevice* device, Uint32 capacity, Uint32 max_commands);
+void gpu_cull_destroy(GpuCull& cull);
+
+bool gpu_cull_set_commands(GpuCull& cull, const SDL_GPUIndirectDrawCommand* cmds, Uint32 n);
+bool gpu_cull_set_indexed_commands(GpuCull& cull, const SDL_GPUIndexedIndirectDrawCommand* cmds, Uint32 n);
+// Queues `count` objects of `record_words` words each (3 for bare instance
+// records, up to CULL_MAX_RECORD_WORDS) for upload; they stay until replaced.
+bool gpu_cull_upload_objects(GpuCull& cull, UploadRing& uploads, const void* objects, Uint32 count, Uint32 record_words);
+// Byte offset of command `i` in cull.commands.
+Uint32 gpu_cull_command_offset(const GpuCull& cull, Uint32 i);
+// Resets the commands through the upload ring and pushes the cull dispatch.
+// `threads` is the pipeline's reflected workgroup width.
+bool gpu_cull_dispatch(GpuCull& cull, UploadRing& uploads, ComputeList& list, SDL_GPUComputePipeline* pipeline,
+                       Uint32 threads, const CullView& view);
+
+// CPU reference path: copies the visible objects, `stride` words each, to
+// `out` and returns the count.
+Uint32 cpu_cull(const float* objects, Uint32 count, Uint32 stride, const CullView& view, std::vector<float>& out);
@@ -0,0 +1,209 @@
+#include "gpu_pool.h"
+#include "upload_ring.h"
+#include <algorithm>
+
+static Uint32 round_up(Uint32 v, Uint32 a) {
+    return a > 1 ? ((v + a - 1) / a) * a : v;
+}
+
+bool gpu_pool_init(GpuBufferPool& pool, SDL_GPUDevice* device, SDL_GPUBufferUsageFlags usage, Uint32 page_size) {
+    pool.device = device;
+    pool.usage = usage;
+    pool.page_size = page_size;
+    pool.pages.clear();
+    pool.entries.clear();
+    pool.free_entries.clear();
+    pool.bytes_moved = 0;
+    return device != nullptr && page_size > 0;
+}
+
+void gpu_pool_destroy(GpuBufferPool& pool) {
+    for (auto& p : pool.pages) if (p.buffer) SDL_ReleaseGPUBuffer(pool.device, p.buffer);
+    pool.pages.clear();
+    pool.entries.clear();
+    pool.free_entries.clear();
+}
+
+static SDL_GPUBuffer* create_page_buffer(GpuBufferPool& pool, Uint32 size) {
+    SDL_GPUBufferCreateInfo ci{};
+    ci.usage = pool.usage;
+    ci.size = size;
+    return SDL_CreateGPUBuffer(pool.device, &ci);
+}
+
+static bool page_take(GpuBufferPool::Page& page, Uint32 size, Uint32 align, Uint32* out_offset) {
+    for (size_t i = 0; i < page.free.size(); i++) {
+        GpuBufferPool::Block b = page.free[i];
+        Uint32 start = round_up(b.offset, align);
+        if (start < b.offset || start - b.offset + (Uint64)size > b.size) continue;
+        Uint32 head = start - b.offset;
+        Uint32 tail = b.size - head - size;
+        page.free.erase(page.free.begin() + (long)i);
+        if (tail) page.free.insert(page.free.begin() + (long)i, { start + size, tail });
+        if (head) page.free.insert(page.free.begin() + (long)i, { b.offset, head });
+        *out_offset = start;
+        return true;
+    }
+    return false;
+}
+
+static void page_release(GpuBufferPool::Page& page, Uint32 offset, Uint32 size) {
+    auto it = std::lower_bound(page.free.begin(), page.free.end(), offset,
+        [](const GpuBufferPool::Block& b, Uint32 off) { return b.offset < off; });
+    it = page.free.insert(it, { offset, size });
+    if (it + 1 != page.free.end() && it->offset + it->size == (it + 1)->offset) {
+        it->size += (it + 1)->size;
+        page.free.erase(it + 1);
+    }
+    if (it != page.free.begin() && (it - 1)->offset + (it - 1)->size == it->offset) {
+        (it - 1)->size += it->size;
+        page.free.erase(it);
+    }
+}
+
+GpuAlloc gpu_pool_alloc(GpuBufferPool& pool, Uint32 size, Uint32 align) {
+    if (size == 0) return GpuAlloc{};
+    if (align == 0) align = 1;
+    Uint32 page_index = 0;
+    Uint32 offset = 0;
+    bool found = false;
+    for (Uint32 i = 0; i < (Uint32)pool.pages.size() && !found; i++) {
+        if (page_take(pool.pages[i], size, align, &offset)) { page_index = i; found = true; }
+    }
+    if (!found) {
+        GpuBufferPool::Page page;
+        page.size = std::max(pool.page_size, round_up(size, 256));
+        page.buffer = create_page_buffer(pool, page.size);
+        if (!page.buffer) return GpuAlloc{};
+        page.free.push_back({ 0, page.size });
+        pool.pages.push_back(std::move(page));
+        page_index = (Uint32)pool.pages.size() - 1;
+        if (!page_take(pool.pages[page_index], size, align, &offset)) return GpuAlloc{};
+    }
+
+    Uint32 index;
+    if (!pool.free_entries.empty()) {
+        index = pool.free_entries.back();
+        pool.free_entries.pop_back();
+    } else {
+        index = (Uint32)pool.entries.size();
+        pool.entries.emplace_back();
+    }
+    GpuBufferPool::Entry& e = pool.entries[index];
+    e.page = page_index;
+    e.offset = offset;
+    e.size = size;
+    e.align = align;
+    e.live = true;
+    pool.pages[page_index].live++;
+    return GpuAlloc{ index, e.generation };
+}
+
+static GpuBufferPool::Entry* find_entry(GpuBufferPool& pool, GpuAlloc alloc) {
+    if (alloc.generation == 0 || alloc.index >= pool.entries.size()) return nullptr;
+    GpuBufferPool::Entry& e = pool.entries[alloc.index];
+    if (!e.live || e.generation != alloc.generation) return nullptr;
+    return &e;
+}
+
+void gpu_pool_free(GpuBufferPool& pool, GpuAlloc alloc) {
+    GpuBufferPool::Entry* e = find_entry(pool, alloc);
+    if (!e) return;
+    GpuBufferPool::Page& page = pool.pages[e->page];
+    page_release(page, e->offset, e->size);
+    page.live--;
+    e->live = false;
+    e->generation++;
+    if (e->generation == 0) e->generation = 1;
+    pool.free_entries.push_back(alloc.index);
+}
+
+bool gpu_pool_resolve(const GpuBufferPool& pool, GpuAlloc alloc, GpuRange* out) {
+    if (alloc.generation == 0 || alloc.index >= pool.entries.size()) return false;
+    const GpuBufferPool::Entry& e = pool.entries[alloc.index];
+    if (!e.live || e.generation != alloc.generation) return false;
+    out->buffer = pool.pages[e.page].buffer;
+    out->page = e.page;
+    out->offset = e.offset;
+    out->size = e.size;
+    return true;
+}
+
+bool gpu_pool_upload(GpuBufferPool& pool, UploadRing& uploads, GpuAlloc alloc, const void* data, Uint32 size, Uint32 offset) {
+    GpuRange r;
+    if (!gpu_pool_resolve(pool, alloc, &r) || (Uint64)offset + size > r.size) return false;
+    return upload_buffer(uploads, r.buffer, r.offset + offset, data, size);
+}
+
+bool gpu_pool_fragmented(const GpuBufferPool& pool) {
+    for (const auto& p : pool.pages) {
+        if (p.free.size() < 8) continue;
+        Uint64 total = 0;
+        Uint32 largest = 0;
+        for (const auto& b : p.free) {
+            total += b.size;
+            largest = std::max(largest, b.size);
+        }
+        if (largest * 2ull < total) return true;
+    }
+    return false;
+}
+
+// Moves the live ranges of the most fragmented pages into fresh buffers, packed
+// from offset zero. Must run after the frame's uploads have been flushed so no
+// queued copy still targets the old offsets.
+Uint32 gpu_pool_defragment(GpuBufferPool& pool, SDL_GPUCommandBuffer* cb, Uint32 max_pages) {
+    std::vector<Uint32> order;
+    for (Uint32 i = 0; i < (Uint32)pool.pages.size(); i++) if (pool.pages[i].free.size() > 1) order.push_back(i);
+    std::sort(order.begin(), order.end(), [&](Uint32 a, Uint32 b) { return pool.pages[a].free.size() > pool.pages[b].free.size(); });
+    if (order.size() > max_pages) order.resize(max_pages);
+    if (order.empty()) return 0;
+
+    Uint32 moved = 0;
+    SDL_GPUCopyPass* pass = SDL_BeginGPUCopyPass(cb);
+    for (Uint32 pi : order) {
+        GpuBufferPool::Page& page = pool.pages[pi];
+        SDL_GPUBuffer* fresh = create_page_buffer(pool, page.size);
+        if (!fresh) continue;
+        std::vector<Uint32> live;
+        for (Uint32 i = 0; i < (Uint32)pool.entries.size(); i++)
+            if (pool.entries[i].live && pool.entries[i].page == pi) live.push_back(i);
+        std::sort(live.begin(), live.end(), [&](Uint32 a, Uint32 b) { return pool.entries[a].offset < pool.entries[b].offset; });
+        Uint32 cursor = 0;
+        for (Uint32 idx : live) {
+            GpuBufferPool::Entry& e = pool.entries[idx];
+            Uint32 dst_off = round_up(cursor, e.align);
+            SDL_GPUBufferLocation src{};
+            src.buffer = page.buffer;
+            src.offset = e.offset;
+            SDL_GPUBufferLocation dst{};
+            dst.buffer = fresh;
+            dst.offset = dst_off;
+            SDL_CopyGPUBufferToBuffer(pass, &src, &dst, e.size, false);
+            e.offset = dst_off;
+            cursor = dst_off + e.size;
+            moved += e.size;
+        }
+        SDL_ReleaseGPUBuffer(pool.device, page.buffer);
+        page.buffer = fresh;
+        page.free.clear();
+        if (cursor < page.size) page.free.push_back({ cursor, page.size - cursor });
+    }
+    SDL_EndGPUCopyPass(pass);
+    pool.bytes_moved += moved;
+    return moved;
+}
+
+GpuPoolStats gpu_pool_stats(const GpuBufferPool& pool) {
+    GpuPoolStats s;
+    s.pages = (Uint32)pool.pages.size();
+    for (const auto& p : pool.pages) {
+        for (const auto& b : p.free) s.bytes_free += b.size;
+        s.bytes_used += p.size;
+        s.free_blocks += (Uint32)p.free.size();
+        s.allocations += p.live;
+    }
+    s.bytes_used -= s.bytes_free;
+    s.bytes_moved = pool.bytes_moved;
+    return s;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include <SDL3/SDL_gpu.h>
+
+struct UploadRing;
+
+struct GpuAlloc {
+    Uint32 index = 0;
+    Uint32 generation = 0;
+};
+
+struct GpuRange {
+    SDL_GPUBuffer* buffer = nullptr;
+    Uint32 page = 0;
+    Uint32 offset = 0;
+    Uint32 size = 0;
+};
+
+struct GpuPoolStats {
+    Uint32 pages = 0;
+    Uint32 allocations = 0;
+    Uint64 bytes_used = 0;
+    Uint64 bytes_free = 0;
+    Uint32 free_blocks = 0;
+    Uint64 bytes_moved = 0;
+};
+
+// Carves vertex and index ranges out of a few large GPU buffers. Ranges are
+// addressed through GpuAlloc handles so defragmentation can move them; resolve
+// the handle when recording a draw rather than caching the offset.
+struct GpuBufferPool {
+    struct Block {
+        Uint32 offset = 0;
+        Uint32 size = 0;
+    };
+
+    struct Page {
+        SDL_GPUBuffer* buffer = nullptr;
+        Uint32 size = 0;
+        std::vector<Block> free;
+        Uint32 live = 0;
+    };
+
+    struct Entry {
+        Uint32 page = 0;
+        Uint32 offset = 0;
+        Uint32 size = 0;
+        Uint32 align = 1;
+        Uint32 generation = 1;
+        bool live = false;
+    };
+
+    SDL_GPUDevice* device = nullptr;
+    SDL_GPUBufferUsageFlags usage = 0;
+    Uint32 page_size = 0;
+    std::vector<Page> pages;
+    std::vector<Entry> entries;
+    std::vector<Uint32> free_entries;
+    Uint64 bytes_moved = 0;
+};
+
+bool gpu_pool_init(GpuBufferPool& pool, SDL_GPUDevice* device, SDL_GPUBufferUsageFlags usage, Uint32 page_size);
+void gpu_pool_destroy(GpuBufferPool& pool);
+
+GpuAlloc gpu_pool_alloc(GpuBufferPool& pool, Uint32 size, Uint32 align);
+void gpu_pool_free(GpuBufferPool& pool, GpuAlloc alloc);
+bool gpu_pool_resolve(const GpuBufferPool& pool, GpuAlloc alloc, GpuRange* out);
+bool gpu_pool_upload(GpuBufferPool& pool, UploadRing& uploads, GpuAlloc alloc, const void* data, Uint32 size, Uint32 offset = 0);
+
+bool gpu_pool_fragmented(const GpuBufferPool& pool);
+Uint32 gpu_pool_defragment(GpuBufferPool& pool, SDL_GPUCommandBuffer* cb, Uint32 max_pages = 1);
+GpuPoolStats gpu_pool_stats(const GpuBufferPool& pool);
@@ -0,0 +1,80 @@
+#include "heap_count.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<Uint64> g_count{ 0 };
+SDL_malloc_func g_malloc = nullptr;
+SDL_calloc_func g_calloc = nullptr;
+SDL_realloc_func g_realloc = nullptr;
+SDL_free_func g_free = nullptr;
+
+void count_one() {
+    g_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* SDLCALL counted_malloc(size_t size) {
+    count_one();
+    return g_malloc(size);
+}
+
+void* SDLCALL counted_calloc(size_t n, size_t size) {
+    count_one();
+    return g_calloc(n, size);
+}
+
+void* SDLCALL counted_realloc(void* p, size_t size) {
+    count_one();
+    return g_realloc(p, size);
+}
+
+void* allocate(size_t size) {
+    count_one();
+    if (size == 0) size = 1;
+    for (;;) {
+        if (void* p = std::malloc(size)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+}
+
+// Before SDL_Init, so every SDL allocation goes through the counted set.
+void heap_count_install() {
+    SDL_GetOriginalMemoryFunctions(&g_malloc, &g_calloc, &g_realloc, &g_free);
+    SDL_SetMemoryFunctions(counted_malloc, counted_calloc, counted_realloc, g_free);
+}
+
+Uint64 heap_count() {
+    return g_count.load(std::memory_order_relaxed);
+}
+
+// Replacements for the global allocation functions; the standard library's
+// nothrow forms forward to these.
+void* operator new(size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include <SDL3/SDL.h>
+
+// Process-wide count of heap allocations, all threads: every call of the
+// global operator new (standard containers, strings, make_shared), plus SDL's
+// own allocations once heap_count_install has run. Libraries calling malloc
+// directly are not seen.
+void heap_count_install();
+Uint64 heap_count();
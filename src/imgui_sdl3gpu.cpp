@@ -5,36 +5,30 @@
 #include <stdlib.h>
 #include <string.h>
 #include "imgui.h"
+#include "upload_ring.h"
 
-static unsigned char* read_all_file(const char* path, size_t* out_size) {
-    FILE* f = fopen(path, "rb");
-    if (!f) return NULL;
-    fseek(f, 0, SEEK_END);
-    long n = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    if (n <= 0) { fclose(f); return NULL; }
-    unsigned char* buf = (unsigned char*)malloc((size_t)n);
-    if (!buf) { fclose(f); return NULL; }
-    size_t r = fread(buf, 1, (size_t)n, f);
-    fclose(f);
-    if (r != (size_t)n) { free(buf); return NULL; }
-    *out_size = (size_t)n;
-    return buf;
-}
+static const Uint32 IMGUI_MIN_BUFFER_SIZE = 64 * 1024;
 
 struct ImGuiSDL3GPU {
+    SDL_GPUDevice* device;
     SDL_GPUShader* vshader;
     SDL_GPUShader* fshader;
     SDL_GPUGraphicsPipeline* pipeline;
+    SDL_GPUTextureFormat pipeline_format;
     SDL_GPUBuffer* vbo;
     SDL_GPUBuffer* ibo;
     Uint32 vbo_size;
     Uint32 ibo_size;
+    bool uploaded;
     SDL_GPUTexture* font_tex;
     SDL_GPUSampler* font_sampler;
+    bool owns_sampler;
+    ImGuiSDL3GPU_TextureResolver resolve;
+    void* resolve_user;
+    ImGuiSDL3GPU_Stats stats;
 };
 
-static SDL_GPUTexture* create_font_texture(SDL_GPUDevice* device, SDL_GPUSampler** out_sampler) {
+static SDL_GPUTexture* create_font_texture(SDL_GPUDevice* device, UploadRing* uploads, SDL_GPUSampler** out_sampler) {
     ImGuiIO& io = ImGui::GetIO();
     unsigned char* pixels = NULL;
     int w = 0;
@@ -50,29 +44,14 @@ static SDL_GPUTexture* create_font_texture(SDL_GPUDevice* device, SDL_GPUSampler
     tci.num_levels = 1;
     tci.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER;
     SDL_GPUTexture* tex = SDL_CreateGPUTexture(device, &tci);
-    SDL_GPUTransferBufferCreateInfo tbci;
-    SDL_zero(tbci);
-    tbci.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
-    tbci.size = (Uint32)(w * h * 4);
-    SDL_GPUTransferBuffer* tbo = SDL_CreateGPUTransferBuffer(device, &tbci);
-    void* map = SDL_MapGPUTransferBuffer(device, tbo, false);
-    memcpy(map, pixels, (size_t)tbci.size);
-    SDL_UnmapGPUTransferBuffer(device, tbo);
-    SDL_GPUCommandBuffer* cb = SDL_AcquireGPUCommandBuffer(device);
-    SDL_GPUCopyPass* pass = SDL_BeginGPUCopyPass(cb);
-    SDL_GPUTextureTransferInfo dst;
+    SDL_GPUTextureRegion dst;
     SDL_zero(dst);
     dst.texture = tex;
-    dst.miplevel = 0;
-    dst.layer = 0;
-    SDL_GPUTransferBufferLocation src;
-    SDL_zero(src);
-    src.transfer_buffer = tbo;
-    src.offset = 0;
-    SDL_UploadToGPUTexture(pass, &src, 0, &dst, tci.width, tci.height, true);
-    SDL_EndGPUCopyPass(pass);
-    SDL_SubmitGPUCommandBuffer(cb);
-    SDL_ReleaseGPUTransferBuffer(device, tbo);
+    dst.w = tci.width;
+    dst.h = tci.height;
+    dst.d = 1;
+    upload_texture(*uploads, dst, pixels, (Uint32)(w * h * 4));
+    io.Fonts->SetTexID((ImTextureID)(intptr_t)tex);
     SDL_GPUSamplerCreateInfo sci;
     SDL_zero(sci);
     sci.mag_filter = SDL_GPU_FILTER_LINEAR;
@@ -86,56 +65,55 @@ static SDL_GPUTexture* create_font_texture(SDL_GPUDevice* device, SDL_GPUSampler
     return tex;
 }
 
-ImGuiSDL3GPU* ImGuiSDL3GPU_Create(SDL_GPUDevice* device, SDL_Window* window, const char* vs_spv_path, const char* fs_spv_path) {
-    ImGui::CreateContext();
-    ImGuiIO& io = ImGui::GetIO();
-    io.BackendPlatformName = "imgui_impl_sdl3gpu_platform";
-    io.BackendRendererName = "imgui_impl_sdl3gpu_renderer";
-    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
-    int w, h;
-    SDL_GetWindowSize(window, &w, &h);
-    io.DisplaySize = ImVec2((float)w, (float)h);
-    ImGuiSDL3GPU* ctx = (ImGuiSDL3GPU*)SDL_calloc(1, sizeof(ImGuiSDL3GPU));
-    size_t vs_size = 0;
-    size_t fs_size = 0;
-    unsigned char* vs_code = read_all_file(vs_spv_path, &vs_size);
-    unsigned char* fs_code = read_all_file(fs_spv_path, &fs_size);
-    SDL_GPUShaderCreateInfo vsi;
-    SDL_zero(vsi);
-    vsi.code = vs_code;
-    vsi.code_size = (Uint32)vs_size;
-    vsi.format = SDL_GPU_SHADERFORMAT_SPIRV;
-    vsi.stage = SDL_GPU_SHADERSTAGE_VERTEX;
-    vsi.entrypoint = "main";
-    ctx->vshader = SDL_CreateGPUShader(device, &vsi);
-    SDL_GPUShaderCreateInfo fsi;
-    SDL_zero(fsi);
-    fsi.code = fs_code;
-    fsi.code_size = (Uint32)fs_size;
-    fsi.format = SDL_GPU_SHADERFORMAT_SPIRV;
-    fsi.stage = SDL_GPU_SHADERSTAGE_FRAGMENT;
-    fsi.entrypoint = "main";
-    ctx->fshader = SDL_CreateGPUShader(device, &fsi);
-    free(vs_code);
-    free(fs_code);
+static SDL_GPUGraphicsPipeline* create_pipeline(ImGuiSDL3GPU* ctx, SDL_GPUTextureFormat color_format) {
+    SDL_GPUColorTargetBlendState blend;
+    SDL_zero(blend);
+    blend.enable_blend = true;
+    blend.src_color_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA;
+    blend.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
+    blend.color_blend_op = SDL_GPU_BLENDOP_ADD;
+    blend.src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
+    blend.dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
+    blend.alpha_blend_op = SDL_GPU_BLENDOP_ADD;
+    SDL_GPUColorTargetDescription cdesc;
+    SDL_zero(cdesc);
+    cdesc.format = color_format;
+    cdesc.blend_state = blend;
+    SDL_GPUGraphicsPipelineTargetInfo tgt;
+    SDL_zero(tgt);
+    tgt.color_target_descriptions = &cdesc;
+    tgt.num_color_targets = 1;
+    tgt.depth_stencil_format = SDL_GPU_TEXTUREFORMAT_INVALID;
+    SDL_GPURasterizerState rast;
+    SDL_zero(rast);
+    rast.fill_mode = SDL_GPU_FILLMODE_FILL;
+    rast.cull_mode = SDL_GPU_CULLMODE_NONE;
+    rast.front_face = SDL_GPU_FRONTFACE_COUNTER_CLOCKWISE;
+    SDL_GPUDepthStencilState ds;
+    SDL_zero(ds);
+    ds.enable_depth_test = false;
+    ds.enable_depth_write = false;
+    SDL_GPUMultisampleState ms;
+    SDL_zero(ms);
+    ms.sample_count = SDL_GPU_SAMPLECOUNT_1;
     SDL_GPUVertexAttribute attrs[3];
     SDL_zeroa(attrs);
     attrs[0].location = 0;
     attrs[0].buffer_slot = 0;
     attrs[0].format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2;
-    attrs[0].offset = 0;
+    attrs[0].offset = offsetof(ImDrawVert, pos);
     attrs[1].location = 1;
     attrs[1].buffer_slot = 0;
     attrs[1].format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2;
-    attrs[1].offset = sizeof(float) * 2;
+    attrs[1].offset = offsetof(ImDrawVert, uv);
     attrs[2].location = 2;
     attrs[2].buffer_slot = 0;
     attrs[2].format = SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM;
-    attrs[2].offset = sizeof(float) * 4;
+    attrs[2].offset = offsetof(ImDrawVert, col);
     SDL_GPUVertexBufferDescription vbd;
     SDL_zero(vbd);
     vbd.slot = 0;
-    vbd.pitch = (Uint32)(sizeof(float) * 4 + sizeof(Uint32));
+    vbd.pitch = (Uint32)sizeof(ImDrawVert);
     vbd.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX;
     SDL_GPUVertexInputState vis;
     SDL_zero(vis);
@@ -143,84 +121,107 @@ ImGuiSDL3GPU* ImGuiSDL3GPU_Create(SDL_GPUDevice* device, SDL_Window* window, con
     vis.num_vertex_buffers = 1;
     vis.vertex_attributes = attrs;
     vis.num_vertex_attributes = 3;
-    SDL_GPUColorTargetBlendState blend;
-    SDL_zero(blend);
-    blend.enable_blend = true;
-    blend.src_color_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA;
-    blend.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
-    blend.color_blendop = SDL_GPU_BLENDOP_ADD;
-    blend.src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
-    blend.dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
-    blend.alpha_blendop = SDL_GPU_BLENDOP_ADD;
-    ctx->font_tex = create_font_texture(device, &ctx->font_sampler);
+    SDL_GPUGraphicsPipelineCreateInfo pci;
+    SDL_zero(pci);
+    pci.vertex_shader = ctx->vshader;
+    pci.fragment_shader = ctx->fshader;
+    pci.target_info = tgt;
+    pci.vertex_input_state = vis;
+    pci.primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST;
+    pci.rasterizer_state = rast;
+    pci.depth_stencil_state = ds;
+    pci.multisample_state = ms;
+    return SDL_CreateGPUGraphicsPipeline(ctx->device, &pci);
+}
+
+ImGuiSDL3GPU* ImGuiSDL3GPU_Create(SDL_GPUDevice* device, UploadRing* uploads, const void* vs_spv, size_t vs_size, const void* fs_spv, size_t fs_size) {
+    ImGuiIO& io = ImGui::GetIO();
+    io.BackendRendererName = "imgui_impl_sdl3gpu_renderer";
+    ImGuiSDL3GPU* ctx = (ImGuiSDL3GPU*)SDL_calloc(1, sizeof(ImGuiSDL3GPU));
+    ctx->device = device;
+    SDL_GPUShaderCreateInfo vsi;
+    SDL_zero(vsi);
+    vsi.code = (const Uint8*)vs_spv;
+    vsi.code_size = vs_size;
+    vsi.format = SDL_GPU_SHADERFORMAT_SPIRV;
+    vsi.stage = SDL_GPU_SHADERSTAGE_VERTEX;
+    vsi.entrypoint = "main";
+    vsi.num_uniform_buffers = 1;
+    ctx->vshader = SDL_CreateGPUShader(device, &vsi);
+    SDL_GPUShaderCreateInfo fsi;
+    SDL_zero(fsi);
+    fsi.code = (const Uint8*)fs_spv;
+    fsi.code_size = fs_size;
+    fsi.format = SDL_GPU_SHADERFORMAT_SPIRV;
+    fsi.stage = SDL_GPU_SHADERSTAGE_FRAGMENT;
+    fsi.entrypoint = "main";
+    fsi.num_samplers = 1;
+    ctx->fshader = SDL_CreateGPUShader(device, &fsi);
+    if (!ctx->vshader || !ctx->fshader) {
+        ImGuiSDL3GPU_Destroy(ctx);
+        return NULL;
+    }
+    ctx->font_tex = create_font_texture(device, uploads, &ctx->font_sampler);
+    ctx->owns_sampler = true;
     ctx->vbo_size = 0;
     ctx->ibo_size = 0;
     ctx->vbo = NULL;
     ctx->ibo = NULL;
     ctx->pipeline = NULL;
+    ctx->pipeline_format = SDL_GPU_TEXTUREFORMAT_INVALID;
     return ctx;
 }
 
-void ImGuiSDL3GPU_Destroy(ImGuiSDL3GPU* ctx, SDL_GPUDevice* device) {
+void ImGuiSDL3GPU_Destroy(ImGuiSDL3GPU* ctx) {
     if (!ctx) return;
+    SDL_GPUDevice* device = ctx->device;
     if (ctx->pipeline) SDL_ReleaseGPUGraphicsPipeline(device, ctx->pipeline);
     if (ctx->vshader) SDL_ReleaseGPUShader(device, ctx->vshader);
     if (ctx->fshader) SDL_ReleaseGPUShader(device, ctx->fshader);
     if (ctx->vbo) SDL_ReleaseGPUBuffer(device, ctx->vbo);
     if (ctx->ibo) SDL_ReleaseGPUBuffer(device, ctx->ibo);
-    if (ctx->font_sampler) SDL_ReleaseGPUSampler(device, ctx->font_sampler);
+    if (ctx->font_sampler && ctx->owns_sampler) SDL_ReleaseGPUSampler(device, ctx->font_sampler);
     if (ctx->font_tex) SDL_ReleaseGPUTexture(device, ctx->font_tex);
-    ImGui::DestroyContext();
     SDL_free(ctx);
 }
 
 void ImGuiSDL3GPU_NewFrame(ImGuiSDL3GPU* ctx, SDL_Window* window, float dt) {
+    (void)ctx;
     ImGuiIO& io = ImGui::GetIO();
-    int w, h;
-    SDL_GetWindowSize(window, &w, &h);
-    io.DisplaySize = ImVec2((float)w, (float)h);
-    io.DeltaTime = dt > 0 ? dt : (1.0f / 60.0f);
+    if (!io.BackendPlatformName) {
+        int w, h;
+        SDL_GetWindowSize(window, &w, &h);
+        io.DisplaySize = ImVec2((float)w, (float)h);
+        io.DeltaTime = dt > 0 ? dt : (1.0f / 60.0f);
+    }
     ImGui::NewFrame();
 }
 
-void ImGuiSDL3GPU_Render(ImGuiSDL3GPU* ctx, SDL_GPUCommandBuffer* cb, SDL_GPUTexture* color_target, SDL_GPUTextureFormat color_format) {
-    ImGui::Render();
-    ImDrawData* dd = ImGui::GetDrawData();
+static bool grow_buffer(ImGuiSDL3GPU* ctx, SDL_GPUBuffer** buf, Uint32* size, Uint32 needed, SDL_GPUBufferUsageFlags usage) {
+    if (*buf && *size >= needed) return true;
+    Uint32 new_size = *size ? *size : IMGUI_MIN_BUFFER_SIZE;
+    while (new_size < needed) new_size += new_size / 2;
+    if (*buf) SDL_ReleaseGPUBuffer(ctx->device, *buf);
+    SDL_GPUBufferCreateInfo ci;
+    SDL_zero(ci);
+    ci.usage = usage;
+    ci.size = new_size;
+    *buf = SDL_CreateGPUBuffer(ctx->device, &ci);
+    *size = *buf ? new_size : 0;
+    ctx->stats.buffer_reallocs++;
+    return *buf != NULL;
+}
+
+void ImGuiSDL3GPU_PrepareDrawData(ImGuiSDL3GPU* ctx, const ImDrawData* dd, UploadRing* uploads) {
+    ctx->uploaded = false;
     if (!dd || dd->TotalVtxCount == 0) return;
-    Uint32 vsize = (Uint32)(dd->TotalVtxCount * (sizeof(float) * 4 + sizeof(Uint32)));
+    Uint32 vsize = (Uint32)(dd->TotalVtxCount * sizeof(ImDrawVert));
     Uint32 isize = (Uint32)(dd->TotalIdxCount * sizeof(ImDrawIdx));
-    if (!ctx->vbo || ctx->vbo_size < vsize) {
-        if (ctx->vbo) SDL_ReleaseGPUBuffer(SDL_GetGPUDevice(cb), ctx->vbo);
-        SDL_GPUBufferCreateInfo ci;
-        SDL_zero(ci);
-        ci.usage = SDL_GPU_BUFFERUSAGE_VERTEX | SDL_GPU_BUFFERUSAGE_DYNAMIC;
-        ci.size = vsize;
-        ctx->vbo = SDL_CreateGPUBuffer(SDL_GetGPUDevice(cb), &ci);
-        ctx->vbo_size = vsize;
-    }
-    if (!ctx->ibo || ctx->ibo_size < isize) {
-        if (ctx->ibo) SDL_ReleaseGPUBuffer(SDL_GetGPUDevice(cb), ctx->ibo);
-        SDL_GPUBufferCreateInfo ci;
-        SDL_zero(ci);
-        ci.usage = SDL_GPU_BUFFERUSAGE_INDEX | SDL_GPU_BUFFERUSAGE_DYNAMIC;
-        ci.size = isize;
-        ctx->ibo = SDL_CreateGPUBuffer(SDL_GetGPUDevice(cb), &ci);
-        ctx->ibo_size = isize;
-    }
-    SDL_GPUTransferBufferCreateInfo tci_v;
-    SDL_zero(tci_v);
-    tci_v.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
-    tci_v.size = vsize;
-    SDL_GPUTransferBuffer* tbo_v = SDL_CreateGPUTransferBuffer(SDL_GetGPUDevice(cb), &tci_v);
-    SDL_GPUTransferBufferCreateInfo tci_i;
-    SDL_zero(tci_i);
-    tci_i.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
-    tci_i.size = isize;
-    SDL_GPUTransferBuffer* tbo_i = SDL_CreateGPUTransferBuffer(SDL_GetGPUDevice(cb), &tci_i);
-    unsigned char* vmap = (unsigned char*)SDL_MapGPUTransferBuffer(SDL_GetGPUDevice(cb), tbo_v, false);
-    unsigned char* imap = (unsigned char*)SDL_MapGPUTransferBuffer(SDL_GetGPUDevice(cb), tbo_i, false);
-    ImDrawVert* vtx_write = (ImDrawVert*)vmap;
-    ImDrawIdx* idx_write = (ImDrawIdx*)imap;
+    if (!grow_buffer(ctx, &ctx->vbo, &ctx->vbo_size, vsize, SDL_GPU_BUFFERUSAGE_VERTEX)) return;
+    if (!grow_buffer(ctx, &ctx->ibo, &ctx->ibo_size, isize, SDL_GPU_BUFFERUSAGE_INDEX)) return;
+    ImDrawVert* vtx_write = (ImDrawVert*)upload_buffer_map(*uploads, ctx->vbo, 0, vsize, true);
+    ImDrawIdx* idx_write = (ImDrawIdx*)upload_buffer_map(*uploads, ctx->ibo, 0, isize, true);
+    if (!vtx_write || !idx_write) return;
     for (int n = 0; n < dd->CmdListsCount; n++) {
         const ImDrawList* cl = dd->CmdLists[n];
         memcpy(vtx_write, cl->VtxBuffer.Data, cl->VtxBuffer.Size * sizeof(ImDrawVert));
@@ -228,109 +229,19 @@ void ImGuiSDL3GPU_Render(ImGuiSDL3GPU* ctx, SDL_GPUCommandBuffer* cb, SDL_GPUTex
         vtx_write += cl->VtxBuffer.Size;
         idx_write += cl->IdxBuffer.Size;
     }
-    SDL_UnmapGPUTransferBuffer(SDL_GetGPUDevice(cb), tbo_v);
-    SDL_UnmapGPUTransferBuffer(SDL_GetGPUDevice(cb), tbo_i);
-    SDL_GPUCopyPass* cpass = SDL_BeginGPUCopyPass(cb);
-    SDL_GPUTransferBufferLocation src_v;
-    SDL_zero(src_v);
-    src_v.transfer_buffer = tbo_v;
-    src_v.offset = 0;
-    SDL_GPUBufferRegion dst_v;
-    SDL_zero(dst_v);
-    dst_v.buffer = ctx->vbo;
-    dst_v.offset = 0;
-    dst_v.size = vsize;
-    SDL_UploadToGPUBuffer(cpass, &src_v, &dst_v, true);
-    SDL_GPUTransferBufferLocation src_i;
-    SDL_zero(src_i);
-    src_i.transfer_buffer = tbo_i;
-    src_i.offset = 0;
-    SDL_GPUBufferRegion dst_i;
-    SDL_zero(dst_i);
-    dst_i.buffer = ctx->ibo;
-    dst_i.offset = 0;
-    dst_i.size = isize;
-    SDL_UploadToGPUBuffer(cpass, &src_i, &dst_i, true);
-    SDL_EndGPUCopyPass(cpass);
-    SDL_ReleaseGPUTransferBuffer(SDL_GetGPUDevice(cb), tbo_v);
-    SDL_ReleaseGPUTransferBuffer(SDL_GetGPUDevice(cb), tbo_i);
-    if (!ctx->pipeline) {
-        SDL_GPUColorTargetBlendState blend;
-        SDL_zero(blend);
-        blend.enable_blend = true;
-        blend.src_color_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA;
-        blend.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
-        blend.color_blendop = SDL_GPU_BLENDOP_ADD;
-        blend.src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
-        blend.dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
-        blend.alpha_blendop = SDL_GPU_BLENDOP_ADD;
-        SDL_GPUColorTargetDescription cdesc;
-        SDL_zero(cdesc);
-        cdesc.format = color_format;
-        cdesc.blend_state = blend;
-        SDL_GPUGraphicsPipelineTargetInfo tgt;
-        SDL_zero(tgt);
-        tgt.color_target_descriptions = &cdesc;
-        tgt.num_color_targets = 1;
-        tgt.depth_stencil_format = SDL_GPU_TEXTUREFORMAT_INVALID;
-        SDL_GPURasterizerState rast;
-        SDL_zero(rast);
-        rast.fill_mode = SDL_GPU_FILLMODE_FILL;
-        rast.cull_mode = SDL_GPU_CULLMODE_NONE;
-        rast.front_face = SDL_GPU_FRONTFACE_COUNTER_CLOCKWISE;
-        SDL_GPUDepthStencilState ds;
-        SDL_zero(ds);
-        ds.enable_depth_test = false;
-        ds.enable_depth_write = false;
-        SDL_GPUMultisampleState ms;
-        SDL_zero(ms);
-        ms.sample_count = SDL_GPU_SAMPLECOUNT_1;
-        SDL_GPUVertexAttribute attrs[3];
-        SDL_zeroa(attrs);
-        attrs[0].location = 0;
-        attrs[0].buffer_slot = 0;
-        attrs[0].format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2;
-        attrs[0].offset = 0;
-        attrs[1].location = 1;
-        attrs[1].buffer_slot = 0;
-        attrs[1].format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2;
-        attrs[1].offset = sizeof(float) * 2;
-        attrs[2].location = 2;
-        attrs[2].buffer_slot = 0;
-        attrs[2].format = SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM;
-        attrs[2].offset = sizeof(float) * 4;
-        SDL_GPUVertexBufferDescription vbd;
-        SDL_zero(vbd);
-        vbd.slot = 0;
-        vbd.pitch = (Uint32)(sizeof(float) * 4 + sizeof(Uint32));
-        vbd.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX;
-        SDL_GPUVertexInputState vis;
-        SDL_zero(vis);
-        vis.vertex_buffer_descriptions = &vbd;
-        vis.num_vertex_buffers = 1;
-        vis.vertex_attributes = attrs;
-        vis.num_vertex_attributes = 3;
-        SDL_GPUGraphicsPipelineCreateInfo pci;
-        SDL_zero(pci);
-        pci.vertex_shader = ctx->vshader;
-        pci.fragment_shader = ctx->fshader;
-        pci.target_info = tgt;
-        pci.vertex_input_state = vis;
-        pci.primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST;
-        pci.rasterizer_state = rast;
-        pci.depth_stencil_state = ds;
-        pci.multisample_state = ms;
-        ctx->pipeline = SDL_CreateGPUGraphicsPipeline(SDL_GetGPUDevice(cb), &pci);
-    }
-    SDL_GPUColorTargetInfo ct;
-    SDL_zero(ct);
-    ct.texture = color_target;
-    ct.load_op = SDL_GPU_LOADOP_LOAD;
-    ct.store_op = SDL_GPU_STOREOP_STORE;
-    SDL_GPURenderPass* rp = SDL_BeginGPURenderPass(cb, &ct, 1, NULL);
+    ctx->uploaded = true;
+}
+
+static void setup_render_state(ImGuiSDL3GPU* ctx, const ImDrawData* dd, SDL_GPUCommandBuffer* cb, SDL_GPURenderPass* rp, int fb_w, int fb_h) {
     SDL_BindGPUGraphicsPipeline(rp, ctx->pipeline);
-    SDL_GPUBindFragmentSamplers(rp, 0, &ctx->font_sampler, 1);
-    SDL_GPUBindFragmentTextures(rp, 0, &ctx->font_tex, 1);
+    SDL_GPUViewport vp;
+    vp.x = 0;
+    vp.y = 0;
+    vp.w = (float)fb_w;
+    vp.h = (float)fb_h;
+    vp.min_depth = 0.0f;
+    vp.max_depth = 1.0f;
+    SDL_SetGPUViewport(rp, &vp);
     float L = dd->DisplayPos.x;
     float R = dd->DisplayPos.x + dd->DisplaySize.x;
     float T = dd->DisplayPos.y;
@@ -346,24 +257,125 @@ void ImGuiSDL3GPU_Render(ImGuiSDL3GPU* ctx, SDL_GPUCommandBuffer* cb, SDL_GPUTex
     vbind.buffer = ctx->vbo;
     vbind.offset = 0;
     SDL_BindGPUVertexBuffers(rp, 0, &vbind, 1);
-    SDL_BindGPUIndexBuffer(rp, ctx->ibo, SDL_GPU_INDEXELEMENTSIZE_16BIT, 0);
+    SDL_GPUBufferBinding ibind;
+    ibind.buffer = ctx->ibo;
+    ibind.offset = 0;
+    SDL_BindGPUIndexBuffer(rp, &ibind, sizeof(ImDrawIdx) == 2 ? SDL_GPU_INDEXELEMENTSIZE_16BIT : SDL_GPU_INDEXELEMENTSIZE_32BIT);
+}
+
+static SDL_GPUTexture* cmd_texture(const ImGuiSDL3GPU* ctx, const ImDrawCmd* pcmd) {
+    Uint64 id = (Uint64)pcmd->GetTexID();
+    if ((id & 1) && ctx->resolve) {
+        SDL_GPUTexture* resolved = ctx->resolve(ctx->resolve_user, id);
+        if (resolved) return resolved;
+    }
+    SDL_GPUTexture* tex = (SDL_GPUTexture*)(intptr_t)id;
+    return tex ? tex : ctx->font_tex;
+}
+
+static bool clip_rect_equal(const ImVec4& a, const ImVec4& b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+}
+
+void ImGuiSDL3GPU_RenderDrawData(ImGuiSDL3GPU* ctx, const ImDrawData* dd, SDL_GPUCommandBuffer* cb, SDL_GPURenderPass* rp, SDL_GPUTextureFormat color_format) {
+    Uint32 reallocs = ctx->stats.buffer_reallocs;
+    SDL_zero(ctx->stats);
+    ctx->stats.buffer_reallocs = reallocs;
+    ctx->stats.vbo_size = ctx->vbo_size;
+    ctx->stats.ibo_size = ctx->ibo_size;
+    if (!dd || dd->TotalVtxCount == 0 || !ctx->uploaded) return;
+    int fb_w = (int)(dd->DisplaySize.x * dd->FramebufferScale.x);
+    int fb_h = (int)(dd->DisplaySize.y * dd->FramebufferScale.y);
+    if (fb_w <= 0 || fb_h <= 0) return;
+    if (!ctx->pipeline || ctx->pipeline_format != color_format) {
+        if (ctx->pipeline) SDL_ReleaseGPUGraphicsPipeline(ctx->device, ctx->pipeline);
+        ctx->pipeline = create_pipeline(ctx, color_format);
+        ctx->pipeline_format = color_format;
+        if (!ctx->pipeline) return;
+    }
+    setup_render_state(ctx, dd, cb, rp, fb_w, fb_h);
+
+    ImVec2 clip_off = dd->DisplayPos;
+    ImVec2 clip_scale = dd->FramebufferScale;
+    SDL_GPUTexture* bound_tex = NULL;
+    SDL_Rect bound_sc = { -1, -1, -1, -1 };
     int vtx_offset = 0;
     int idx_offset = 0;
     for (int n = 0; n < dd->CmdListsCount; n++) {
         const ImDrawList* cl = dd->CmdLists[n];
         for (int cmd_i = 0; cmd_i < cl->CmdBuffer.Size; cmd_i++) {
             const ImDrawCmd* pcmd = &cl->CmdBuffer[cmd_i];
+            ctx->stats.cmds++;
+            if (pcmd->UserCallback) {
+                if (pcmd->UserCallback == ImDrawCallback_ResetRenderState)
+                    setup_render_state(ctx, dd, cb, rp, fb_w, fb_h);
+                else
+                    pcmd->UserCallback(cl, pcmd);
+                bound_tex = NULL;
+                bound_sc.w = -1;
+                continue;
+            }
+
+            SDL_GPUTexture* tex = cmd_texture(ctx, pcmd);
+            Uint32 count = pcmd->ElemCount;
+            while (cmd_i + 1 < cl->CmdBuffer.Size) {
+                const ImDrawCmd* next = &cl->CmdBuffer[cmd_i + 1];
+                if (next->UserCallback || next->VtxOffset != pcmd->VtxOffset || next->IdxOffset != pcmd->IdxOffset + count) break;
+                if (!clip_rect_equal(next->ClipRect, pcmd->ClipRect) || cmd_texture(ctx, next) != tex) break;
+                count += next->ElemCount;
+                cmd_i++;
+                ctx->stats.cmds++;
+            }
+
+            float min_x = (pcmd->ClipRect.x - clip_off.x) * clip_scale.x;
+            float min_y = (pcmd->ClipRect.y - clip_off.y) * clip_scale.y;
+            float max_x = (pcmd->ClipRect.z - clip_off.x) * clip_scale.x;
+            float max_y = (pcmd->ClipRect.w - clip_off.y) * clip_scale.y;
+            if (min_x < 0.0f) min_x = 0.0f;
+            if (min_y < 0.0f) min_y = 0.0f;
+            if (max_x > (float)fb_w) max_x = (float)fb_w;
+            if (max_y > (float)fb_h) max_y = (float)fb_h;
+            if (max_x <= min_x || max_y <= min_y) continue;
+
             SDL_Rect sc;
-            sc.x = (int)(pcmd->ClipRect.x);
-            sc.y = (int)(pcmd->ClipRect.y);
-            sc.w = (int)(pcmd->ClipRect.z - pcmd->ClipRect.x);
-            sc.h = (int)(pcmd->ClipRect.w - pcmd->ClipRect.y);
-            SDL_SetGPUScissor(rp, &sc);
-            SDL_DrawGPUIndexedPrimitives(rp, pcmd->ElemCount, 1, idx_offset, vtx_offset, 0);
-            idx_offset += pcmd->ElemCount;
+            sc.x = (int)min_x;
+            sc.y = (int)min_y;
+            sc.w = (int)(max_x - min_x);
+            sc.h = (int)(max_y - min_y);
+            if (sc.x != bound_sc.x || sc.y != bound_sc.y || sc.w != bound_sc.w || sc.h != bound_sc.h) {
+                SDL_SetGPUScissor(rp, &sc);
+                bound_sc = sc;
+                ctx->stats.scissor_changes++;
+            }
+            if (tex != bound_tex) {
+                SDL_GPUTextureSamplerBinding binding;
+                binding.texture = tex;
+                binding.sampler = ctx->font_sampler;
+                SDL_BindGPUFragmentSamplers(rp, 0, &binding, 1);
+                bound_tex = tex;
+                ctx->stats.texture_binds++;
+            }
+            SDL_DrawGPUIndexedPrimitives(rp, count, 1, (Uint32)idx_offset + pcmd->IdxOffset, vtx_offset + (Sint32)pcmd->VtxOffset, 0);
+            ctx->stats.draws++;
         }
+        idx_offset += cl->IdxBuffer.Size;
         vtx_offset += cl->VtxBuffer.Size;
     }
-    SDL_EndGPURenderPass(rp);
+    SDL_Rect full = { 0, 0, fb_w, fb_h };
+    SDL_SetGPUScissor(rp, &full);
 }
 
+void ImGuiSDL3GPU_SetTextureResolver(ImGuiSDL3GPU* ctx, ImGuiSDL3GPU_TextureResolver resolve, void* user) {
+    ctx->resolve = resolve;
+    ctx->resolve_user = user;
+}
+
+void ImGuiSDL3GPU_SetSampler(ImGuiSDL3GPU* ctx, SDL_GPUSampler* sampler) {
+    if (ctx->font_sampler && ctx->owns_sampler) SDL_ReleaseGPUSampler(ctx->device, ctx->font_sampler);
+    ctx->font_sampler = sampler;
+    ctx->owns_sampler = false;
+}
+
+ImGuiSDL3GPU_Stats ImGuiSDL3GPU_GetStats(const ImGuiSDL3GPU* ctx) {
+    return ctx->stats;
+}
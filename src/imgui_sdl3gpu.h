@@ -9,15 +9,37 @@ extern "C" {
 #endif
 
 typedef struct ImGuiSDL3GPU ImGuiSDL3GPU;
+typedef struct UploadRing UploadRing;
+typedef struct ImDrawData ImDrawData;
 
-ImGuiSDL3GPU* ImGuiSDL3GPU_Create(SDL_GPUDevice* device, SDL_Window* window, const char* vs_spv_path, const char* fs_spv_path);
-void ImGuiSDL3GPU_Destroy(ImGuiSDL3GPU* ctx, SDL_GPUDevice* device);
+typedef struct ImGuiSDL3GPU_Stats {
+    Uint32 cmds;
+    Uint32 draws;
+    Uint32 scissor_changes;
+    Uint32 texture_binds;
+    Uint32 buffer_reallocs;
+    Uint32 vbo_size;
+    Uint32 ibo_size;
+} ImGuiSDL3GPU_Stats;
+
+/* Maps texture ids with the low bit set (never a valid pointer) to textures
+   at record time, for textures that may be replaced between frames. NULL
+   from the resolver falls back to the font texture. */
+typedef SDL_GPUTexture* (*ImGuiSDL3GPU_TextureResolver)(void* user, Uint64 id);
+
+ImGuiSDL3GPU* ImGuiSDL3GPU_Create(SDL_GPUDevice* device, UploadRing* uploads, const void* vs_spv, size_t vs_size, const void* fs_spv, size_t fs_size);
+void ImGuiSDL3GPU_Destroy(ImGuiSDL3GPU* ctx);
 void ImGuiSDL3GPU_NewFrame(ImGuiSDL3GPU* ctx, SDL_Window* window, float dt);
-void ImGuiSDL3GPU_Render(ImGuiSDL3GPU* ctx, SDL_GPUCommandBuffer* cb, SDL_GPUTexture* color_target, SDL_GPUTextureFormat color_format);
+void ImGuiSDL3GPU_PrepareDrawData(ImGuiSDL3GPU* ctx, const ImDrawData* dd, UploadRing* uploads);
+void ImGuiSDL3GPU_RenderDrawData(ImGuiSDL3GPU* ctx, const ImDrawData* dd, SDL_GPUCommandBuffer* cb, SDL_GPURenderPass* rp, SDL_GPUTextureFormat color_format);
+void ImGuiSDL3GPU_SetTextureResolver(ImGuiSDL3GPU* ctx, ImGuiSDL3GPU_TextureResolver resolve, void* user);
+/* Samples every texture with a sampler the caller owns and keeps alive until
+   ImGuiSDL3GPU_Destroy, releasing the backend's own. */
+void ImGuiSDL3GPU_SetSampler(ImGuiSDL3GPU* ctx, SDL_GPUSampler* sampler);
+ImGuiSDL3GPU_Stats ImGuiSDL3GPU_GetStats(const ImGuiSDL3GPU* ctx);
 
 #ifdef __cplusplus
 }
 #endif
 
 #endif
-
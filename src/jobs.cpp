@@ -0,0 +1,369 @@
+#include "jobs.h"
+#include "arena.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "imgui.h"
+
+namespace jobs {
+
+namespace {
+
+struct Job {
+    JobFunc func = nullptr;
+    void* user = nullptr;
+    Uint32 index = 0;
+    Counter* counter = nullptr;
+};
+
+// One mutex per deque: the owner's lock is uncontended unless someone is
+// stealing, and steals are rare next to pushes and pops, so a lock-free
+// deque would buy little for its subtlety.
+struct alignas(64) Deque {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+};
+
+struct alignas(64) Slot {
+    Deque deque;
+    std::atomic<Uint64> jobs{ 0 };
+    std::atomic<Uint64> steals{ 0 };
+    std::atomic<Uint64> busy_ns{ 0 };
+};
+
+// Jobs held back by run_after until `after` reaches zero.
+struct Continuation {
+    Counter* after = nullptr;
+    JobFunc func = nullptr;
+    void* user = nullptr;
+    Uint32 count = 0;
+    Counter* counter = nullptr;
+};
+
+struct Scheduler {
+    std::unique_ptr<Slot[]> slots;
+    Uint32 count = 0;
+    std::vector<std::thread> threads;
+    Deque main_queue;
+    // Long-running jobs (file loads, decodes) only worker threads pick up
+    // between their own jobs, never a thread waiting on a counter.
+    Deque background;
+    // Jobs run from threads outside the pool; any pool thread takes them
+    // oldest first, ahead of stealing.
+    Deque external;
+    std::atomic<Uint64> external_jobs{ 0 };
+
+    std::mutex continuation_mutex;
+    std::vector<Continuation> continuations;
+    std::atomic<Uint32> waiting{ 0 };
+
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::atomic<Uint32> queued{ 0 };
+    std::atomic<Uint32> sleepers{ 0 };
+    std::atomic<bool> quit{ false };
+};
+
+Scheduler g_sched;
+thread_local Uint32 t_index = UINT32_MAX;
+
+Uint32 main_index() {
+    return g_sched.count - 1;
+}
+
+void push_jobs(JobFunc func, void* user, Uint32 count, Counter* counter);
+
+// Schedules the continuations held back by `after`, which has just reached
+// zero. Only compares the address: `after` may already be gone.
+void release_continuations(const Counter* after) {
+    ArenaScope scratch(arena_scratch());
+    ArenaVector<Continuation> ready{ ArenaAllocator<Continuation>(scratch.arena) };
+    {
+        std::lock_guard<std::mutex> lock(g_sched.continuation_mutex);
+        size_t keep = 0;
+        for (const Continuation& c : g_sched.continuations) {
+            if (c.after == after) ready.push_back(c);
+            else g_sched.continuations[keep++] = c;
+        }
+        g_sched.continuations.resize(keep);
+        g_sched.waiting.fetch_sub((Uint32)ready.size());
+    }
+    for (const Continuation& c : ready) push_jobs(c.func, c.user, c.count, c.counter);
+}
+
+void execute(const Job& job, Uint32 self) {
+    Uint64 t0 = SDL_GetTicksNS();
+    {
+        // Nested waits run jobs inside jobs; marks keep each one's scratch.
+        ArenaScope scratch(arena_scratch());
+        job.func(job.user, job.index);
+    }
+    if (self < g_sched.count) {
+        Slot& s = g_sched.slots[self];
+        s.busy_ns.fetch_add(SDL_GetTicksNS() - t0, std::memory_order_relaxed);
+        s.jobs.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!job.counter) return;
+    // Sequentially consistent with run_after: either it sees the counter at
+    // zero or the job that drains it sees its continuation waiting. The
+    // counter is not touched after the decrement; it may be gone once a
+    // waiter sees zero.
+    if (job.counter->pending.fetch_sub(1) == 1 && g_sched.waiting.load() > 0) release_continuations(job.counter);
+}
+
+bool pop_back(Deque& d, Job& out) {
+    std::lock_guard<std::mutex> lock(d.mutex);
+    if (d.jobs.empty()) return false;
+    out = d.jobs.back();
+    d.jobs.pop_back();
+    return true;
+}
+
+bool pop_front(Deque& d, Job& out) {
+    std::lock_guard<std::mutex> lock(d.mutex);
+    if (d.jobs.empty()) return false;
+    out = d.jobs.front();
+    d.jobs.pop_front();
+    return true;
+}
+
+// Own deque newest first (cache-warm), then the oldest job of each other
+// thread, starting with the next one so thieves spread out.
+bool run_one(Uint32 self) {
+    Job job;
+    if (self == main_index() && pop_front(g_sched.main_queue, job)) {
+        execute(job, self);
+        return true;
+    }
+    if (self < g_sched.count && pop_back(g_sched.slots[self].deque, job)) {
+        g_sched.queued.fetch_sub(1);
+        execute(job, self);
+        return true;
+    }
+    if (pop_front(g_sched.external, job)) {
+        g_sched.queued.fetch_sub(1);
+        execute(job, self);
+        return true;
+    }
+    for (Uint32 k = 1; k <= g_sched.count; k++) {
+        Uint32 victim = (self + k) % g_sched.count;
+        if (victim == self || !pop_front(g_sched.slots[victim].deque, job)) continue;
+        g_sched.queued.fetch_sub(1);
+        if (self < g_sched.count) g_sched.slots[self].steals.fetch_add(1, std::memory_order_relaxed);
+        execute(job, self);
+        return true;
+    }
+    return false;
+}
+
+bool run_background(Uint32 self) {
+    Job job;
+    if (!pop_front(g_sched.background, job)) return false;
+    g_sched.queued.fetch_sub(1);
+    execute(job, self);
+    return true;
+}
+
+void worker_main(Uint32 index) {
+    t_index = index;
+    while (!g_sched.quit.load()) {
+        if (run_one(index) || run_background(index)) continue;
+        // Dekker-style handshake with run(): either the pusher sees this
+        // sleeper and notifies, or the predicate sees the pushed job.
+        g_sched.sleepers.fetch_add(1);
+        {
+            std::unique_lock<std::mutex> lock(g_sched.sleep_mutex);
+            g_sched.wake.wait(lock, [] { return g_sched.quit.load() || g_sched.queued.load() > 0; });
+        }
+        g_sched.sleepers.fetch_sub(1);
+    }
+}
+
+void wake_sleepers(Uint32 n) {
+    if (g_sched.sleepers.load() == 0) return;
+    { std::lock_guard<std::mutex> lock(g_sched.sleep_mutex); }
+    if (n == 1) g_sched.wake.notify_one();
+    else g_sched.wake.notify_all();
+}
+
+}
+
+bool init(Uint32 workers) {
+    if (g_sched.count) return true;
+    g_sched.count = workers + 1;
+    g_sched.slots.reset(new Slot[g_sched.count]);
+    g_sched.quit.store(false);
+    t_index = main_index();
+    for (Uint32 i = 0; i < workers; i++) g_sched.threads.emplace_back(worker_main, i);
+    return true;
+}
+
+void shutdown() {
+    if (!g_sched.count) return;
+    {
+        std::lock_guard<std::mutex> lock(g_sched.sleep_mutex);
+        g_sched.quit.store(true);
+    }
+    g_sched.wake.notify_all();
+    for (std::thread& t : g_sched.threads) t.join();
+    g_sched.threads.clear();
+    g_sched.slots.reset();
+    g_sched.count = 0;
+    g_sched.queued.store(0);
+    t_index = UINT32_MAX;
+}
+
+Uint32 thread_count() {
+    return g_sched.count;
+}
+
+Uint32 thread_index() {
+    return t_index;
+}
+
+namespace {
+
+// Queues jobs whose counter already includes them.
+void push_jobs(JobFunc func, void* user, Uint32 count, Counter* counter) {
+    if (!g_sched.count) {
+        for (Uint32 i = 0; i < count; i++) execute(Job{ func, user, i, counter }, UINT32_MAX);
+        return;
+    }
+    const bool pooled = t_index < g_sched.count;
+    Deque& d = pooled ? g_sched.slots[t_index].deque : g_sched.external;
+    {
+        std::lock_guard<std::mutex> lock(d.mutex);
+        for (Uint32 i = 0; i < count; i++) d.jobs.push_back(Job{ func, user, i, counter });
+    }
+    if (!pooled) g_sched.external_jobs.fetch_add(count, std::memory_order_relaxed);
+    g_sched.queued.fetch_add(count);
+    wake_sleepers(count);
+}
+
+}
+
+void run(JobFunc func, void* user, Uint32 count, Counter* counter) {
+    if (count == 0) return;
+    if (counter) counter->pending.fetch_add(count, std::memory_order_relaxed);
+    push_jobs(func, user, count, counter);
+}
+
+void run_after(Counter& after, JobFunc func, void* user, Uint32 count, Counter* counter) {
+    if (count == 0) return;
+    // Counted now, so waiting on `counter` also covers jobs not queued yet.
+    if (counter) counter->pending.fetch_add(count, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(g_sched.continuation_mutex);
+        g_sched.waiting.fetch_add(1);
+        if (after.pending.load() != 0) {
+            g_sched.continuations.push_back(Continuation{ &after, func, user, count, counter });
+            return;
+        }
+        g_sched.waiting.fetch_sub(1);
+    }
+    push_jobs(func, user, count, counter);
+}
+
+Uint64 external_jobs() {
+    return g_sched.external_jobs.load(std::memory_order_relaxed);
+}
+
+void run_main(JobFunc func, void* user, Uint32 index, Counter* counter) {
+    if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(g_sched.main_queue.mutex);
+    g_sched.main_queue.jobs.push_back(Job{ func, user, index, counter });
+}
+
+void run_background(JobFunc func, void* user, Uint32 count, Counter* counter) {
+    if (count == 0) return;
+    if (counter) counter->pending.fetch_add(count, std::memory_order_relaxed);
+    if (!g_sched.count) {
+        for (Uint32 i = 0; i < count; i++) execute(Job{ func, user, i, counter }, UINT32_MAX);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_sched.background.mutex);
+        for (Uint32 i = 0; i < count; i++) g_sched.background.jobs.push_back(Job{ func, user, i, counter });
+    }
+    g_sched.queued.fetch_add(count);
+    wake_sleepers(count);
+}
+
+bool done(const Counter& counter) {
+    return counter.pending.load(std::memory_order_acquire) == 0;
+}
+
+void wait(Counter& counter) {
+    while (!done(counter)) {
+        if (!run_one(t_index)) std::this_thread::yield();
+    }
+}
+
+void pump_main() {
+    if (t_index != main_index()) return;
+    Job job;
+    while (pop_front(g_sched.main_queue, job)) execute(job, t_index);
+    // Without workers nobody else runs background jobs; one per pump.
+    if (g_sched.threads.empty()) run_background(t_index);
+}
+
+std::vector<WorkerStats> stats() {
+    std::vector<WorkerStats> out(g_sched.count);
+    for (Uint32 i = 0; i < g_sched.count; i++) {
+        out[i].jobs = g_sched.slots[i].jobs.load(std::memory_order_relaxed);
+        out[i].steals = g_sched.slots[i].steals.load(std::memory_order_relaxed);
+        out[i].busy_ns = g_sched.slots[i].busy_ns.load(std::memory_order_relaxed);
+    }
+    return out;
+}
+
+// Busy time is shown as a share of the last half-second sample window.
+void draw_stats(bool* open) {
+    static std::vector<WorkerStats> prev;
+    static std::vector<double> busy;
+    static Uint64 prev_ns = 0;
+    static Uint64 external = 0;
+
+    Uint64 now = SDL_GetTicksNS();
+    if (now - prev_ns >= 500000000ull || prev.size() != g_sched.count) {
+        std::vector<WorkerStats> cur = stats();
+        busy.assign(cur.size(), 0.0);
+        if (prev.size() == cur.size() && now > prev_ns)
+            for (size_t i = 0; i < cur.size(); i++) busy[i] = (double)(cur[i].busy_ns - prev[i].busy_ns) / (double)(now - prev_ns);
+        prev.swap(cur);
+        prev_ns = now;
+        external = external_jobs();
+    }
+
+    ImGui::SetNextWindowCollapsed(true, ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Jobs", open)) {
+        ImGui::End();
+        return;
+    }
+    if (ImGui::BeginTable("workers", 4, ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("thread");
+        ImGui::TableSetupColumn("jobs");
+        ImGui::TableSetupColumn("steals");
+        ImGui::TableSetupColumn("busy");
+        ImGui::TableHeadersRow();
+        for (size_t i = 0; i < prev.size(); i++) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            if (i + 1 == prev.size()) ImGui::TextUnformatted("main");
+            else ImGui::Text("worker %zu", i);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)prev[i].jobs);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)prev[i].steals);
+            ImGui::TableNextColumn();
+            ImGui::Text("%5.1f%%", busy[i] * 100.0);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::Text("%llu jobs queued from outside the pool", (unsigned long long)external);
+    ImGui::End();
+}
+
+}
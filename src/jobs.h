@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <SDL3/SDL.h>
+
+namespace jobs {
+
+// A job is func(user, index). run() with count N is a parallel for over
+// index 0..N-1; each job decrements `counter` once it has finished.
+using JobFunc = void (*)(void* user, Uint32 index);
+
+struct Counter {
+    std::atomic<Uint32> pending{ 0 };
+};
+
+struct WorkerStats {
+    Uint64 jobs = 0;
+    Uint64 steals = 0;
+    Uint64 busy_ns = 0;
+};
+
+// Starts `workers` threads. The calling thread becomes the main thread: it
+// has a deque of its own (index workers) and is the only one to run jobs
+// queued with run_main.
+bool init(Uint32 workers);
+void shutdown();
+
+// Number of job threads including the main thread, and the index of the
+// calling one (thread_count() - 1 is the main thread; UINT32_MAX off-pool).
+Uint32 thread_count();
+Uint32 thread_index();
+
+// Pushes onto the calling thread's deque; idle workers steal from the other
+// end. From outside the pool the jobs go to a shared queue instead, which
+// every pool thread takes from before stealing.
+void run(JobFunc func, void* user, Uint32 count, Counter* counter = nullptr);
+// Queues the jobs once `after` reaches zero, from the thread that finishes
+// its last job, without blocking anyone; at once if it is already zero.
+// `after` must not gain jobs meanwhile, and must stay alive and unused for
+// other run_after calls until the jobs are queued: wait on `counter`, which
+// counts them from this call on, rather than on `after` before dropping it.
+void run_after(Counter& after, JobFunc func, void* user, Uint32 count, Counter* counter = nullptr);
+// Long-running work that must not delay a frame: runs only on idle workers
+// (or one job per pump_main without workers), never inside wait().
+void run_background(JobFunc func, void* user, Uint32 count, Counter* counter = nullptr);
+// Main-thread affinity: runs during pump_main or a wait on the main thread.
+void run_main(JobFunc func, void* user, Uint32 index = 0, Counter* counter = nullptr);
+
+bool done(const Counter& counter);
+// Runs other jobs until `counter` reaches zero, so waiting never idles a
+// thread that could make progress.
+void wait(Counter& counter);
+void pump_main();
+
+// Per thread, same order as thread_index().
+std::vector<WorkerStats> stats();
+// Jobs run() was given from threads outside the pool.
+Uint64 external_jobs();
+void draw_stats(bool* open = nullptr);
+
+}
@@ -0,0 +1,336 @@
+#include "logui.h"
+#include <chrono>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include "imgui.h"
+
+namespace logui {
+
+namespace {
+
+struct Entry {
+    level lvl = level::info;
+    Uint16 len = 0;
+    char text[LINE_MAX_BYTES];
+};
+
+// Bounded multi-producer queue (Vyukov): every cell carries a sequence number
+// telling producers and the consumer whose turn it is, so neither side locks.
+struct Queue {
+    struct Cell {
+        std::atomic<size_t> seq{ 0 };
+        Entry entry;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> enqueue_pos{ 0 };
+    alignas(64) std::atomic<size_t> dequeue_pos{ 0 };
+};
+
+// Writer thread -> frame. Single producer, single consumer.
+struct Forward {
+    std::unique_ptr<Entry[]> entries;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> write_pos{ 0 };
+    alignas(64) std::atomic<size_t> read_pos{ 0 };
+};
+
+struct Logger {
+    Queue queue;
+    Forward forward;
+    FILE* out = nullptr;
+    bool owns_out = false;
+    std::thread writer;
+    std::atomic<bool> running{ false };
+    std::atomic<bool> stop{ false };
+    std::atomic<Uint64> lines{ 0 };
+    std::atomic<Uint64> dropped{ 0 };
+    std::atomic<Uint64> truncated{ 0 };
+    std::atomic<Uint64> console_dropped{ 0 };
+};
+
+Logger g_logger;
+
+size_t round_pow2(size_t v) {
+    size_t p = 2;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+bool queue_push(Queue& q, level lvl, const char* s, size_t len) {
+    size_t pos = q.enqueue_pos.load(std::memory_order_relaxed);
+    Queue::Cell* cell;
+    for (;;) {
+        cell = &q.cells[pos & q.mask];
+        size_t seq = cell->seq.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (q.enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = q.enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+    cell->entry.lvl = lvl;
+    cell->entry.len = (Uint16)len;
+    std::memcpy(cell->entry.text, s, len);
+    cell->entry.text[len] = 0;
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool queue_pop(Queue& q, Entry& out) {
+    size_t pos = q.dequeue_pos.load(std::memory_order_relaxed);
+    Queue::Cell* cell;
+    for (;;) {
+        cell = &q.cells[pos & q.mask];
+        size_t seq = cell->seq.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (q.dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = q.dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+    out = cell->entry;
+    cell->seq.store(pos + q.mask + 1, std::memory_order_release);
+    return true;
+}
+
+void forward_push(Forward& f, const Entry& e) {
+    size_t w = f.write_pos.load(std::memory_order_relaxed);
+    if (w - f.read_pos.load(std::memory_order_acquire) > f.mask) {
+        g_logger.console_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    f.entries[w & f.mask] = e;
+    f.write_pos.store(w + 1, std::memory_order_release);
+}
+
+void write_line(level lvl, const char* s, size_t len) {
+    if (len && s[len - 1] == '\r') len--;
+    if (len > LINE_MAX_BYTES - 1) {
+        len = LINE_MAX_BYTES - 1;
+        g_logger.truncated.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!g_logger.running.load(std::memory_order_acquire)) {
+        std::fprintf(stderr, "%.*s\n", (int)len, s);
+        return;
+    }
+    if (queue_push(g_logger.queue, lvl, s, len))
+        g_logger.lines.fetch_add(1, std::memory_order_relaxed);
+    else
+        g_logger.dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void writer_main() {
+    Logger& lg = g_logger;
+    Entry e;
+    for (;;) {
+        bool wrote = false;
+        while (queue_pop(lg.queue, e)) {
+            std::fwrite(e.text, 1, e.len, lg.out);
+            std::fputc('\n', lg.out);
+            forward_push(lg.forward, e);
+            wrote = true;
+        }
+        if (wrote) {
+            std::fflush(lg.out);
+            continue;
+        }
+        if (lg.stop.load(std::memory_order_acquire)) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
+
+}
+
+bool init(const char* path, size_t queue_slots) {
+    Logger& lg = g_logger;
+    if (lg.running.load()) return true;
+    size_t n = round_pow2(queue_slots);
+    lg.queue.cells.reset(new Queue::Cell[n]);
+    lg.queue.mask = n - 1;
+    for (size_t i = 0; i < n; i++) lg.queue.cells[i].seq.store(i, std::memory_order_relaxed);
+    lg.queue.enqueue_pos.store(0);
+    lg.queue.dequeue_pos.store(0);
+    lg.forward.entries.reset(new Entry[n]);
+    lg.forward.mask = n - 1;
+
+    lg.out = stderr;
+    lg.owns_out = false;
+    if (path) {
+        FILE* f = std::fopen(path, "ab");
+        if (f) {
+            lg.out = f;
+            lg.owns_out = true;
+        }
+    }
+    lg.stop.store(false);
+    lg.writer = std::thread(writer_main);
+    lg.running.store(true, std::memory_order_release);
+    std::atexit(shutdown);
+    return lg.out != stderr || !path;
+}
+
+void shutdown() {
+    Logger& lg = g_logger;
+    if (!lg.running.exchange(false)) return;
+    lg.stop.store(true, std::memory_order_release);
+    if (lg.writer.joinable()) lg.writer.join();
+    if (lg.owns_out) std::fclose(lg.out);
+    lg.out = nullptr;
+    lg.owns_out = false;
+}
+
+void write(level lvl, const char* text, size_t len) {
+    const char* p = text;
+    const char* end = text + len;
+    for (;;) {
+        const char* nl = (const char*)std::memchr(p, '\n', (size_t)(end - p));
+        if (!nl) {
+            if (p < end) write_line(lvl, p, (size_t)(end - p));
+            return;
+        }
+        write_line(lvl, p, (size_t)(nl - p));
+        p = nl + 1;
+    }
+}
+
+void logf(level lvl, const char* fmt, ...) {
+    char buf[2048];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = std::vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    write(lvl, buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+}
+
+LogStats stats() {
+    LogStats s;
+    s.lines = g_logger.lines.load(std::memory_order_relaxed);
+    s.dropped = g_logger.dropped.load(std::memory_order_relaxed);
+    s.truncated = g_logger.truncated.load(std::memory_order_relaxed);
+    s.console_dropped = g_logger.console_dropped.load(std::memory_order_relaxed);
+    return s;
+}
+
+Console::Console(size_t lines) {
+    if (lines == 0) lines = 1;
+    text.resize(lines * LINE_MAX_BYTES);
+    meta.resize(lines);
+    index.resize(lines);
+}
+
+void Console::clear() {
+    head = 0;
+    count = 0;
+    index_head = 0;
+    index_count = 0;
+}
+
+void Console::push(level lvl, const char* s, size_t len) {
+    size_t cap = capacity();
+    size_t slot;
+    if (count < cap) {
+        slot = (head + count) % cap;
+        count++;
+    } else {
+        slot = head;
+        head = (head + 1) % cap;
+        if (index_count && index[index_head] == (Uint32)slot) {
+            index_head = (index_head + 1) % cap;
+            index_count--;
+        }
+    }
+    if (len > LINE_MAX_BYTES - 1) len = LINE_MAX_BYTES - 1;
+    char* dst = &text[slot * LINE_MAX_BYTES];
+    std::memcpy(dst, s, len);
+    dst[len] = 0;
+    meta[slot].lvl = lvl;
+    meta[slot].len = (Uint16)len;
+    if (filter & (1u << (unsigned)lvl)) {
+        index[(index_head + index_count) % cap] = (Uint32)slot;
+        index_count++;
+    }
+}
+
+void Console::set_filter(unsigned mask) {
+    filter = mask;
+    index_head = 0;
+    index_count = 0;
+    size_t cap = capacity();
+    for (size_t i = 0; i < count; i++) {
+        size_t slot = (head + i) % cap;
+        if (filter & (1u << (unsigned)meta[slot].lvl)) index[index_count++] = (Uint32)slot;
+    }
+}
+
+void pump(Console& console) {
+    Forward& f = g_logger.forward;
+    if (!f.entries) return;
+    size_t r = f.read_pos.load(std::memory_order_relaxed);
+    size_t w = f.write_pos.load(std::memory_order_acquire);
+    for (; r != w; r++) {
+        const Entry& e = f.entries[r & f.mask];
+        console.push(e.lvl, e.text, e.len);
+    }
+    f.read_pos.store(r, std::memory_order_release);
+}
+
+static ImVec4 color(level lvl) {
+    if (lvl == level::info)  return ImVec4(0.85f, 0.85f, 0.85f, 1.0f);
+    if (lvl == level::warn)  return ImVec4(0.95f, 0.80f, 0.35f, 1.0f);
+    return ImVec4(1.00f, 0.45f, 0.45f, 1.0f);
+}
+
+void draw(Console& console, bool* open) {
+    if (!ImGui::Begin("Console", open)) {
+        ImGui::End();
+        return;
+    }
+
+    if (ImGui::Button("Clear")) console.clear();
+    ImGui::SameLine();
+    ImGui::Checkbox("Auto-scroll", &console.autoscroll);
+    static const char* names[] = { "Info", "Warn", "Error" };
+    for (unsigned i = 0; i < 3; i++) {
+        bool on = (console.filter & (1u << i)) != 0;
+        ImGui::SameLine();
+        if (ImGui::Checkbox(names[i], &on)) console.set_filter(console.filter ^ (1u << i));
+    }
+    LogStats s = stats();
+    if (s.dropped || s.console_dropped) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("dropped %llu", (unsigned long long)(s.dropped + s.console_dropped));
+    }
+    ImGui::Separator();
+
+    size_t cap = console.capacity();
+    ImGuiListClipper clipper;
+    clipper.Begin((int)console.index_count);
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+            Uint32 slot = console.index[(console.index_head + (size_t)i) % cap];
+            const char* t = console.line_text(slot);
+            ImGui::PushStyleColor(ImGuiCol_Text, color(console.meta[slot].lvl));
+            ImGui::TextUnformatted(t, t + console.meta[slot].len);
+            ImGui::PopStyleColor();
+        }
+    }
+
+    if (console.autoscroll)
+        ImGui::SetScrollHereY(1.0f);
+
+    ImGui::End();
+}
+
+}
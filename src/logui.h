@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+#include <SDL3/SDL.h>
+
+namespace logui {
+
+enum class level { info, warn, error };
+
+static const size_t LINE_MAX_BYTES = 256;
+
+struct LogStats {
+    Uint64 lines = 0;
+    Uint64 dropped = 0;
+    Uint64 truncated = 0;
+    // Written to the output but lost on the way to the console, which had
+    // not pumped them yet.
+    Uint64 console_dropped = 0;
+};
+
+// Starts the writer thread. Lines are written to `path`, or stderr when null.
+// Safe to call logf/write before init (or after shutdown), but those lines go
+// straight to stderr and never reach a Console.
+bool init(const char* path = nullptr, size_t queue_slots = 4096);
+void shutdown();
+
+// Lock-free from any thread. Multi-line messages become one entry per line;
+// when the queue is full the line is dropped and counted, never waited on.
+void write(level lvl, const char* text, size_t len);
+void logf(level lvl, const char* fmt, ...);
+LogStats stats();
+
+// Console-side store: fixed-size line slots in one arena, overwritten oldest
+// first, plus an index of the slots that pass the current level filter.
+struct Console {
+    struct Meta {
+        level lvl = level::info;
+        Uint16 len = 0;
+    };
+
+    std::vector<char> text;
+    std::vector<Meta> meta;
+    size_t head = 0;
+    size_t count = 0;
+
+    std::vector<Uint32> index;
+    size_t index_head = 0;
+    size_t index_count = 0;
+    unsigned filter = 0x7;
+    bool autoscroll = true;
+
+    explicit Console(size_t lines = 2048);
+    size_t capacity() const { return meta.size(); }
+    void clear();
+    void push(level lvl, const char* s, size_t len);
+    void set_filter(unsigned mask);
+    const char* line_text(Uint32 slot) const { return &text[(size_t)slot * LINE_MAX_BYTES]; }
+};
+
+// Moves lines the writer thread has forwarded into the console. Call once per
+// frame from the thread that draws the console.
+void pump(Console& console);
+void draw(Console& console, bool* open = nullptr);
+
+}
@@ -2,9 +2,9 @@
 #include <SDL3/SDL_gpu.h>
 #include "imgui.h"
 #include "backends/imgui_impl_sdl3.h"
-#include "backends/imgui_impl_sdlgpu3.h"
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <array>
@@ -12,6 +12,7 @@
 #include <iterator>
 #include <memory>
 #include <thread>
+#include <mutex>
 #include <chrono>
 #include <stdexcept>
 #include <shaderc/shaderc.hpp>
@@ -19,114 +20,36 @@
 #include "shader.h"
 #include "shader_reflect.h"
 #include "pipeline_config.h"
-
-namespace logui
-{
-    enum class level { info, warn, error };
-
-    struct line
-    {
-        level lvl{};
-        std::string text;
-    };
-
-    struct ring
-    {
-        std::vector<line> data;
-        size_t head = 0;
-        size_t count = 0;
-
-        ring(size_t cap = 1024)
-        {
-            data.resize(cap);
-        }
-
-        size_t capacity() const
-        {
-            return data.size();
-        }
-
-        void clear()
-        {
-            head = 0;
-            count = 0;
-        }
-
-        void push(level lvl, std::string msg)
-        {
-            if (data.empty())
-                return;
-
-            size_t cap = capacity();
-            if (count < cap)
-            {
-                size_t idx = (head + count) % cap;
-                data[idx] = { lvl, std::move(msg) };
-                count++;
-                return;
-            }
-
-            data[head] = { lvl, std::move(msg) };
-            head = (head + 1) % cap;
-        }
-    };
-
-    static ImVec4 color(level lvl)
-    {
-        if (lvl == level::info)  return ImVec4(0.85f, 0.85f, 0.85f, 1.0f);
-        if (lvl == level::warn)  return ImVec4(0.95f, 0.80f, 0.35f, 1.0f);
-        return ImVec4(1.00f, 0.45f, 0.45f, 1.0f);
-    }
-
-    void draw(ring* buf, bool* open = nullptr)
-    {
-        if (!buf)
-            return;
-
-        if (!ImGui::Begin("Console", open))
-        {
-            ImGui::End();
-            return;
-        }
-
-        static bool autoscroll = true;
-        if (ImGui::Button("Clear")) buf->clear();
-        ImGui::SameLine();
-        ImGui::Checkbox("Auto-scroll", &autoscroll);
-        ImGui::Separator();
-
-        ImGuiListClipper clipper;
-        clipper.Begin((int)buf->count);
-        while (clipper.Step())
-        {
-            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
-            {
-                size_t idx = (buf->head + (size_t)i) % buf->capacity();
-                const line& ln = buf->data[idx];
-                ImGui::PushStyleColor(ImGuiCol_Text, color(ln.lvl));
-                ImGui::TextUnformatted(ln.text.c_str());
-                ImGui::PopStyleColor();
-            }
-        }
-
-        if (autoscroll)
-            ImGui::SetScrollHereY(1.0f);
-
-        ImGui::End();
-    }
-}
+#include "upload_ring.h"
+#include "gpu_pool.h"
+#include "imgui_sdl3gpu.h"
+#include "logui.h"
+#include "mesh.h"
+#include "draw_list.h"
+#include "compute_list.h"
+#include "gpu_cull.h"
+#include "object_buffer.h"
+#include "uniforms.h"
+#include "parallel_record.h"
+#include "jobs.h"
+#include "render_queue.h"
+#include "sim.h"
+#include "texture_stream.h"
+#include "state_cache.h"
+#include "readback_ring.h"
+#include "frame_dump.h"
+#include "post_chain.h"
+#include "slot_map.h"
+#include "arena.h"
+#include "heap_count.h"
 
 #ifndef SHADER_SRC_DIR
 #define SHADER_SRC_DIR "shaders"
 #endif
 
-static logui::ring* g_console_ptr = nullptr;
-
-static inline void app_log(logui::level lvl, const std::string& msg)
+static inline void app_log(logui::level lvl, const char* msg)
 {
-    if (g_console_ptr)
-        g_console_ptr->push(lvl, msg);
-    std::fprintf(stderr, "%s\n", msg.c_str());
+    logui::write(lvl, msg, std::strlen(msg));
 }
 
 struct soft_error : std::runtime_error
@@ -199,6 +122,126 @@ namespace brender
         SDL_GPUCommandBuffer* command_buffer_ptr;
     };
 
+    // Where instance visibility is decided: not at all, on the render thread
+    // (compacted instances uploaded each frame), or by a compute pass feeding
+    // indirect draws.
+    enum class cull_mode { none, cpu, gpu };
+
+    // Where the vertex shader gets per-object data: an instance-rate vertex
+    // stream, or one storage buffer of ObjectRecords indexed by instance.
+    enum class object_source { stream, storage };
+
+    // Anti-aliasing applied to the resolved scene by a fullscreen pass.
+    enum class aa_post { none, fxaa, taa };
+
+    // Anti-aliasing modes selectable at runtime. MSAA is the scene pipelines'
+    // sample count, so switching between sample counts rebuilds them; the
+    // post modes draw at one sample and run in docked mode only.
+    struct aa_option
+    {
+        const char* key;
+        const char* name;
+        Uint32 samples;
+        aa_post post;
+    };
+
+    static const aa_option AA_OPTIONS[] =
+    {
+        { "off",   "off",     1, aa_post::none },
+        { "msaa2", "MSAA 2x", 2, aa_post::none },
+        { "msaa4", "MSAA 4x", 4, aa_post::none },
+        { "msaa8", "MSAA 8x", 8, aa_post::none },
+        { "fxaa",  "FXAA",    1, aa_post::fxaa },
+        { "taa",   "TAA",     1, aa_post::taa },
+    };
+    static constexpr Uint32 AA_COUNT = sizeof(AA_OPTIONS) / sizeof(AA_OPTIONS[0]);
+
+    // Index of the option with `key`, or of the MSAA option for `samples`
+    // when there is none.
+    static Uint32 find_aa(const char* key, Uint32 samples)
+    {
+        for (Uint32 i = 0; key && i < AA_COUNT; i++)
+            if (SDL_strcasecmp(AA_OPTIONS[i].key, key) == 0)
+                return i;
+        for (Uint32 i = 0; i < AA_COUNT; i++)
+            if (AA_OPTIONS[i].samples == samples && AA_OPTIONS[i].post == aa_post::none)
+                return i;
+        return 0;
+    }
+
+    // What the scene pass draws, resolved against the geometry pool on the
+    // render thread.
+    struct scene_desc
+    {
+        SDL_GPUGraphicsPipeline* pipeline = nullptr;
+        GpuAlloc vertices{};
+        Uint32 vertex_stride = 0;
+        GpuAlloc instances{};
+        Uint32 instance_count = 0;
+        const Mesh* mesh = nullptr;
+        // CPU copy of the instance records; never written once published.
+        const float* objects = nullptr;
+        cull_mode cull = cull_mode::none;
+        CullView view;
+        SDL_GPUComputePipeline* cull_pipeline = nullptr;
+        Uint32 cull_threads = 64;
+        UniformValues uniforms;
+        // Variant of `pipeline` reading the object buffer; null when its
+        // vertex stage does not take exactly one storage buffer.
+        object_source source = object_source::stream;
+        SDL_GPUGraphicsPipeline* object_pipeline = nullptr;
+    };
+
+    // Everything the render thread needs for one frame, captured on the main
+    // thread. Targets are copied too: the main thread may replace them (and
+    // retire the old ones) while this frame is still queued.
+    struct frame_snapshot
+    {
+        SceneMode mode = SceneMode::Docked;
+        UiSnapshot ui;
+        scene_desc scene;
+        SDL_GPUTexture* scene_tex = nullptr;
+        SDL_GPUTexture* scene_msaa = nullptr;
+        SDL_GPUTexture* msaa_color = nullptr;
+        SDL_GPUSampleCount msaa = SDL_GPU_SAMPLECOUNT_1;
+        Uint32 scene_w = 0, scene_h = 0;
+        Uint32 aa = 0;
+        bool post = false;
+        bool parallel_recording = false;
+        // Dispatched before the scene pass, in order.
+        std::vector<ComputeDispatch> compute;
+        // Copied out of the frame after it is drawn.
+        std::vector<ReadbackRequest> readbacks;
+    };
+
+    // Published by the render thread after each frame for the stats window.
+    struct render_stats
+    {
+        DrawListStats draw_list;
+        ComputeListStats compute;
+        std::vector<RecordThreadStats> record;
+        Uint64 frame_ns = 0;
+        // Visibility and draw submission for the scene, CPU side.
+        Uint64 scene_ns = 0;
+        cull_mode cull = cull_mode::none;
+        object_source source = object_source::stream;
+        ReadbackStats readback;
+        PostChainStats post;
+        // The render thread's scratch arena as of its previous frame.
+        ArenaStats arena;
+        Uint32 visible = 0;
+        Uint32 objects = 0;
+        // Running totals for averaging over a span of frames.
+        Uint64 frames = 0;
+        Uint64 frame_ns_total = 0;
+        Uint64 scene_ns_total = 0;
+        // Start-to-start frame intervals while rendering continuously, per
+        // anti-aliasing mode. With frames in flight bounded this is the
+        // frame's full cost, GPU included.
+        Uint64 aa_frames[AA_COUNT] = {};
+        Uint64 aa_interval_ns[AA_COUNT] = {};
+    };
+
     struct renderer
     {
         SDL_Window* window_ptr = nullptr;
@@ -212,14 +255,156 @@ namespace brender
         SDL_GPUTexture* scene_tex = nullptr;
         SDL_GPUSampler* scene_sampler = nullptr;
         SDL_GPUTextureSamplerBinding scene_binding{};
+        // Samplers shared by every subsystem.
+        StateCache state_cache;
         int scene_w = 0, scene_h = 0;
+        UploadRing uploads;
+        GpuBufferPool geometry;
+        ImGuiSDL3GPU* imgui = nullptr;
+        DrawList draw_list;
+        ComputeList compute_list;
+        // Main thread: dispatches and readbacks for the next captured frame.
+        std::vector<ComputeDispatch> compute_pending;
+        std::vector<ReadbackRequest> readback_pending;
+        // Render thread: downloads in flight; the dumper's writer thread
+        // takes the frames from there.
+        ReadbackRing readback;
+        FrameDumper frame_dump;
+        // Fullscreen passes between the scene and the UI, docked mode only.
+        // Built on the main thread before the render thread starts; the
+        // render thread owns the targets and picks what the Scene window
+        // shows each frame.
+        PostChain post;
+        bool post_enabled = false;
+        SDL_GPUTexture* scene_output = nullptr;
+        // Main thread: the selected AA_OPTIONS entry, the one the scene
+        // programs were last built for, and the sample count they asked for
+        // (0 for the pipeline JSON's own).
+        Uint32 aa = 0;
+        Uint32 aa_applied = 0;
+        Uint32 msaa_request = 0;
+        Uint32 jitter_index = 0;
+        // Post AA chains; the render thread restarts TAA history when the
+        // mode changes.
+        PostChain fxaa;
+        PostChain taa;
+        Uint32 aa_recorded = 0;
+        // Render thread: when the last frame started, and in which mode.
+        Uint64 last_frame_ns = 0;
+        Uint32 last_frame_aa = 0;
+        // Pixel under the mouse, read back a few frames late: 0xAABBGGRR as
+        // downloaded, and the frames it took.
+        bool probe = false;
+        std::atomic<Uint32> probe_pixel{ 0 };
+        std::atomic<Uint32> probe_latency{ 0 };
+        ParallelRecorder recorder;
+        bool parallel_recording = false;
+        bool animating = false;
+        RenderQueue render_queue;
+        std::vector<brender::frame_snapshot> snapshots;
+        std::thread render_thread;
+        std::mutex stats_mutex;
+        brender::render_stats stats;
+        // Main thread: the stats window's copy, kept so copying reuses its
+        // storage.
+        brender::render_stats ui_stats;
+        // Main thread: heap_count() at the start of the current iteration,
+        // and how far it moved over the last one that rendered.
+        Uint64 heap_mark = 0;
+        Uint64 heap_last_frame = 0;
+        // Read only by whichever thread renders; tick and blend last uploaded.
+        Simulation sim;
+        std::vector<float> sim_pose;
+        Uint64 sim_tick = 0;
+        float sim_alpha = 1.0f;
+        cull_mode cull = cull_mode::none;
+        object_source source = object_source::stream;
+        // Main thread: scene view, fed to the View uniform block.
+        float view_pan[2] = { 0.0f, 0.0f };
+        float view_zoom = 1.0f;
+        // Render thread: culling state and what was last uploaded for it.
+        GpuCull gpu_cull;
+        std::vector<float> cull_scratch;
+        ObjectBuffer object_buffer;
+        std::vector<ObjectRecord> object_records;
+        // Updated by the render thread each frame; the main thread requests
+        // textures and reports their on-screen sizes.
+        TextureStreamer texture_streamer;
+        std::vector<Uint32> streamed_textures;
+        float texture_thumb_px = 128.0f;
+        const float* uploaded_objects = nullptr;
+        Uint32 uploaded_count = 0;
+        cull_mode uploaded_cull = cull_mode::none;
+        object_source uploaded_source = object_source::stream;
+    };
+
+    // For objects the main thread replaces while queued snapshots may still
+    // name them; released once the render thread is past those snapshots.
+    static void retire(brender::renderer& r, RetireKind kind, void* object)
+    {
+        render_queue_retire(r.render_queue, r.device_ptr, kind, object);
+    }
+
+    // Main thread: queues a dispatch ahead of the next frame's scene pass.
+    // Dispatches are per frame; work needed every frame is scheduled every
+    // frame, and a frame replaced before it renders drops its dispatches.
+    static void schedule_compute(brender::renderer& r, const ComputeDispatch& dispatch)
+    {
+        r.compute_pending.push_back(dispatch);
+    }
+
+    // Main thread: copies a region of a frame back to the CPU. The callback
+    // runs on the render thread a few frames later; like dispatches, a frame
+    // replaced before it renders drops its readbacks.
+    static void schedule_readback(brender::renderer& r, const ReadbackRequest& request)
+    {
+        r.readback_pending.push_back(request);
+    }
+
+    static void probe_readback(void* user, const ReadbackResult& result)
+    {
+        brender::renderer& r = *(brender::renderer*)user;
+        Uint32 pixel = 0;
+        SDL_memcpy(&pixel, result.pixels, SDL_min(result.pitch, (Uint32)sizeof(pixel)));
+        r.probe_pixel.store(pixel, std::memory_order_relaxed);
+        r.probe_latency.store(result.latency, std::memory_order_relaxed);
+    }
+
+    // Main thread: the readbacks taken every frame, the frame dump and the
+    // pixel probe, both of the final image.
+    static void schedule_frame_readbacks(brender::renderer& r)
+    {
+        if (frame_dump_active(r.frame_dump))
+        {
+            ReadbackRequest rq;
+            rq.callback = frame_dump_readback;
+            rq.user = &r.frame_dump;
+            schedule_readback(r, rq);
+        }
+        float mx = 0.0f, my = 0.0f;
+        SDL_GetMouseState(&mx, &my);
+        if (r.probe && SDL_GetMouseFocus() == r.window_ptr)
+        {
+            float density = SDL_GetWindowPixelDensity(r.window_ptr);
+            ReadbackRequest rq;
+            rq.rect = SDL_Rect{ (int)(mx * density), (int)(my * density), 1, 1 };
+            rq.callback = probe_readback;
+            rq.user = &r;
+            schedule_readback(r, rq);
+        }
+    }
+
+    // Pass field of the draw key; items are emitted one pass at a time.
+    enum draw_pass : Uint32
+    {
+        PASS_SCENE = 0,
     };
 
     static void create_target(brender::renderer& render)
     {
         if (render.msaa_color)
         {
-            SDL_ReleaseGPUTexture(render.device_ptr, render.msaa_color);
+            retire(render, RetireKind::texture, render.msaa_color);
             render.msaa_color = nullptr;
         }
         if (render.msaa <= SDL_GPU_SAMPLECOUNT_1)
@@ -242,22 +427,65 @@ namespace brender
             SDIE("SDL_CreateGPUTexture(msaa_color)");
     }
 
-    static void imgui_backend_shutdown()
+    // ImGui id of the Scene window's image. Streamed texture ids carry a
+    // handle of 1 or more, which leaves handle 0 free.
+    static const Uint64 SCENE_IMAGE_ID = 1;
+
+    static SDL_GPUTexture* resolve_ui_texture(void* user, Uint64 id)
+    {
+        brender::renderer& r = *(brender::renderer*)user;
+        if (id == SCENE_IMAGE_ID)
+            return r.scene_output;
+        return texture_stream_resolve(r.texture_streamer, id);
+    }
+
+    static void imgui_backend_shutdown(brender::renderer& renderer)
     {
-        ImGui_ImplSDLGPU3_Shutdown();
+        ImGuiSDL3GPU_Destroy(renderer.imgui);
+        renderer.imgui = nullptr;
         ImGui_ImplSDL3_Shutdown();
     }
 
-    static void imgui_backend_init(const brender::renderer& renderer)
+    static std::vector<uint32_t> compile_backend_shader(shaderc::Compiler& compiler, const char* file_name, shaderc_shader_kind kind)
+    {
+        std::string path = std::string(SHADER_SRC_DIR) + "/" + file_name;
+        std::ifstream fs(path, std::ios::binary);
+        std::string source((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+        if (source.empty())
+        {
+            app_log(logui::level::error, arena_printf(arena_scratch(), "FATAL: cannot read %s", path.c_str()));
+            std::exit(EXIT_FAILURE);
+        }
+        shaderc::CompileOptions opts;
+        opts.SetOptimizationLevel(shaderc_optimization_level_performance);
+        auto result = compiler.CompileGlslToSpv(source, kind, file_name, opts);
+        if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+        {
+            app_log(logui::level::error, arena_printf(arena_scratch(), "FATAL: %s", result.GetErrorMessage().c_str()));
+            std::exit(EXIT_FAILURE);
+        }
+        return std::vector<uint32_t>(result.cbegin(), result.cend());
+    }
+
+    static void imgui_backend_init(brender::renderer& renderer)
     {
         ImGui_ImplSDL3_InitForSDLGPU(renderer.window_ptr);
-        ImGui_ImplSDLGPU3_InitInfo init_info;
-        SDL_zero(init_info);
-        init_info.Device = renderer.device_ptr;
-        init_info.ColorTargetFormat = renderer.swap_format;
-        init_info.MSAASamples = SDL_GPU_SAMPLECOUNT_1;
-        if (ImGui_ImplSDLGPU3_Init(&init_info) == false)
-            SDIE("ImGui_ImplSDLGPU3_Init()");
+        shaderc::Compiler compiler;
+        std::vector<uint32_t> vs = compile_backend_shader(compiler, "imgui.vert", shaderc_vertex_shader);
+        std::vector<uint32_t> fs = compile_backend_shader(compiler, "imgui.frag", shaderc_fragment_shader);
+        renderer.imgui = ImGuiSDL3GPU_Create(renderer.device_ptr, &renderer.uploads,
+            vs.data(), vs.size() * sizeof(uint32_t), fs.data(), fs.size() * sizeof(uint32_t));
+        if (renderer.imgui == nullptr)
+            SDIE("ImGuiSDL3GPU_Create()");
+        SDL_GPUSamplerCreateInfo sci{};
+        sci.min_filter = SDL_GPU_FILTER_LINEAR;
+        sci.mag_filter = SDL_GPU_FILTER_LINEAR;
+        sci.mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_NEAREST;
+        sci.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE;
+        sci.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE;
+        sci.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE;
+        if (SDL_GPUSampler* sampler = state_cache_get_sampler(renderer.state_cache, state_cache_sampler(renderer.state_cache, sci)))
+            ImGuiSDL3GPU_SetSampler(renderer.imgui, sampler);
     }
 
     void imgui_xinit(brender::renderer& renderer)
@@ -272,12 +500,43 @@ namespace brender
         renderer.imgui_msaa = SDL_GPU_SAMPLECOUNT_1;
     }
 
-    using draw_func_ptr = void(*)(const void*);
+    // Per-instance vertex data for pipelines with an instance-rate stream.
+    // Lives in the shared geometry pool and is bound at its range offset.
+    struct instance_buffer
+    {
+        GpuAlloc alloc{};
+        Uint32 stride = 0;
+        Uint32 capacity = 0;
+        Uint32 count = 0;
+    };
+
+    bool instance_buffer_create(brender::renderer& renderer, brender::instance_buffer& out, Uint32 stride, Uint32 capacity)
+    {
+        out.alloc = gpu_pool_alloc(renderer.geometry, stride * capacity, stride);
+        out.stride = stride;
+        out.capacity = capacity;
+        out.count = 0;
+        return out.alloc.generation != 0;
+    }
+
+    bool instance_buffer_update(brender::renderer& renderer, brender::instance_buffer& buffer, const void* data, Uint32 count)
+    {
+        if (count > buffer.capacity)
+            return false;
+        buffer.count = count;
+        return count == 0 || gpu_pool_upload(renderer.geometry, renderer.uploads, buffer.alloc, data, count * buffer.stride);
+    }
+
+    void instance_buffer_destroy(brender::renderer& renderer, brender::instance_buffer& buffer)
+    {
+        gpu_pool_free(renderer.geometry, buffer.alloc);
+        buffer = brender::instance_buffer{};
+    }
 
     static void create_scene_targets(brender::renderer& r, int w, int h)
     {
-        if (r.scene_tex)  SDL_ReleaseGPUTexture(r.device_ptr, r.scene_tex);
-        if (r.scene_msaa) SDL_ReleaseGPUTexture(r.device_ptr, r.scene_msaa);
+        retire(r, RetireKind::texture, r.scene_tex);
+        retire(r, RetireKind::texture, r.scene_msaa);
         r.scene_tex = nullptr;
         r.scene_msaa = nullptr;
 
@@ -309,7 +568,7 @@ namespace brender
         if (!r.scene_sampler)
         {
             SDL_GPUSamplerCreateInfo sci{};
-            r.scene_sampler = SDL_CreateGPUSampler(r.device_ptr, &sci);
+            r.scene_sampler = state_cache_get_sampler(r.state_cache, state_cache_sampler(r.state_cache, sci));
         }
         r.scene_binding.texture = r.scene_tex;
         r.scene_binding.sampler = r.scene_sampler;
@@ -327,91 +586,447 @@ namespace brender
         if (h < 1) h = 1;
         if (w != r.scene_w || h != r.scene_h) create_scene_targets(r, w, h);
         if (!r.scene_tex) create_scene_targets(r, w, h);
-        ImGuiPlatformIO& pio = ImGui::GetPlatformIO();
-        if (pio.Renderer_RenderState && r.scene_sampler)
+        ImGui::Image((ImTextureID)SCENE_IMAGE_ID, avail);
+        ImGui::End();
+        ImGui::PopStyleVar();
+    }
+
+    static void imgui_stats_window(brender::renderer& r)
+    {
+        brender::render_stats& stats = r.ui_stats;
+        {
+            std::lock_guard<std::mutex> lock(r.stats_mutex);
+            stats = r.stats;
+        }
+        const DrawListStats& dl = stats.draw_list;
+        ImGui::Begin("Renderer");
+        ImGui::Text("render thread: %s", r.render_thread.joinable() ? "on" : "off");
+        {
+            RenderQueueStats q = render_queue_stats(r.render_queue);
+            ImGui::SetItemTooltip("frame %.3f ms, %llu rendered, %llu replaced before rendering",
+                                  (double)stats.frame_ns / 1e6, (unsigned long long)q.rendered, (unsigned long long)q.replaced);
+        }
+        ImGui::Text("draw items %u  sort passes %u", dl.items, dl.sort_passes);
+        ImGui::Text("binds: pipeline %u  vertex %u  index %u  sampler %u  storage %u", dl.pipeline_binds, dl.vertex_binds, dl.index_binds,
+                    dl.sampler_binds, dl.storage_binds);
+        ImGui::Text("redundant binds skipped %u", dl.redundant_skipped);
+        ImGui::Text("compute: %u dispatches in %u passes", stats.compute.dispatches, stats.compute.passes);
+        ImGui::Text("uniform pushes %u (%u bytes)", dl.uniform_pushes, dl.uniform_bytes);
+        {
+            StateCacheStats sc = state_cache_stats(r.state_cache);
+            ImGui::Text("sampler cache: %u samplers, %llu hits", sc.samplers, (unsigned long long)sc.hits);
+        }
+        {
+            // Inline rendering shares the main thread's arena.
+            bool threaded = r.render_thread.joinable();
+            ArenaStats main_arena = arena_stats(arena_scratch());
+            // The count changes every frame; keep it out of the hashed UI.
+            ImGui::TextUnformatted("heap allocations per frame");
+            if (ImGui::BeginItemTooltip())
+            {
+                ImGui::Text("%llu in the last rendered frame, all threads (operator new and SDL)",
+                            (unsigned long long)r.heap_last_frame);
+                ImGui::Text("frame arena block mallocs: %u", main_arena.mallocs + (threaded ? stats.arena.mallocs : 0));
+                ImGui::Text("main: %llu bytes, %llu peak, %llu in %u blocks, %llu mallocs total", (unsigned long long)main_arena.used,
+                            (unsigned long long)main_arena.high_water, (unsigned long long)main_arena.capacity, main_arena.blocks,
+                            (unsigned long long)main_arena.total_mallocs);
+                if (threaded)
+                    ImGui::Text("render: %llu bytes, %llu peak, %llu in %u blocks, %llu mallocs total", (unsigned long long)stats.arena.used,
+                                (unsigned long long)stats.arena.high_water, (unsigned long long)stats.arena.capacity, stats.arena.blocks,
+                                (unsigned long long)stats.arena.total_mallocs);
+                ImGui::EndTooltip();
+            }
+        }
+        {
+            const ReadbackStats& rb = stats.readback;
+            ImGui::Text("readback: %u requests, %u delivered, %u dropped, %u slots in flight", rb.requests, rb.delivered, rb.dropped,
+                        rb.slots_in_flight);
+            ImGui::Checkbox("Probe pixel under cursor", &r.probe);
+            if (r.probe)
+            {
+                Uint32 pixel = r.probe_pixel.load(std::memory_order_relaxed);
+                Uint8 c[4];
+                SDL_memcpy(c, &pixel, sizeof(c));
+                bool bgra = r.swap_format == SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM || r.swap_format == SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM_SRGB;
+                ImGui::SameLine();
+                ImGui::Text("#%02X%02X%02X, %u frames late", c[bgra ? 2 : 0], c[1], c[bgra ? 0 : 2], r.probe_latency.load(std::memory_order_relaxed));
+            }
+            if (frame_dump_active(r.frame_dump))
+            {
+                FrameDumpStats d = frame_dump_stats(r.frame_dump);
+                ImGui::Text("dump %s: %llu written, %llu dropped, %u queued", r.frame_dump.path.c_str(), (unsigned long long)d.written,
+                            (unsigned long long)d.dropped, d.queued);
+            }
+        }
+        {
+            int aa = (int)r.aa;
+            const char* names[AA_COUNT];
+            for (Uint32 i = 0; i < AA_COUNT; i++)
+                names[i] = AA_OPTIONS[i].name;
+            if (ImGui::Combo("Anti-aliasing", &aa, names, (int)AA_COUNT))
+                r.aa = (Uint32)aa;
+            // Timings change every frame; keep them out of the hashed UI.
+            if (ImGui::BeginItemTooltip())
+            {
+                ImGui::Text("frame interval while rendering continuously:");
+                for (Uint32 i = 0; i < AA_COUNT; i++)
+                {
+                    if (stats.aa_frames[i])
+                        ImGui::Text("%-8s %.3f ms (%llu frames)", AA_OPTIONS[i].name, (double)stats.aa_interval_ns[i] / 1e6 / (double)stats.aa_frames[i],
+                                    (unsigned long long)stats.aa_frames[i]);
+                    else
+                        ImGui::Text("%-8s not measured", AA_OPTIONS[i].name);
+                }
+                ImGui::EndTooltip();
+            }
+            Uint32 samples = 1u << (Uint32)r.msaa;
+            if (AA_OPTIONS[r.aa].samples > 1 && samples != AA_OPTIONS[r.aa].samples)
+                ImGui::TextDisabled("%ux MSAA unsupported, using %ux", AA_OPTIONS[r.aa].samples, samples);
+            if (AA_OPTIONS[r.aa].post == aa_post::fxaa && r.fxaa.steps.empty())
+                ImGui::TextDisabled("FXAA chain failed to build");
+            if (AA_OPTIONS[r.aa].post == aa_post::taa && r.taa.steps.empty())
+                ImGui::TextDisabled("TAA chain failed to build");
+        }
+        if (!r.post.steps.empty())
+        {
+            const PostChainStats& pc = stats.post;
+            ImGui::Checkbox("Post-processing", &r.post_enabled);
+            ImGui::SameLine();
+            ImGui::Text("%u passes in %u draws, %u targets", pc.passes, pc.steps, pc.targets);
+            ImGui::SetItemTooltip("%.2f MB of intermediate targets", (double)pc.target_bytes / (1 << 20));
+        }
+        ImGui::Separator();
+        {
+            const char* modes[] = { "none", "cpu", "gpu" };
+            int mode = (int)r.cull;
+            if (ImGui::Combo("Culling", &mode, modes, 3))
+                r.cull = (cull_mode)mode;
+            const char* sources[] = { "instance stream", "storage buffer" };
+            int source = (int)r.source;
+            if (ImGui::Combo("Object data", &source, sources, 2))
+                r.source = (object_source)source;
+            if (r.source != stats.source && stats.frames)
+                ImGui::TextDisabled("storage buffer unavailable, using the instance stream");
+            ImGui::SliderFloat("Zoom", &r.view_zoom, 0.25f, 8.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+            ImGui::DragFloat2("Pan", r.view_pan, 0.01f, -4.0f, 4.0f);
+            if (stats.cull == cull_mode::gpu)
+                ImGui::Text("%u objects, %u indirect draws", stats.objects, dl.indirect_draws);
+            else
+                ImGui::Text("%u of %u objects drawn", stats.visible, stats.objects);
+            ImGui::SetItemTooltip("scene visibility and submission %.3f ms", (double)stats.scene_ns / 1e6);
+        }
+        ImGui::Separator();
+        ImGui::Checkbox("Parallel recording", &r.parallel_recording);
+        if (r.parallel_recording)
         {
-            auto* rs = (ImGui_ImplSDLGPU3_RenderState*)pio.Renderer_RenderState;
-            rs->SamplerCurrent = r.scene_sampler;
+            Uint64 total_ns = 0;
+            const auto& threads = stats.record;
+            for (size_t i = 0; i < threads.size(); i++)
+            {
+                const char* name = i + 1 == threads.size() ? "render" : i + 2 == threads.size() ? "main" : "worker";
+                ImGui::Text("%s %zu: %u chunks, %u items", name, i, threads[i].chunks, threads[i].items);
+                total_ns += threads[i].record_ns;
+            }
+            // Timings change every frame; keep them out of the hashed UI.
+            ImGui::SetItemTooltip("recording %.3f ms across threads", (double)total_ns / 1e6);
         }
-        ImGui::Image((ImTextureID)r.scene_tex, avail);
         ImGui::End();
-        ImGui::PopStyleVar();
     }
 
-    void draw(brender::renderer& renderer, brender::draw_func_ptr draw_func, logui::ring& console, const void* draw_data)
+    static void imgui_sim_window(brender::renderer& r)
+    {
+        SimStats st = sim_stats(r.sim);
+        ImGui::Begin("Simulation");
+        bool running = r.sim.running.load();
+        if (ImGui::Checkbox("Run", &running))
+            sim_set_running(r.sim, running);
+        ImGui::Text("tick rate %.1f Hz (target %.1f)", st.tick_hz, r.sim.dt_ns ? 1e9 / (double)r.sim.dt_ns : 0.0);
+        ImGui::Text("backlog %u  max %u", st.backlog, st.max_backlog);
+        ImGui::Text("ticks %llu  dropped %llu", (unsigned long long)st.ticks, (unsigned long long)st.dropped);
+        ImGui::Text("step %.3f ms", st.step_ms);
+        ImGui::End();
+    }
+
+    // Streamed textures as thumbnails. Each reports its on-screen size, which
+    // decides the levels it gets; a closed window leaves them all at zero.
+    static void imgui_textures_window(brender::renderer& r)
+    {
+        TextureStreamer& ts = r.texture_streamer;
+        if (!ImGui::Begin("Textures"))
+        {
+            for (Uint32 handle : r.streamed_textures)
+                texture_stream_set_screen_size(ts, handle, 0);
+            ImGui::End();
+            return;
+        }
+        TextureStreamStats st = texture_stream_stats(ts);
+        int budget_mb = (int)(ts.budget_bytes.load() >> 20);
+        if (ImGui::SliderInt("GPU budget (MB)", &budget_mb, 8, 2048))
+            ts.budget_bytes.store((Uint64)budget_mb << 20);
+        int upload_mb = (int)(ts.upload_bytes_per_frame.load() >> 20);
+        if (ImGui::SliderInt("Uploads per frame (MB)", &upload_mb, 1, 64))
+            ts.upload_bytes_per_frame.store((Uint32)upload_mb << 20);
+        ImGui::SliderFloat("Thumbnail size", &r.texture_thumb_px, 16.0f, 1024.0f, "%.0f px", ImGuiSliderFlags_Logarithmic);
+        ImGui::Text("%u textures: %u queued, %u decoding, %u failed, %u resident", st.textures, st.queued, st.decoding, st.failed, st.resident);
+        ImGui::Text("resident %.1f MB, wanted %.1f MB", (double)st.resident_bytes / (1 << 20), (double)st.wanted_bytes / (1 << 20));
+        ImGui::Text("last frame: %.2f MB uploaded, %u promotions, %u evictions (%llu total)", (double)st.uploaded_bytes / (1 << 20),
+                    st.promotions, st.evictions, (unsigned long long)st.total_evictions);
+        ImGui::Separator();
+
+        float scale = ImGui::GetIO().DisplayFramebufferScale.x;
+        float avail = ImGui::GetContentRegionAvail().x;
+        float x = 0.0f;
+        for (Uint32 handle : r.streamed_textures)
+        {
+            const StreamTexture* t = texture_stream_get(ts, handle);
+            bool ready = t && t->state.load(std::memory_order_acquire) == StreamState::ready;
+            float aspect = ready ? (float)t->width / (float)t->height : 1.0f;
+            ImVec2 size(r.texture_thumb_px * SDL_min(aspect, 1.0f), r.texture_thumb_px / SDL_max(aspect, 1.0f));
+            if (x > 0.0f && x + size.x <= avail)
+                ImGui::SameLine();
+            else
+                x = 0.0f;
+            x += size.x + ImGui::GetStyle().ItemSpacing.x;
+            ImGui::Image((ImTextureID)texture_stream_imgui_id(handle), size);
+            Uint32 px = ImGui::IsItemVisible() ? (Uint32)(SDL_max(size.x, size.y) * scale) : 0;
+            texture_stream_set_screen_size(ts, handle, px);
+            bool failed = t && t->state.load(std::memory_order_acquire) == StreamState::failed;
+            if (failed && ImGui::BeginItemTooltip())
+            {
+                ImGui::Text("%s", t->path.c_str());
+                ImGui::Text("failed: %s", t->error.c_str());
+                ImGui::EndTooltip();
+            }
+            if (ready && ImGui::BeginItemTooltip())
+            {
+                Uint32 base = SDL_min(t->resident_base.load(), t->levels);
+                ImGui::Text("%s", t->path.c_str());
+                ImGui::Text("%ux%u, %u levels, resident from level %u", t->width, t->height, t->levels, base);
+                if (t->transcoded)
+                    ImGui::Text("%s, decoded to RGBA8 on the CPU", t->format_name);
+                else if (t->mapping.data)
+                    ImGui::Text("%s, uploaded from the mapped file", t->format_name);
+                ImGui::EndTooltip();
+            }
+        }
+        ImGui::End();
+    }
+
+    static Uint32 hash_draw_data(const ImDrawData* dd)
+    {
+        if (!dd)
+            return 0;
+        Uint32 h = SDL_murmur3_32(&dd->DisplaySize, sizeof(dd->DisplaySize), 0);
+        for (int n = 0; n < dd->CmdListsCount; n++)
+        {
+            const ImDrawList* cl = dd->CmdLists[n];
+            h = SDL_murmur3_32(cl->VtxBuffer.Data, (size_t)cl->VtxBuffer.Size * sizeof(ImDrawVert), h);
+            h = SDL_murmur3_32(cl->IdxBuffer.Data, (size_t)cl->IdxBuffer.Size * sizeof(ImDrawIdx), h);
+            for (const ImDrawCmd& cmd : cl->CmdBuffer)
+            {
+                ImTextureID tex = cmd.GetTexID();
+                h = SDL_murmur3_32(&cmd.ClipRect, sizeof(cmd.ClipRect), h);
+                h = SDL_murmur3_32(&tex, sizeof(tex), h);
+                h = SDL_murmur3_32(&cmd.ElemCount, sizeof(cmd.ElemCount), h);
+            }
+        }
+        return h;
+    }
+
+    // Builds the ImGui frame and returns a hash of its draw data, so the caller
+    // can tell whether anything visible changed since the last build.
+    Uint32 build_ui(brender::renderer& renderer, logui::Console& console)
+    {
+        logui::pump(console);
+        if (g_mode != SceneMode::Docked)
+            return 0;
+        ImGui_ImplSDL3_NewFrame();
+        ImGuiSDL3GPU_NewFrame(renderer.imgui, renderer.window_ptr, 0.0f);
+        ImGui::DockSpaceOverViewport(0, ImGui::GetMainViewport(), ImGuiDockNodeFlags_PassthruCentralNode);
+        imgui_scene_window(renderer);
+        imgui_stats_window(renderer);
+        imgui_sim_window(renderer);
+        imgui_textures_window(renderer);
+        jobs::draw_stats();
+        logui::draw(console);
+        ImGui::Render();
+        return hash_draw_data(ImGui::GetDrawData());
+    }
+
+    static void draw_ui_pass(brender::renderer& renderer, const brender::frame_snapshot& snap, SDL_GPUTexture* swap_texture)
+    {
+        brender::frame& frame = renderer.frame;
+        SDL_GPUColorTargetInfo ui{};
+        ui.texture = swap_texture;
+        ui.load_op = SDL_GPU_LOADOP_CLEAR;
+        ui.store_op = SDL_GPU_STOREOP_STORE;
+        ui.clear_color = SDL_FColor{0.1f, 0.1f, 0.1f, 1.0f};
+        frame.render_pass_ptr = SDL_BeginGPURenderPass(frame.command_buffer_ptr, &ui, 1, NULL);
+        ImGuiSDL3GPU_RenderDrawData(renderer.imgui, &snap.ui.data, frame.command_buffer_ptr, frame.render_pass_ptr, renderer.swap_format);
+        SDL_EndGPURenderPass(frame.render_pass_ptr);
+    }
+
+    // Runs post AA and then the post chain, when enabled, over the finished
+    // scene and points the Scene window at the result.
+    static void post_process(brender::renderer& renderer, const brender::frame_snapshot& snap)
     {
-        if (g_mode == SceneMode::Docked)
+        SDL_GPUCommandBuffer* cb = renderer.frame.command_buffer_ptr;
+        SDL_GPUTexture* out = snap.scene_tex;
+        if (snap.aa != renderer.aa_recorded)
+            renderer.taa.history_valid = false;
+        renderer.aa_recorded = snap.aa;
+        if (AA_OPTIONS[snap.aa].post == aa_post::fxaa)
+            out = post_chain_record(renderer.fxaa, cb, out, snap.scene_w, snap.scene_h);
+        else if (AA_OPTIONS[snap.aa].post == aa_post::taa)
+            out = post_chain_record(renderer.taa, cb, out, snap.scene_w, snap.scene_h);
+        if (snap.post)
+            out = post_chain_record(renderer.post, cb, out, snap.scene_w, snap.scene_h);
+        renderer.scene_output = out;
+    }
+
+    static float halton(Uint32 index, Uint32 base)
+    {
+        float f = 1.0f, r = 0.0f;
+        for (; index; index /= base)
         {
-            ImGui_ImplSDL3_NewFrame();
-            ImGui_ImplSDLGPU3_NewFrame();
-            ImGui::NewFrame();
-            ImGui::DockSpaceOverViewport(0, ImGui::GetMainViewport(), ImGuiDockNodeFlags_PassthruCentralNode);
-            imgui_scene_window(renderer);
-            logui::draw(&console);
-            ImGui::Render();
+            f /= (float)base;
+            r += f * (float)(index % base);
         }
+        return r;
+    }
+
+    // Main thread: sub-pixel offset of the next frame in NDC, cycling through
+    // 8 points of the (2, 3) Halton sequence; zero unless a TAA chain built
+    // and is selected.
+    static void aa_jitter(brender::renderer& r, float out[2])
+    {
+        out[0] = out[1] = 0.0f;
+        if (AA_OPTIONS[r.aa].post != aa_post::taa || r.taa.steps.empty() || g_mode != SceneMode::Docked || r.scene_w <= 0 || r.scene_h <= 0)
+            return;
+        Uint32 i = r.jitter_index++ % 8 + 1;
+        out[0] = (halton(i, 2) - 0.5f) * 2.0f / (float)r.scene_w;
+        out[1] = (halton(i, 3) - 0.5f) * 2.0f / (float)r.scene_h;
+    }
+
+    // Parallel path, docked mode only: uploads go out in their own command
+    // buffer, the scene chunks follow in order from the recorder threads, and
+    // a last command buffer owns the swapchain and the UI. The swapchain
+    // texture belongs to the command buffer that acquired it, which is why
+    // fullscreen mode (scene drawn straight into it) stays single-threaded.
+    static void draw_parallel(brender::renderer& renderer, const brender::frame_snapshot& snap)
+    {
+        brender::frame& frame = renderer.frame;
+        upload_ring_submit(renderer.uploads, frame.command_buffer_ptr);
+
+        RecordTarget target;
+        target.clear_color = SDL_FColor{0.2f, 0.3f, 0.3f, 1.0f};
+        target.texture = snap.msaa > SDL_GPU_SAMPLECOUNT_1 ? snap.scene_msaa : snap.scene_tex;
+        target.resolve = snap.msaa > SDL_GPU_SAMPLECOUNT_1 ? snap.scene_tex : nullptr;
+        if (!parallel_record(renderer.recorder, renderer.draw_list, PASS_SCENE, target))
+            app_log(logui::level::warn, "parallel recording: SDL_AcquireGPUCommandBuffer() failed for a chunk");
+
+        frame.command_buffer_ptr = SDL_AcquireGPUCommandBuffer(renderer.device_ptr);
+        post_process(renderer, snap);
+        SDL_GPUTexture* swap_texture = NULL;
+        Uint32 swap_w = 0, swap_h = 0;
+        if (SDL_AcquireGPUSwapchainTexture(frame.command_buffer_ptr, renderer.window_ptr, &swap_texture, &swap_w, &swap_h) && swap_texture)
+            draw_ui_pass(renderer, snap, swap_texture);
+        readback_ring_record(renderer.readback, renderer.uploads, frame.command_buffer_ptr, snap.readbacks, swap_texture, renderer.swap_format, swap_w, swap_h);
+        upload_ring_submit(renderer.uploads, frame.command_buffer_ptr);
+    }
+
+    // Compacts fragmented geometry pages in a submission of its own. Runs
+    // before the frame resolves any pool range, so the buffers and offsets
+    // baked into its draw items are the ones the moved data lives at.
+    void defragment_geometry(brender::renderer& renderer)
+    {
+        if (!gpu_pool_fragmented(renderer.geometry))
+            return;
+        SDL_GPUCommandBuffer* cb = SDL_AcquireGPUCommandBuffer(renderer.device_ptr);
+        if (!cb)
+            return;
+        upload_ring_flush(renderer.uploads, cb);
+        gpu_pool_defragment(renderer.geometry, cb);
+        upload_ring_submit(renderer.uploads, cb);
+    }
+
+    // Records the compute dispatches pushed since the last call, then renders
+    // the items submitted to renderer.draw_list into the snapshot's targets
+    // and resets both lists for the next frame.
+    void draw(brender::renderer& renderer, const brender::frame_snapshot& snap)
+    {
+        if (snap.mode == SceneMode::Docked && snap.ui.valid)
+            ImGuiSDL3GPU_PrepareDrawData(renderer.imgui, &snap.ui.data, &renderer.uploads);
 
+        readback_ring_poll(renderer.readback, renderer.uploads);
         brender::frame& frame = renderer.frame;
         frame.command_buffer_ptr = SDL_AcquireGPUCommandBuffer(renderer.device_ptr);
+        upload_ring_flush(renderer.uploads, frame.command_buffer_ptr);
+        compute_list_record(renderer.compute_list, frame.command_buffer_ptr);
+        compute_list_reset(renderer.compute_list);
+        draw_list_sort(renderer.draw_list);
+
+        if (snap.parallel_recording && snap.mode == SceneMode::Docked && snap.scene_tex)
+        {
+            draw_parallel(renderer, snap);
+            draw_list_reset(renderer.draw_list);
+            SDL_Delay(1);
+            return;
+        }
 
         SDL_GPUTexture* swap_texture = NULL;
         Uint32 swap_w = 0, swap_h = 0;
         bool ok = SDL_AcquireGPUSwapchainTexture(frame.command_buffer_ptr, renderer.window_ptr, &swap_texture, &swap_w, &swap_h);
         if (!ok || !swap_texture)
         {
-            SDL_SubmitGPUCommandBuffer(frame.command_buffer_ptr);
+            readback_ring_record(renderer.readback, renderer.uploads, frame.command_buffer_ptr, snap.readbacks, nullptr, renderer.swap_format, 0, 0);
+            upload_ring_submit(renderer.uploads, frame.command_buffer_ptr);
+            draw_list_reset(renderer.draw_list);
             SDL_Delay(1);
             return;
         }
 
-        if (g_mode == SceneMode::Docked)
+        if (snap.mode == SceneMode::Docked)
         {
-            if (renderer.msaa > SDL_GPU_SAMPLECOUNT_1)
+            if (snap.msaa > SDL_GPU_SAMPLECOUNT_1)
             {
                 SDL_GPUColorTargetInfo t{};
-                t.texture = renderer.scene_msaa;
+                t.texture = snap.scene_msaa;
                 t.load_op = SDL_GPU_LOADOP_CLEAR;
                 t.store_op = SDL_GPU_STOREOP_RESOLVE;
                 t.clear_color = SDL_FColor{0.2f, 0.3f, 0.3f, 1.0f};
-                t.resolve_texture = renderer.scene_tex;
+                t.resolve_texture = snap.scene_tex;
                 frame.render_pass_ptr = SDL_BeginGPURenderPass(frame.command_buffer_ptr, &t, 1, NULL);
-                if (draw_func && draw_data) draw_func(draw_data);
+                draw_list_emit(renderer.draw_list, frame.command_buffer_ptr, frame.render_pass_ptr, PASS_SCENE);
                 SDL_EndGPURenderPass(frame.render_pass_ptr);
             }
             else
             {
                 SDL_GPUColorTargetInfo t{};
-                t.texture = renderer.scene_tex;
+                t.texture = snap.scene_tex;
                 t.load_op = SDL_GPU_LOADOP_CLEAR;
                 t.store_op = SDL_GPU_STOREOP_STORE;
                 t.clear_color = SDL_FColor{0.2f, 0.3f, 0.3f, 1.0f};
                 frame.render_pass_ptr = SDL_BeginGPURenderPass(frame.command_buffer_ptr, &t, 1, NULL);
-                if (draw_func && draw_data) draw_func(draw_data);
+                draw_list_emit(renderer.draw_list, frame.command_buffer_ptr, frame.render_pass_ptr, PASS_SCENE);
                 SDL_EndGPURenderPass(frame.render_pass_ptr);
             }
 
-            SDL_GPUColorTargetInfo ui{};
-            ui.texture = swap_texture;
-            ui.load_op = SDL_GPU_LOADOP_CLEAR;
-            ui.store_op = SDL_GPU_STOREOP_STORE;
-            ui.clear_color = SDL_FColor{0.1f, 0.1f, 0.1f, 1.0f};
-            frame.render_pass_ptr = SDL_BeginGPURenderPass(frame.command_buffer_ptr, &ui, 1, NULL);
-            ImGui_ImplSDLGPU3_PrepareDrawData(ImGui::GetDrawData(), frame.command_buffer_ptr);
-            ImGui_ImplSDLGPU3_RenderDrawData(ImGui::GetDrawData(), frame.command_buffer_ptr, frame.render_pass_ptr, NULL);
-            SDL_EndGPURenderPass(frame.render_pass_ptr);
+            post_process(renderer, snap);
+            draw_ui_pass(renderer, snap, swap_texture);
         }
         else
         {
-            if (renderer.msaa > SDL_GPU_SAMPLECOUNT_1)
+            if (snap.msaa > SDL_GPU_SAMPLECOUNT_1)
             {
                 SDL_GPUColorTargetInfo t{};
-                t.texture = renderer.msaa_color;
+                t.texture = snap.msaa_color;
                 t.load_op = SDL_GPU_LOADOP_CLEAR;
                 t.store_op = SDL_GPU_STOREOP_RESOLVE;
                 t.clear_color = SDL_FColor{0.2f, 0.3f, 0.3f, 1.0f};
                 t.resolve_texture = swap_texture;
                 frame.render_pass_ptr = SDL_BeginGPURenderPass(frame.command_buffer_ptr, &t, 1, NULL);
-                if (draw_func && draw_data) draw_func(draw_data);
+                draw_list_emit(renderer.draw_list, frame.command_buffer_ptr, frame.render_pass_ptr, PASS_SCENE);
                 SDL_EndGPURenderPass(frame.render_pass_ptr);
             }
             else
@@ -422,12 +1037,14 @@ namespace brender
                 t.store_op = SDL_GPU_STOREOP_STORE;
                 t.clear_color = SDL_FColor{0.2f, 0.3f, 0.3f, 1.0f};
                 frame.render_pass_ptr = SDL_BeginGPURenderPass(frame.command_buffer_ptr, &t, 1, NULL);
-                if (draw_func && draw_data) draw_func(draw_data);
+                draw_list_emit(renderer.draw_list, frame.command_buffer_ptr, frame.render_pass_ptr, PASS_SCENE);
                 SDL_EndGPURenderPass(frame.render_pass_ptr);
             }
         }
 
-        SDL_SubmitGPUCommandBuffer(frame.command_buffer_ptr);
+        readback_ring_record(renderer.readback, renderer.uploads, frame.command_buffer_ptr, snap.readbacks, swap_texture, renderer.swap_format, swap_w, swap_h);
+        upload_ring_submit(renderer.uploads, frame.command_buffer_ptr);
+        draw_list_reset(renderer.draw_list);
         SDL_Delay(1);
     }
 
@@ -453,12 +1070,24 @@ namespace brender
         if (renderer.swap_format == SDL_GPU_TEXTUREFORMAT_INVALID)
             SDIE("SDL_GetGPUSwapchainTextureFormat()");
 
+        if (upload_ring_init(renderer.uploads, renderer.device_ptr, 8u << 20) == false)
+            SDIE("upload_ring_init()");
+        state_cache_init(renderer.state_cache, renderer.device_ptr);
+        readback_ring_init(renderer.readback, renderer.device_ptr);
+
+        if (gpu_pool_init(renderer.geometry, renderer.device_ptr, SDL_GPU_BUFFERUSAGE_VERTEX | SDL_GPU_BUFFERUSAGE_INDEX, 16u << 20) == false)
+            SDIE("gpu_pool_init()");
+
         renderer.msaa = SDL_GPU_SAMPLECOUNT_8;
         renderer.imgui_msaa = SDL_GPU_SAMPLECOUNT_1;
         renderer.msaa_color = nullptr;
         create_target(renderer);
 
         imgui_xinit(renderer);
+
+        if (texture_stream_init(renderer.texture_streamer, renderer.device_ptr, renderer.uploads) == false)
+            SDIE("texture_stream_init()");
+        ImGuiSDL3GPU_SetTextureResolver(renderer.imgui, resolve_ui_texture, &renderer);
     }
 
 }
@@ -466,15 +1095,19 @@ namespace brender
 namespace shader
 {
 
-    enum class type { vertex, fragment, pipeline };
+    enum class type { vertex, fragment, pipeline, compute };
 
     struct file
     {
         type shader_type{};
         std::string name;
-        std::string path;
+        char path[256] = {};
         std::string source;
         std::array<uint8_t, BLAKE3_OUT_LEN> dgst{};
+        // Taken just before `source` was read; reload checks only read files
+        // whose stamp has moved.
+        SDL_Time modified = 0;
+        Uint64 size = 0;
 
         std::array<uint8_t, BLAKE3_OUT_LEN> failed_dgst{};
         bool failed_valid = false;
@@ -484,6 +1117,7 @@ namespace shader
     {
         std::vector<uint32_t> spirv;
         ReflectedResources reflect{};
+        ReflectedCompute compute{};
     };
 
     struct source
@@ -498,6 +1132,16 @@ namespace shader
         source vertex;
         source fragment;
         source pipeline;
+        // Both stages' uniform blocks; values survive reloads by member name.
+        UniformValues uniforms;
+        // Sample count the pipeline was built for.
+        SDL_GPUSampleCount samples = SDL_GPU_SAMPLECOUNT_1;
+    };
+
+    // A single .comp file; no pipeline JSON, everything comes from reflection.
+    struct compute_program
+    {
+        source compute;
     };
 
     struct manager
@@ -505,9 +1149,25 @@ namespace shader
         shaderc::Compiler compiler;
         shaderc::CompileOptions opts;
         std::vector<file> files;
-        std::vector<program> programs;
+        // Held by handle: the packed values move when a program is removed.
+        SlotMap<program> programs;
+        SlotMap<compute_program> compute_programs;
     };
 
+    using program_handle = SlotHandle<program>;
+    using compute_handle = SlotHandle<compute_program>;
+
+    // Null once the program has been removed.
+    inline program* get(manager& shader_manager, program_handle handle)
+    {
+        return slot_map_get(shader_manager.programs, handle);
+    }
+
+    inline compute_program* get(manager& shader_manager, compute_handle handle)
+    {
+        return slot_map_get(shader_manager.compute_programs, handle);
+    }
+
     inline SDL_GPUShader* as_shader(const source& source_ref)
     {
         return static_cast<SDL_GPUShader*>(source_ref.sdl_ptr);
@@ -518,6 +1178,11 @@ namespace shader
         return static_cast<SDL_GPUGraphicsPipeline*>(program_ref.pipeline.sdl_ptr);
     }
 
+    inline SDL_GPUComputePipeline* as_compute(const compute_program& program_ref)
+    {
+        return static_cast<SDL_GPUComputePipeline*>(program_ref.compute.sdl_ptr);
+    }
+
     static void blake3_digest(const std::string& text, std::array<uint8_t, BLAKE3_OUT_LEN>& out_digest)
     {
         blake3_hasher hasher;
@@ -526,7 +1191,7 @@ namespace shader
         blake3_hasher_finalize(&hasher, out_digest.data(), out_digest.size());
     }
 
-    static bool read_file_retry(const std::string& path, std::string& out, int tries = 10, int wait_ms = 8)
+    static bool read_file_retry(const char* path, std::string& out, int tries = 10, int wait_ms = 8)
     {
         for (int i = 0; i < tries; ++i)
         {
@@ -548,14 +1213,21 @@ namespace shader
     static void load_text_file(file& out_file, type shader_type, const char* file_name)
     {
         out_file.shader_type = shader_type;
+        // Rebuilds assign the same name again; that reuses the string's
+        // storage rather than building a new one.
         out_file.name = file_name;
-        out_file.path = std::string(SHADER_SRC_DIR) + "/" + file_name;
+        if (SDL_snprintf(out_file.path, sizeof(out_file.path), "%s/%s", SHADER_SRC_DIR, file_name) >= (int)sizeof(out_file.path))
+            DIE(arena_printf(arena_scratch(), "Path too long: %s/%s", SHADER_SRC_DIR, file_name));
+        SDL_PathInfo info{};
+        SDL_GetPathInfo(out_file.path, &info);
+        out_file.modified = info.modify_time;
+        out_file.size = info.size;
         std::string text;
         if (!read_file_retry(out_file.path, text))
-            DIE(("File not found: " + out_file.path).c_str());
+            DIE(arena_printf(arena_scratch(), "File not found: %s", out_file.path));
         out_file.source = std::move(text);
         if (out_file.source.empty())
-            DIE(("Empty file: " + out_file.path).c_str());
+            DIE(arena_printf(arena_scratch(), "Empty file: %s", out_file.path));
         blake3_digest(out_file.source, out_file.dgst);
     }
 
@@ -581,9 +1253,9 @@ namespace shader
         return shaderc_optimization_level_performance;
     }
 
-    static std::unique_ptr<spirv_info> compile_to_spirv(manager& shader_manager, const file& shader_file, shaderc_shader_kind shader_kind)
+    static std::unique_ptr<spirv_info> compile_to_spirv(manager& shader_manager, const file& shader_file, shaderc_shader_kind shader_kind, const shaderc::CompileOptions& opts)
     {
-        auto compile_result = shader_manager.compiler.CompileGlslToSpv(shader_file.source, shader_kind, shader_file.name.c_str(), shader_manager.opts);
+        auto compile_result = shader_manager.compiler.CompileGlslToSpv(shader_file.source, shader_kind, shader_file.name.c_str(), opts);
         if (compile_result.GetCompilationStatus() != shaderc_compilation_status_success)
             DIE(compile_result.GetErrorMessage().c_str());
         auto info_ptr = std::make_unique<spirv_info>();
@@ -592,9 +1264,58 @@ namespace shader
             DIE(("Compiled to empty SPIR-V: " + shader_file.name).c_str());
         if (!reflect_resources(info_ptr->spirv, info_ptr->reflect))
             DIE(("SPIR-V reflection failed: " + shader_file.name).c_str());
+        std::string layout_error;
+        if (shader_kind == shaderc_compute_shader && !reflect_compute(info_ptr->spirv, info_ptr->compute, &layout_error))
+            DIE((shader_file.name + ": " + layout_error).c_str());
         return info_ptr;
     }
 
+    struct compile_job
+    {
+        manager* shader_manager;
+        const file* shader_file;
+        shaderc_shader_kind kind;
+        shaderc::CompileOptions opts;
+        std::unique_ptr<spirv_info> result;
+        std::string error;
+    };
+
+    static void compile_job_run(void* user, Uint32 index)
+    {
+        compile_job& job = static_cast<compile_job*>(user)[index];
+        try
+        {
+            job.result = compile_to_spirv(*job.shader_manager, *job.shader_file, job.kind, job.opts);
+        }
+        catch (const soft_error& e)
+        {
+            job.error = e.what();
+        }
+    }
+
+    // Compiles both stages as jobs. The shaderc compiler may be shared across
+    // threads; the options may not, so each stage gets a copy.
+    static void compile_stages(manager& shader_manager, const file& vs, const file& fs,
+                               shaderc_optimization_level vs_opt, shaderc_optimization_level fs_opt,
+                               std::unique_ptr<spirv_info>& vs_info, std::unique_ptr<spirv_info>& fs_info)
+    {
+        compile_job stages[2] =
+        {
+            { &shader_manager, &vs, shaderc_vertex_shader,   shader_manager.opts, nullptr, {} },
+            { &shader_manager, &fs, shaderc_fragment_shader, shader_manager.opts, nullptr, {} },
+        };
+        stages[0].opts.SetOptimizationLevel(vs_opt);
+        stages[1].opts.SetOptimizationLevel(fs_opt);
+        jobs::Counter counter;
+        jobs::run(compile_job_run, stages, 2, &counter);
+        jobs::wait(counter);
+        for (const compile_job& job : stages)
+            if (!job.error.empty())
+                throw soft_error(job.error);
+        vs_info = std::move(stages[0].result);
+        fs_info = std::move(stages[1].result);
+    }
+
     void destroy_program(brender::renderer& renderer, program& program_ref)
     {
         if (program_ref.pipeline.sdl_ptr)
@@ -618,6 +1339,75 @@ namespace shader
         program_ref.fragment.data = nullptr;
     }
 
+    // Drops a program while frames may still be queued with it: its pipeline
+    // and shaders are retired, and its handle resolves to null from here on.
+    void remove_program(brender::renderer& renderer, manager& shader_manager, program_handle handle)
+    {
+        program* prog = get(shader_manager, handle);
+        if (!prog)
+            return;
+        brender::retire(renderer, RetireKind::graphics_pipeline, prog->pipeline.sdl_ptr);
+        brender::retire(renderer, RetireKind::shader, prog->vertex.sdl_ptr);
+        brender::retire(renderer, RetireKind::shader, prog->fragment.sdl_ptr);
+        prog->pipeline.sdl_ptr = prog->vertex.sdl_ptr = prog->fragment.sdl_ptr = nullptr;
+        destroy_program(renderer, *prog);
+        slot_map_remove(shader_manager.programs, handle);
+    }
+
+    // Fixed-function state for a pipeline config. SDL_GPU copies these into
+    // each pipeline; there are no driver objects for them to share.
+    struct pipeline_states
+    {
+        SDL_GPURasterizerState rasterizer{};
+        SDL_GPUDepthStencilState depth_stencil{};
+        ArenaVector<SDL_GPUColorTargetDescription> color_targets;
+
+        explicit pipeline_states(Arena& arena) : color_targets(ArenaAllocator<SDL_GPUColorTargetDescription>(arena)) {}
+    };
+
+    static pipeline_states make_pipeline_states(brender::renderer& renderer, const PipelineConfig& cfg)
+    {
+        pipeline_states out(arena_scratch());
+
+        SDL_GPURasterizerState rasterizer_state{};
+        rasterizer_state.fill_mode = SDL_GPU_FILLMODE_FILL;
+        rasterizer_state.cull_mode = cfg.cull;
+        rasterizer_state.front_face= cfg.front_face;
+        rasterizer_state.enable_depth_bias = false;
+        rasterizer_state.enable_depth_clip = true;
+        out.rasterizer = rasterizer_state;
+
+        SDL_GPUDepthStencilState depth_stencil_state{};
+        depth_stencil_state.enable_depth_test = cfg.depth.enable;
+        depth_stencil_state.enable_depth_write= cfg.depth.write;
+        depth_stencil_state.enable_stencil_test=false;
+        depth_stencil_state.compare_op = cfg.depth.compare;
+        depth_stencil_state.compare_mask = 0xFF;
+        depth_stencil_state.write_mask = 0xFF;
+        out.depth_stencil = depth_stencil_state;
+
+        // No blend entries means one opaque target.
+        PipelineConfig::Blend opaque{};
+        out.color_targets.resize(cfg.blends.empty() ? 1 : cfg.blends.size());
+        for (size_t i = 0; i < out.color_targets.size(); ++i)
+        {
+            const PipelineConfig::Blend& src = cfg.blends.empty() ? opaque : cfg.blends[i];
+            SDL_GPUColorTargetBlendState b{};
+            b.enable_blend = src.enable;
+            b.enable_color_write_mask = true;
+            b.color_write_mask = src.write_mask;
+            b.src_color_blendfactor = src.src_color;
+            b.dst_color_blendfactor = src.dst_color;
+            b.color_blend_op = src.color_op;
+            b.src_alpha_blendfactor = src.src_alpha;
+            b.dst_alpha_blendfactor = src.dst_alpha;
+            b.alpha_blend_op = src.alpha_op;
+            out.color_targets[i].format = renderer.swap_format;
+            out.color_targets[i].blend_state = b;
+        }
+        return out;
+    }
+
     static program build_program_internal(brender::renderer& renderer, manager& shader_manager, const char* pipeline_json_name)
     {
         program out_program{};
@@ -626,7 +1416,7 @@ namespace shader
 
         PipelineConfig cfg{};
         if (!load_pipeline_config(out_program.pipeline.file.path, cfg, 1))
-            DIE(("Failed to load pipeline config: " + out_program.pipeline.file.path).c_str());
+            DIE(arena_printf(arena_scratch(), "Failed to load pipeline config: %s", out_program.pipeline.file.path));
 
         load_text_file(out_program.vertex.file,   type::vertex,   cfg.vertex_shader.c_str());
         load_text_file(out_program.fragment.file, type::fragment, cfg.fragment_shader.c_str());
@@ -638,10 +1428,10 @@ namespace shader
         if (opt_fs.empty()) opt_fs = "performance";
 
         shader_manager.opts.SetOptimizationLevel(map_opt_level(opt_vs));
-        auto vs_info = compile_to_spirv(shader_manager, out_program.vertex.file,   shaderc_vertex_shader);
+        auto vs_info = compile_to_spirv(shader_manager, out_program.vertex.file,   shaderc_vertex_shader, shader_manager.opts);
 
         shader_manager.opts.SetOptimizationLevel(map_opt_level(opt_fs));
-        auto fs_info = compile_to_spirv(shader_manager, out_program.fragment.file, shaderc_fragment_shader);
+        auto fs_info = compile_to_spirv(shader_manager, out_program.fragment.file, shaderc_fragment_shader, shader_manager.opts);
 
         out_program.vertex.data   = vs_info.release();
         out_program.fragment.data = fs_info.release();
@@ -650,9 +1440,13 @@ namespace shader
         ReflectedVertexInput vertex_input{};
         if (!reflect_vertex_input(out_program.vertex.data->spirv, vertex_input))
             DIE("reflect_vertex_input");
-        pack_tight(vertex_input);
+        std::string layout_error;
+        if (!cfg.vertex_layout_auto && !apply_manual_layout(vertex_input, cfg.vertex_streams, &layout_error))
+            DIE(("vertex_layout: " + layout_error).c_str());
+        if (cfg.vertex_layout_auto && !pack_streams(vertex_input, cfg.vertex_streams))
+            DIE("vertex_streams do not match the vertex shader inputs");
 
-        SDL_GPUSampleCount requested = map_samples(cfg.sample_count);
+        SDL_GPUSampleCount requested = map_samples(renderer.msaa_request ? renderer.msaa_request : cfg.sample_count);
         SDL_GPUSampleCount chosen = choose_supported(renderer.device_ptr, renderer.swap_format, requested);
         {
             char msg[128];
@@ -700,67 +1494,21 @@ namespace shader
         out_program.fragment.sdl_ptr = fragment_shader_ptr;
 
         SDL_GPUVertexInputState vertex_input_state{};
-        vertex_input_state.vertex_buffer_descriptions = &vertex_input.buffer_desc;
-        vertex_input_state.num_vertex_buffers = 1;
+        vertex_input_state.vertex_buffer_descriptions = vertex_input.buffers.data();
+        vertex_input_state.num_vertex_buffers = (Uint32)vertex_input.buffers.size();
         vertex_input_state.vertex_attributes = vertex_input.attributes.data();
         vertex_input_state.num_vertex_attributes = (Uint32)vertex_input.attributes.size();
 
-        SDL_GPURasterizerState rasterizer_state{};
-        rasterizer_state.fill_mode = SDL_GPU_FILLMODE_FILL;
-        rasterizer_state.cull_mode = cfg.cull;
-        rasterizer_state.front_face= cfg.front_face;
-        rasterizer_state.enable_depth_bias = false;
-        rasterizer_state.enable_depth_clip = true;
+        pipeline_states states = make_pipeline_states(renderer, cfg);
 
         SDL_GPUMultisampleState multisample_state{};
         multisample_state.sample_count = renderer.msaa;
         multisample_state.sample_mask = 0;
         multisample_state.enable_mask = false;
 
-        SDL_GPUDepthStencilState depth_stencil_state{};
-        depth_stencil_state.enable_depth_test = cfg.depth.enable;
-        depth_stencil_state.enable_depth_write= cfg.depth.write;
-        depth_stencil_state.enable_stencil_test=false;
-        depth_stencil_state.compare_op = cfg.depth.compare;
-        depth_stencil_state.compare_mask = 0xFF;
-        depth_stencil_state.write_mask = 0xFF;
-
-        std::vector<SDL_GPUColorTargetDescription> color_targets;
-        color_targets.resize(cfg.blends.empty() ? 1 : cfg.blends.size());
-        for (size_t index = 0; index < color_targets.size(); ++index)
-        {
-            SDL_GPUColorTargetBlendState blend{};
-            if (!cfg.blends.empty())
-            {
-                blend.enable_blend = cfg.blends[index].enable;
-                blend.enable_color_write_mask = true;
-                blend.color_write_mask = cfg.blends[index].write_mask;
-                blend.src_color_blendfactor = cfg.blends[index].src_color;
-                blend.dst_color_blendfactor = cfg.blends[index].dst_color;
-                blend.color_blend_op = cfg.blends[index].color_op;
-                blend.src_alpha_blendfactor = cfg.blends[index].src_alpha;
-                blend.dst_alpha_blendfactor = cfg.blends[index].dst_alpha;
-                blend.alpha_blend_op = cfg.blends[index].alpha_op;
-            }
-            else
-            {
-                blend.enable_blend = false;
-                blend.enable_color_write_mask = true;
-                blend.color_write_mask = SDL_GPU_COLORCOMPONENT_R | SDL_GPU_COLORCOMPONENT_G | SDL_GPU_COLORCOMPONENT_B | SDL_GPU_COLORCOMPONENT_A;
-                blend.src_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
-                blend.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ZERO;
-                blend.color_blend_op = SDL_GPU_BLENDOP_ADD;
-                blend.src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
-                blend.dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ZERO;
-                blend.alpha_blend_op = SDL_GPU_BLENDOP_ADD;
-            }
-            color_targets[index].format = renderer.swap_format;
-            color_targets[index].blend_state = blend;
-        }
-
         SDL_GPUGraphicsPipelineTargetInfo target_info{};
-        target_info.color_target_descriptions = color_targets.data();
-        target_info.num_color_targets = (Uint32)color_targets.size();
+        target_info.color_target_descriptions = states.color_targets.data();
+        target_info.num_color_targets = (Uint32)states.color_targets.size();
         target_info.depth_stencil_format = cfg.depth.enable ? cfg.depth.format : SDL_GPU_TEXTUREFORMAT_INVALID;
         target_info.has_depth_stencil_target = cfg.depth.enable;
 
@@ -769,9 +1517,9 @@ namespace shader
         pipeline_info.fragment_shader     = fragment_shader_ptr;
         pipeline_info.vertex_input_state  = vertex_input_state;
         pipeline_info.primitive_type      = cfg.primitive;
-        pipeline_info.rasterizer_state    = rasterizer_state;
+        pipeline_info.rasterizer_state    = states.rasterizer;
         pipeline_info.multisample_state   = multisample_state;
-        pipeline_info.depth_stencil_state = depth_stencil_state;
+        pipeline_info.depth_stencil_state = states.depth_stencil;
         pipeline_info.target_info         = target_info;
 
         SDL_GPUGraphicsPipeline* pipeline_ptr = SDL_CreateGPUGraphicsPipeline(renderer.device_ptr, &pipeline_info);
@@ -782,9 +1530,13 @@ namespace shader
         return out_program;
     }
 
-    program& build_program(brender::renderer& renderer, manager& shader_manager, const char* pipeline_json_name, program* reuse_program = nullptr)
+    // Builds `pipeline_json_name` into a new program, or rebuilds `reuse` in
+    // place. A failed build still yields a handle; its pipeline stays null
+    // until a reload succeeds.
+    program_handle build_program(brender::renderer& renderer, manager& shader_manager, const char* pipeline_json_name, program_handle reuse = {})
     {
-        program* dst = reuse_program ? reuse_program : &shader_manager.programs.emplace_back();
+        program_handle handle = get(shader_manager, reuse) ? reuse : slot_map_insert(shader_manager.programs, program{});
+        program* dst = get(shader_manager, handle);
 
         try
         {
@@ -792,7 +1544,7 @@ namespace shader
 
             PipelineConfig cfg{};
             if (!load_pipeline_config(dst->pipeline.file.path, cfg, 1))
-                DIE(("Failed to load pipeline config: " + dst->pipeline.file.path).c_str());
+                DIE(arena_printf(arena_scratch(), "Failed to load pipeline config: %s", dst->pipeline.file.path));
 
             load_text_file(dst->vertex.file,   type::vertex,   cfg.vertex_shader.c_str());
             load_text_file(dst->fragment.file, type::fragment, cfg.fragment_shader.c_str());
@@ -803,22 +1555,40 @@ namespace shader
             if (opt_vs.empty()) opt_vs = "performance";
             if (opt_fs.empty()) opt_fs = "performance";
 
-            shader_manager.opts.SetOptimizationLevel(map_opt_level(opt_vs));
-            std::unique_ptr<spirv_info> vs_info = compile_to_spirv(shader_manager, dst->vertex.file,   shaderc_vertex_shader);
+            std::unique_ptr<spirv_info> vs_info, fs_info;
+            compile_stages(shader_manager, dst->vertex.file, dst->fragment.file, map_opt_level(opt_vs), map_opt_level(opt_fs), vs_info, fs_info);
 
-            shader_manager.opts.SetOptimizationLevel(map_opt_level(opt_fs));
-            std::unique_ptr<spirv_info> fs_info = compile_to_spirv(shader_manager, dst->fragment.file, shaderc_fragment_shader);
+            std::vector<ReflectedUniformBlock> vs_blocks, fs_blocks;
+            if (!reflect_uniform_blocks(vs_info->spirv, vs_blocks) || !reflect_uniform_blocks(fs_info->spirv, fs_blocks))
+                DIE("reflect_uniform_blocks");
+            auto uniform_layout = std::make_shared<UniformLayout>();
+            if (!uniform_layout_build(*uniform_layout, vs_blocks, fs_blocks))
+                DIE("uniform blocks must use bindings 0-3 of their stage's uniform set");
 
             ReflectedVertexInput vertex_input{};
             if (!reflect_vertex_input(vs_info->spirv, vertex_input)) DIE("reflect_vertex_input");
-            pack_tight(vertex_input);
+            std::string layout_error;
+            if (!cfg.vertex_layout_auto && !apply_manual_layout(vertex_input, cfg.vertex_streams, &layout_error))
+                DIE(("vertex_layout: " + layout_error).c_str());
+            if (cfg.vertex_layout_auto && !pack_streams(vertex_input, cfg.vertex_streams))
+                DIE("vertex_streams do not match the vertex shader inputs");
 
-            SDL_GPUSampleCount requested = map_samples(cfg.sample_count);
+            SDL_GPUSampleCount requested = map_samples(renderer.msaa_request ? renderer.msaa_request : cfg.sample_count);
             SDL_GPUSampleCount chosen = choose_supported(renderer.device_ptr, renderer.swap_format, requested);
             if (renderer.msaa != chosen)
             {
                 renderer.msaa = chosen;
                 brender::create_target(renderer);
+                // Pipelines at the old count cannot draw into the new
+                // targets. Those rebuilt next get them back; one whose
+                // rebuild fails stays without until a reload succeeds.
+                for (program& other : shader_manager.programs.values)
+                {
+                    if (&other == dst || !other.pipeline.sdl_ptr || other.samples == chosen)
+                        continue;
+                    brender::retire(renderer, RetireKind::graphics_pipeline, other.pipeline.sdl_ptr);
+                    other.pipeline.sdl_ptr = nullptr;
+                }
 
                 int w = renderer.scene_w;
                 int h = renderer.scene_h;
@@ -861,67 +1631,21 @@ namespace shader
             if (!new_fs) { SDL_ReleaseGPUShader(renderer.device_ptr, new_vs); DIE("SDL_CreateGPUShader(fragment)"); }
 
             SDL_GPUVertexInputState vertex_input_state{};
-            vertex_input_state.vertex_buffer_descriptions = &vertex_input.buffer_desc;
-            vertex_input_state.num_vertex_buffers = 1;
+            vertex_input_state.vertex_buffer_descriptions = vertex_input.buffers.data();
+            vertex_input_state.num_vertex_buffers = (Uint32)vertex_input.buffers.size();
             vertex_input_state.vertex_attributes = vertex_input.attributes.data();
             vertex_input_state.num_vertex_attributes = (Uint32)vertex_input.attributes.size();
 
-            SDL_GPURasterizerState rasterizer_state{};
-            rasterizer_state.fill_mode = SDL_GPU_FILLMODE_FILL;
-            rasterizer_state.cull_mode = cfg.cull;
-            rasterizer_state.front_face= cfg.front_face;
-            rasterizer_state.enable_depth_bias = false;
-            rasterizer_state.enable_depth_clip = true;
+            pipeline_states states = make_pipeline_states(renderer, cfg);
 
             SDL_GPUMultisampleState multisample_state{};
             multisample_state.sample_count = renderer.msaa;
             multisample_state.sample_mask = 0;
             multisample_state.enable_mask = false;
 
-            SDL_GPUDepthStencilState depth_stencil_state{};
-            depth_stencil_state.enable_depth_test = cfg.depth.enable;
-            depth_stencil_state.enable_depth_write= cfg.depth.write;
-            depth_stencil_state.enable_stencil_test=false;
-            depth_stencil_state.compare_op = cfg.depth.compare;
-            depth_stencil_state.compare_mask = 0xFF;
-            depth_stencil_state.write_mask = 0xFF;
-
-            std::vector<SDL_GPUColorTargetDescription> color_targets;
-            color_targets.resize(cfg.blends.empty() ? 1 : cfg.blends.size());
-            for (size_t i = 0; i < color_targets.size(); ++i)
-            {
-                SDL_GPUColorTargetBlendState b{};
-                if (!cfg.blends.empty())
-                {
-                    b.enable_blend = cfg.blends[i].enable;
-                    b.enable_color_write_mask = true;
-                    b.color_write_mask = cfg.blends[i].write_mask;
-                    b.src_color_blendfactor = cfg.blends[i].src_color;
-                    b.dst_color_blendfactor = cfg.blends[i].dst_color;
-                    b.color_blend_op = cfg.blends[i].color_op;
-                    b.src_alpha_blendfactor = cfg.blends[i].src_alpha;
-                    b.dst_alpha_blendfactor = cfg.blends[i].dst_alpha;
-                    b.alpha_blend_op = cfg.blends[i].alpha_op;
-                }
-                else
-                {
-                    b.enable_blend = false;
-                    b.enable_color_write_mask = true;
-                    b.color_write_mask = SDL_GPU_COLORCOMPONENT_R | SDL_GPU_COLORCOMPONENT_G | SDL_GPU_COLORCOMPONENT_B | SDL_GPU_COLORCOMPONENT_A;
-                    b.src_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
-                    b.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ZERO;
-                    b.color_blend_op = SDL_GPU_BLENDOP_ADD;
-                    b.src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
-                    b.dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ZERO;
-                    b.alpha_blend_op = SDL_GPU_BLENDOP_ADD;
-                }
-                color_targets[i].format = renderer.swap_format;
-                color_targets[i].blend_state = b;
-            }
-
             SDL_GPUGraphicsPipelineTargetInfo target_info{};
-            target_info.color_target_descriptions = color_targets.data();
-            target_info.num_color_targets = (Uint32)color_targets.size();
+            target_info.color_target_descriptions = states.color_targets.data();
+            target_info.num_color_targets = (Uint32)states.color_targets.size();
             target_info.depth_stencil_format = cfg.depth.enable ? cfg.depth.format : SDL_GPU_TEXTUREFORMAT_INVALID;
             target_info.has_depth_stencil_target = cfg.depth.enable;
 
@@ -930,9 +1654,9 @@ namespace shader
             pipeline_info.fragment_shader     = new_fs;
             pipeline_info.vertex_input_state  = vertex_input_state;
             pipeline_info.primitive_type      = cfg.primitive;
-            pipeline_info.rasterizer_state    = rasterizer_state;
+            pipeline_info.rasterizer_state    = states.rasterizer;
             pipeline_info.multisample_state   = multisample_state;
-            pipeline_info.depth_stencil_state = depth_stencil_state;
+            pipeline_info.depth_stencil_state = states.depth_stencil;
             pipeline_info.target_info         = target_info;
 
             SDL_GPUGraphicsPipeline* new_pipe = SDL_CreateGPUGraphicsPipeline(renderer.device_ptr, &pipeline_info);
@@ -943,9 +1667,9 @@ namespace shader
                 DIE("SDL_CreateGPUGraphicsPipeline");
             }
 
-            if (dst->pipeline.sdl_ptr) SDL_ReleaseGPUGraphicsPipeline(renderer.device_ptr, (SDL_GPUGraphicsPipeline*)dst->pipeline.sdl_ptr);
-            if (dst->vertex.sdl_ptr)   SDL_ReleaseGPUShader(renderer.device_ptr, (SDL_GPUShader*)dst->vertex.sdl_ptr);
-            if (dst->fragment.sdl_ptr) SDL_ReleaseGPUShader(renderer.device_ptr, (SDL_GPUShader*)dst->fragment.sdl_ptr);
+            brender::retire(renderer, RetireKind::graphics_pipeline, dst->pipeline.sdl_ptr);
+            brender::retire(renderer, RetireKind::shader, dst->vertex.sdl_ptr);
+            brender::retire(renderer, RetireKind::shader, dst->fragment.sdl_ptr);
 
             delete dst->vertex.data;
             delete dst->fragment.data;
@@ -956,38 +1680,300 @@ namespace shader
             dst->vertex.sdl_ptr = new_vs;
             dst->fragment.sdl_ptr = new_fs;
             dst->pipeline.sdl_ptr = new_pipe;
+            dst->samples = renderer.msaa;
+            uniform_values_reset(dst->uniforms, std::move(uniform_layout));
 
             dst->vertex.file.failed_valid = false;
             dst->fragment.file.failed_valid = false;
             dst->pipeline.file.failed_valid = false;
 
-            return *dst;
+            return handle;
         }
         catch (const soft_error& e)
         {
-            app_log(logui::level::error, std::string("Build failed: ") + e.what());
+            logui::logf(logui::level::error, "Build failed: %s", e.what());
+            if (dst->pipeline.sdl_ptr && dst->samples != renderer.msaa)
+            {
+                brender::retire(renderer, RetireKind::graphics_pipeline, dst->pipeline.sdl_ptr);
+                dst->pipeline.sdl_ptr = nullptr;
+            }
             dst->vertex.file.failed_dgst = dst->vertex.file.dgst;
             dst->fragment.file.failed_dgst = dst->fragment.file.dgst;
             dst->pipeline.file.failed_dgst = dst->pipeline.file.dgst;
             dst->vertex.file.failed_valid = true;
             dst->fragment.file.failed_valid = true;
             dst->pipeline.file.failed_valid = true;
-            return *dst;
+            return handle;
+        }
+    }
+
+    void destroy_compute(brender::renderer& renderer, compute_program& program_ref)
+    {
+        if (program_ref.compute.sdl_ptr)
+        {
+            SDL_ReleaseGPUComputePipeline(renderer.device_ptr, as_compute(program_ref));
+            program_ref.compute.sdl_ptr = nullptr;
+        }
+        delete program_ref.compute.data;
+        program_ref.compute.data = nullptr;
+    }
+
+    // Compiles a .comp file into a compute pipeline sized from reflection. On
+    // reload the old pipeline is retired, since queued frames may dispatch it.
+    compute_handle build_compute(brender::renderer& renderer, manager& shader_manager, const char* comp_name, compute_handle reuse = {})
+    {
+        compute_handle handle = get(shader_manager, reuse) ? reuse : slot_map_insert(shader_manager.compute_programs, compute_program{});
+        compute_program* dst = get(shader_manager, handle);
+
+        try
+        {
+            load_text_file(dst->compute.file, type::compute, comp_name);
+            std::unique_ptr<spirv_info> info = compile_to_spirv(shader_manager, dst->compute.file, shaderc_compute_shader, shader_manager.opts);
+            const ReflectedCompute& layout = info->compute;
+
+            SDL_GPUComputePipelineCreateInfo ci{};
+            ci.code_size = info->spirv.size() * sizeof(uint32_t);
+            ci.code = reinterpret_cast<const Uint8*>(info->spirv.data());
+            ci.entrypoint = "main";
+            ci.format = SDL_GPU_SHADERFORMAT_SPIRV;
+            ci.num_samplers                   = layout.num_samplers;
+            ci.num_readonly_storage_textures  = layout.num_readonly_storage_textures;
+            ci.num_readonly_storage_buffers   = layout.num_readonly_storage_buffers;
+            ci.num_readwrite_storage_textures = layout.num_readwrite_storage_textures;
+            ci.num_readwrite_storage_buffers  = layout.num_readwrite_storage_buffers;
+            ci.num_uniform_buffers            = layout.num_uniform_buffers;
+            ci.threadcount_x = layout.threadcount_x;
+            ci.threadcount_y = layout.threadcount_y;
+            ci.threadcount_z = layout.threadcount_z;
+
+            SDL_GPUComputePipeline* new_pipe = SDL_CreateGPUComputePipeline(renderer.device_ptr, &ci);
+            if (!new_pipe)
+                DIE("SDL_CreateGPUComputePipeline");
+
+            char msg[160];
+            std::snprintf(msg, sizeof(msg), "%s: %ux%ux%u threads, storage ro %u/%u rw %u/%u (buffers/textures)",
+                          comp_name, layout.threadcount_x, layout.threadcount_y, layout.threadcount_z,
+                          layout.num_readonly_storage_buffers, layout.num_readonly_storage_textures,
+                          layout.num_readwrite_storage_buffers, layout.num_readwrite_storage_textures);
+            app_log(logui::level::info, msg);
+
+            brender::retire(renderer, RetireKind::compute_pipeline, dst->compute.sdl_ptr);
+            delete dst->compute.data;
+            dst->compute.data = info.release();
+            dst->compute.sdl_ptr = new_pipe;
+            dst->compute.file.failed_valid = false;
+            return handle;
+        }
+        catch (const soft_error& e)
+        {
+            logui::logf(logui::level::error, "Build failed: %s", e.what());
+            dst->compute.file.failed_dgst = dst->compute.file.dgst;
+            dst->compute.file.failed_valid = true;
+            return handle;
+        }
+    }
+
+    static SDL_GPUShader* create_shader(brender::renderer& renderer, const spirv_info& info, SDL_GPUShaderStage stage)
+    {
+        SDL_GPUShaderCreateInfo ci{};
+        ci.code_size = info.spirv.size() * sizeof(uint32_t);
+        ci.code = reinterpret_cast<const Uint8*>(info.spirv.data());
+        ci.entrypoint = "main";
+        ci.format = SDL_GPU_SHADERFORMAT_SPIRV;
+        ci.stage = stage;
+        ci.num_samplers         = info.reflect.num_samplers;
+        ci.num_storage_textures = info.reflect.num_storage_textures;
+        ci.num_storage_buffers  = info.reflect.num_storage_buffers;
+        ci.num_uniform_buffers  = info.reflect.num_uniform_buffers;
+        return SDL_CreateGPUShader(renderer.device_ptr, &ci);
+    }
+
+    // Plans the post chain in `chain_name` and builds a pipeline per step:
+    // post.vert with the pass's fragment shader, or with a shader generated
+    // from the snippets of fused per-pixel passes. Built once at startup;
+    // any failure leaves the chain empty.
+    void build_post_chain(brender::renderer& renderer, PostChain& chain, manager& shader_manager, const char* chain_name)
+    {
+        chain.device = renderer.device_ptr;
+        SDL_GPUShader* vs = nullptr;
+        try
+        {
+            file chain_file;
+            load_text_file(chain_file, type::pipeline, chain_name);
+            PostChainDesc desc;
+            std::string error;
+            if (!post_chain_load(chain_file.path, desc, &error) || !post_chain_plan(chain, desc, renderer.swap_format, &error))
+                DIE((std::string(chain_name) + ": " + error).c_str());
+
+            file vs_file;
+            load_text_file(vs_file, type::vertex, "post.vert");
+            std::unique_ptr<spirv_info> vs_info = compile_to_spirv(shader_manager, vs_file, shaderc_vertex_shader, shader_manager.opts);
+            vs = create_shader(renderer, *vs_info, SDL_GPU_SHADERSTAGE_VERTEX);
+            if (!vs)
+                DIE("SDL_CreateGPUShader(post.vert) failed");
+
+            PipelineConfig cfg{};
+            cfg.cull = SDL_GPU_CULLMODE_NONE;
+            cfg.front_face = SDL_GPU_FRONTFACE_COUNTER_CLOCKWISE;
+            pipeline_states states = make_pipeline_states(renderer, cfg);
+
+            for (PostStep& step : chain.steps)
+            {
+                const PostPassDesc& first = desc.passes[step.passes[0]];
+                file fs_file;
+                if (first.per_pixel)
+                {
+                    std::vector<std::string> snippets;
+                    for (Uint32 p : step.passes)
+                    {
+                        file snippet;
+                        load_text_file(snippet, type::fragment, desc.passes[p].shader.c_str());
+                        snippets.push_back(snippet.source);
+                        fs_file.name += (fs_file.name.empty() ? "" : "+") + desc.passes[p].name;
+                    }
+                    fs_file.shader_type = type::fragment;
+                    fs_file.source = post_fused_source(snippets);
+                }
+                else
+                    load_text_file(fs_file, type::fragment, first.shader.c_str());
+
+                std::unique_ptr<spirv_info> fs_info = compile_to_spirv(shader_manager, fs_file, shaderc_fragment_shader, shader_manager.opts);
+                if (fs_info->reflect.num_samplers != step.num_inputs)
+                    DIE((fs_file.name + ": samples " + std::to_string(fs_info->reflect.num_samplers) + " textures, the chain gives it " +
+                         std::to_string(step.num_inputs)).c_str());
+                SDL_GPUShader* fs = create_shader(renderer, *fs_info, SDL_GPU_SHADERSTAGE_FRAGMENT);
+                if (!fs)
+                    DIE(("SDL_CreateGPUShader(" + fs_file.name + ") failed").c_str());
+                step.has_params = fs_info->reflect.num_uniform_buffers > 0;
+
+                SDL_GPUColorTargetDescription color = states.color_targets[0];
+                color.format = step.format;
+                SDL_GPUGraphicsPipelineCreateInfo pi{};
+                pi.vertex_shader = vs;
+                pi.fragment_shader = fs;
+                pi.primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST;
+                pi.rasterizer_state = states.rasterizer;
+                pi.depth_stencil_state = states.depth_stencil;
+                pi.multisample_state.sample_count = SDL_GPU_SAMPLECOUNT_1;
+                pi.target_info.color_target_descriptions = &color;
+                pi.target_info.num_color_targets = 1;
+                step.pipeline = SDL_CreateGPUGraphicsPipeline(renderer.device_ptr, &pi);
+                SDL_ReleaseGPUShader(renderer.device_ptr, fs);
+                if (!step.pipeline)
+                    DIE(("SDL_CreateGPUGraphicsPipeline(" + fs_file.name + ") failed").c_str());
+            }
+            SDL_ReleaseGPUShader(renderer.device_ptr, vs);
+
+            SDL_GPUSamplerCreateInfo sci{};
+            sci.min_filter = SDL_GPU_FILTER_LINEAR;
+            sci.mag_filter = SDL_GPU_FILTER_LINEAR;
+            sci.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE;
+            sci.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE;
+            sci.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE;
+            chain.sampler = state_cache_get_sampler(renderer.state_cache, state_cache_sampler(renderer.state_cache, sci));
+
+            char msg[160];
+            std::snprintf(msg, sizeof(msg), "%s: %u passes in %zu draws, %zu targets", chain_name, chain.passes, chain.steps.size(), chain.targets.size());
+            app_log(logui::level::info, msg);
+        }
+        catch (const soft_error& e)
+        {
+            logui::logf(logui::level::error, "Post chain disabled: %s", e.what());
+            if (vs)
+                SDL_ReleaseGPUShader(renderer.device_ptr, vs);
+            post_chain_destroy(chain);
+            chain.steps.clear();
+            chain.targets.clear();
         }
     }
 
+    struct reload_check
+    {
+        file* watched;
+        bool changed;
+        // Set when the file was read and found unchanged despite a new stamp.
+        bool restamp;
+        SDL_Time modified;
+        Uint64 size;
+    };
 
-    static bool should_rebuild(const file& current)
+    static bool should_rebuild(reload_check& check)
     {
+        const file& current = *check.watched;
+        SDL_PathInfo info{};
+        if (!SDL_GetPathInfo(current.path, &info)) return false;
+        if (info.modify_time == current.modified && info.size == current.size) return false;
         std::string text;
         if (!read_file_retry(current.path, text)) return false;
         std::array<uint8_t, BLAKE3_OUT_LEN> now{};
         blake3_digest(text, now);
+        check.restamp = true;
+        check.modified = info.modify_time;
+        check.size = info.size;
         if (now == current.dgst) return false;
         if (current.failed_valid && now == current.failed_dgst) return false;
         return true;
     }
 
+    static void reload_check_job(void* user, Uint32 index)
+    {
+        reload_check& check = static_cast<reload_check*>(user)[index];
+        check.changed = should_rebuild(check);
+    }
+
+    // Stats every watched file as one job each, reading and hashing only the
+    // ones whose stamp moved, then rebuilds the changed programs on this
+    // thread. Returns whether anything was rebuilt.
+    bool reload_changed(brender::renderer& renderer, manager& shader_manager)
+    {
+        ArenaVector<reload_check> checks{ ArenaAllocator<reload_check>(arena_scratch()) };
+        checks.reserve(shader_manager.programs.values.size() * 3 + shader_manager.compute_programs.values.size());
+        for (program& prog : shader_manager.programs.values)
+        {
+            checks.push_back(reload_check{ &prog.pipeline.file, false, false, 0, 0 });
+            checks.push_back(reload_check{ &prog.vertex.file, false, false, 0, 0 });
+            checks.push_back(reload_check{ &prog.fragment.file, false, false, 0, 0 });
+        }
+        for (compute_program& prog : shader_manager.compute_programs.values)
+            checks.push_back(reload_check{ &prog.compute.file, false, false, 0, 0 });
+        jobs::Counter counter;
+        jobs::run(reload_check_job, checks.data(), (Uint32)checks.size(), &counter);
+        jobs::wait(counter);
+        // Touched but identical: stop reading it on every check.
+        for (reload_check& check : checks)
+        {
+            if (check.restamp && !check.changed)
+            {
+                check.watched->modified = check.modified;
+                check.watched->size = check.size;
+            }
+        }
+
+        bool reloaded = false;
+        // Rebuilding in place never adds or removes programs, so the packed
+        // order the checks were made in still holds.
+        for (size_t i = 0; i < shader_manager.programs.values.size(); ++i)
+        {
+            if (checks[i * 3].changed || checks[i * 3 + 1].changed || checks[i * 3 + 2].changed)
+            {
+                const program& prog = shader_manager.programs.values[i];
+                build_program(renderer, shader_manager, prog.pipeline.file.name.c_str(), slot_map_handle_at(shader_manager.programs, i));
+                reloaded = true;
+            }
+        }
+        const size_t compute_base = shader_manager.programs.values.size() * 3;
+        for (size_t i = 0; i < shader_manager.compute_programs.values.size(); ++i)
+        {
+            if (checks[compute_base + i].changed)
+            {
+                const compute_program& prog = shader_manager.compute_programs.values[i];
+                build_compute(renderer, shader_manager, prog.compute.file.name.c_str(), slot_map_handle_at(shader_manager.compute_programs, i));
+                reloaded = true;
+            }
+        }
+        return reloaded;
+    }
+
     void init(manager& shader_manager)
     {
         shader_manager.opts.SetOptimizationLevel(shaderc_optimization_level_performance);
@@ -996,25 +1982,405 @@ namespace shader
 
 }
 
-struct draw_function_data
+// Render thread: the instance records this frame draws from, the
+// interpolated simulation poses when the simulation has produced any and the
+// scene's own records otherwise. Never waits on the simulation: the newest
+// published tick is used, and *changed stays false once a tick has been fully
+// blended in and no newer one exists.
+static const float* current_objects(brender::renderer& renderer, const brender::scene_desc& scene, bool* changed)
 {
-    brender::frame& frame;
-    shader::program& program;
-    SDL_GPUBuffer* vbo;
+    *changed = false;
+    if (!renderer.sim.thread.joinable())
+        return scene.objects;
+    const SimState& state = sim_acquire(renderer.sim);
+    if ((state.tick != renderer.sim_tick || renderer.sim_alpha < 1.0f) && state.curr.size() == (size_t)scene.instance_count * 3)
+    {
+        renderer.sim_alpha = sim_interpolate(renderer.sim, state, SDL_GetTicksNS(), renderer.sim_pose);
+        renderer.sim_tick = state.tick;
+        *changed = true;
+    }
+    return renderer.sim_pose.empty() ? scene.objects : renderer.sim_pose.data();
+}
+
+// Template commands for GPU culling, rebuilt each frame since the triangle's
+// first vertex moves when the pool defragments.
+static bool set_cull_commands(brender::renderer& renderer, const brender::scene_desc& scene, Uint32 first_vertex)
+{
+    if (!scene.mesh)
+    {
+        SDL_GPUIndirectDrawCommand cmd{ 3, 0, first_vertex, 0 };
+        return gpu_cull_set_commands(renderer.gpu_cull, &cmd, 1);
+    }
+    // One command per submesh, as mesh_submit draws them; a mesh with more
+    // than the buffer holds is refused and drawn unculled.
+    ArenaScope scratch(arena_scratch());
+    ArenaVector<SDL_GPUIndexedIndirectDrawCommand> cmds{ ArenaAllocator<SDL_GPUIndexedIndirectDrawCommand>(scratch.arena) };
+    cmds.reserve(scene.mesh->submeshes.size());
+    for (const BMeshSubmesh& sm : scene.mesh->submeshes)
+        cmds.push_back(SDL_GPUIndexedIndirectDrawCommand{ sm.index_count, 0, sm.first_index, sm.vertex_offset, 0 });
+    return gpu_cull_set_indexed_commands(renderer.gpu_cull, cmds.data(), (Uint32)cmds.size());
+}
+
+// Brings the instance data up to date for the scene's cull mode and object
+// source, and returns the cull mode actually used: GPU culling falls back to
+// none without a cull pipeline. *visible is the instance count to draw; for
+// GPU culling it is only the upper bound, the real count never leaves the GPU.
+static brender::cull_mode prepare_instances(brender::renderer& renderer, const brender::scene_desc& scene, brender::object_source source,
+                                            Uint32 first_vertex, Uint32* visible)
+{
+    bool changed = false;
+    const float* objects = current_objects(renderer, scene, &changed);
+    brender::cull_mode mode = scene.cull;
+    if (!objects)
+        mode = brender::cull_mode::none;
+    if (mode == brender::cull_mode::gpu && (!scene.cull_pipeline || !renderer.gpu_cull.commands ||
+                                            scene.instance_count > renderer.gpu_cull.capacity || !set_cull_commands(renderer, scene, first_vertex)))
+        mode = brender::cull_mode::none;
+    const bool storage = source == brender::object_source::storage;
+    if (objects != renderer.uploaded_objects || scene.instance_count != renderer.uploaded_count || mode != renderer.uploaded_cull ||
+        source != renderer.uploaded_source)
+        changed = true;
+
+    // Object records carry their material through culling, so both culling
+    // paths work on packed records when the shader reads the object buffer.
+    const float* records = objects;
+    Uint32 words = 3;
+    if (storage && mode != brender::cull_mode::none)
+    {
+        if (changed)
+            object_pack(objects, scene.instance_count, renderer.object_records);
+        records = reinterpret_cast<const float*>(renderer.object_records.data());
+        words = OBJECT_RECORD_WORDS;
+    }
+
+    const CullView& view = scene.view;
+    const Uint32 stride = words * sizeof(float);
+    *visible = scene.instance_count;
+    switch (mode)
+    {
+    case brender::cull_mode::none:
+        if (changed && objects && storage)
+            object_buffer_write(renderer.object_buffer, renderer.uploads, objects, scene.instance_count);
+        else if (changed && objects)
+            gpu_pool_upload(renderer.geometry, renderer.uploads, scene.instances, objects, scene.instance_count * stride);
+        break;
+    case brender::cull_mode::cpu:
+        *visible = cpu_cull(records, scene.instance_count, words, view, renderer.cull_scratch);
+        if (*visible && storage)
+            object_buffer_upload(renderer.object_buffer, renderer.uploads, renderer.cull_scratch.data(), *visible);
+        else if (*visible)
+            gpu_pool_upload(renderer.geometry, renderer.uploads, scene.instances, renderer.cull_scratch.data(), *visible * stride);
+        break;
+    case brender::cull_mode::gpu:
+        if (changed)
+            gpu_cull_upload_objects(renderer.gpu_cull, renderer.uploads, records, scene.instance_count, words);
+        gpu_cull_dispatch(renderer.gpu_cull, renderer.uploads, renderer.compute_list, scene.cull_pipeline, scene.cull_threads, view);
+        break;
+    }
+    renderer.uploaded_objects = objects;
+    renderer.uploaded_count = scene.instance_count;
+    renderer.uploaded_cull = mode;
+    renderer.uploaded_source = source;
+    return mode;
+}
+
+// Queues the scene for this frame: the mesh when one is loaded, otherwise the
+// triangle, instanced over the instance stream or the object buffer. With GPU
+// culling the instances come from the compacted buffer and the counts from
+// the indirect commands the cull pass writes. *source is the object source
+// actually used; storage falls back to the stream without a validated
+// pipeline or room in the object buffer.
+static brender::cull_mode submit_scene(brender::renderer& renderer, const brender::scene_desc& scene, Uint32* visible,
+                                       brender::object_source* source)
+{
+    *visible = 0;
+    *source = brender::object_source::stream;
+    GpuRange inst;
+    if (!scene.pipeline || scene.instance_count == 0 || !gpu_pool_resolve(renderer.geometry, scene.instances, &inst))
+        return brender::cull_mode::none;
+    GpuRange range{};
+    if (!scene.mesh && !gpu_pool_resolve(renderer.geometry, scene.vertices, &range))
+        return brender::cull_mode::none;
+
+    if (scene.source == brender::object_source::storage && scene.object_pipeline && scene.instance_count <= renderer.object_buffer.capacity)
+        *source = brender::object_source::storage;
+    const bool storage = *source == brender::object_source::storage;
+    Uint32 first_vertex = scene.mesh ? 0 : range.offset / scene.vertex_stride;
+    brender::cull_mode mode = prepare_instances(renderer, scene, *source, first_vertex, visible);
+    if (*visible == 0)
+        return mode;
+
+    DrawItem item;
+    item.pipeline = storage ? scene.object_pipeline : scene.pipeline;
+    item.instance_count = *visible;
+    uniform_bind(scene.uniforms, renderer.draw_list, item);
+    const bool gpu = mode == brender::cull_mode::gpu;
+    if (gpu)
+    {
+        item.indirect = renderer.gpu_cull.commands;
+        item.indirect_offset = gpu_cull_command_offset(renderer.gpu_cull, 0);
+    }
+    if (storage)
+    {
+        item.storage[0] = gpu ? renderer.gpu_cull.visible : renderer.object_buffer.buffer;
+        item.num_storage = 1;
+    }
+    else
+    {
+        item.vertex[0].buffer = gpu ? renderer.gpu_cull.visible : inst.buffer;
+        item.vertex[0].offset = gpu ? 0 : inst.offset;
+        item.num_vertex = 1;
+    }
+    if (scene.mesh)
+    {
+        item.key = draw_key(brender::PASS_SCENE, draw_key_id(scene.pipeline, 12), 0, draw_key_id(scene.mesh, 12), 0);
+        mesh_submit(*scene.mesh, renderer.geometry, item, renderer.draw_list);
+        return mode;
+    }
+
+    item.key = draw_key(brender::PASS_SCENE, draw_key_id(scene.pipeline, 12), 0, draw_key_id(range.buffer, 12), 0);
+    if (item.num_vertex)
+        item.vertex[1] = item.vertex[0];
+    item.vertex[0].buffer = range.buffer;
+    item.vertex[0].offset = 0;
+    item.num_vertex++;
+    item.count = 3;
+    item.first = first_vertex;
+    draw_list_push(renderer.draw_list, item);
+    return mode;
+}
+
+// Main thread: copies what the next frame needs into a snapshot slot and
+// hands it the dispatches and readbacks scheduled since the last capture.
+void capture_frame(brender::renderer& renderer, brender::frame_snapshot& snap, const brender::scene_desc& scene)
+{
+    snap.mode = g_mode;
+    snap.ui.valid = false;
+    if (g_mode == SceneMode::Docked)
+        ui_snapshot_capture(snap.ui, ImGui::GetDrawData());
+    snap.scene = scene;
+    snap.scene_tex = renderer.scene_tex;
+    snap.scene_msaa = renderer.scene_msaa;
+    snap.msaa_color = renderer.msaa_color;
+    snap.msaa = renderer.msaa;
+    snap.scene_w = (Uint32)renderer.scene_w;
+    snap.scene_h = (Uint32)renderer.scene_h;
+    snap.post = renderer.post_enabled;
+    snap.aa = renderer.aa;
+    snap.parallel_recording = renderer.parallel_recording;
+    snap.compute.swap(renderer.compute_pending);
+    renderer.compute_pending.clear();
+    snap.readbacks.swap(renderer.readback_pending);
+    renderer.readback_pending.clear();
+}
+
+// Render side of a frame: draw items from the snapshot, record and submit,
+// then publish the stats the UI shows.
+void render_frame(brender::renderer& renderer, const brender::frame_snapshot& snap)
+{
+    Uint64 t0 = SDL_GetTicksNS();
+    // Gaps longer than this are idle time, not a frame's cost.
+    const Uint64 max_interval_ns = 100000000;
+    Uint64 interval = renderer.last_frame_ns ? t0 - renderer.last_frame_ns : 0;
+    bool same_aa = snap.aa == renderer.last_frame_aa;
+    renderer.last_frame_ns = t0;
+    renderer.last_frame_aa = snap.aa;
+    for (const ComputeDispatch& dispatch : snap.compute)
+        compute_list_push(renderer.compute_list, dispatch);
+    brender::defragment_geometry(renderer);
+    Uint32 visible = 0;
+    brender::object_source source;
+    brender::cull_mode cull = submit_scene(renderer, snap.scene, &visible, &source);
+    Uint64 scene_ns = SDL_GetTicksNS() - t0;
+    texture_stream_update(renderer.texture_streamer, renderer.uploads);
+    brender::draw(renderer, snap);
+    std::lock_guard<std::mutex> lock(renderer.stats_mutex);
+    brender::render_stats& st = renderer.stats;
+    st.draw_list = renderer.draw_list.last_stats;
+    st.compute = renderer.compute_list.last_stats;
+    st.record = renderer.recorder.last_thread_stats;
+    st.frame_ns = SDL_GetTicksNS() - t0;
+    st.scene_ns = scene_ns;
+    st.cull = cull;
+    st.source = source;
+    st.readback = renderer.readback.last_stats;
+    st.post = post_chain_stats(renderer.post);
+    st.arena = arena_stats(arena_scratch());
+    st.visible = visible;
+    st.objects = snap.scene.instance_count;
+    st.frames++;
+    st.frame_ns_total += st.frame_ns;
+    st.scene_ns_total += scene_ns;
+    if (interval && interval < max_interval_ns && same_aa)
+    {
+        st.aa_frames[snap.aa]++;
+        st.aa_interval_ns[snap.aa] += interval;
+    }
+}
+
+// Owns command buffers, uploads, the geometry pool and presentation once
+// started; the main thread only talks to it through the render queue.
+void render_thread_main(brender::renderer* renderer)
+{
+    Uint32 slot;
+    while (render_queue_pop(renderer->render_queue, &slot))
+    {
+        render_frame(*renderer, renderer->snapshots[slot]);
+        render_queue_complete(renderer->render_queue, renderer->device_ptr, slot);
+        arena_reset(arena_scratch());
+    }
+}
+
+// The object-buffer variant is only drawn with when reflection shows its
+// vertex stage takes exactly the one storage buffer submit_scene binds.
+static bool reads_object_buffer(const shader::program& program)
+{
+    const shader::spirv_info* vs = program.vertex.data;
+    return vs && vs->reflect.num_storage_buffers == 1 && vs->reflect.num_storage_textures == 0;
+}
+
+struct view_params
+{
+    UniformParam pan;
+    UniformParam zoom;
 };
 
-void draw_function(const void* data_ptr)
+// Main thread: rebuilds the scene programs when the selected anti-aliasing
+// mode wants another sample count; queued frames keep the old pipelines and
+// targets until they are retired.
+static void apply_aa(brender::renderer& renderer, shader::manager& shader_manager)
 {
-    const auto& args = *static_cast<const draw_function_data*>(data_ptr);
-    SDL_GPUGraphicsPipeline* pipe = shader::as_pipeline(args.program);
-    if (!pipe)
+    if (renderer.aa == renderer.aa_applied)
         return;
-    SDL_BindGPUGraphicsPipeline(args.frame.render_pass_ptr, pipe);
-    SDL_GPUBufferBinding vertex_binding;
-    vertex_binding.buffer = args.vbo;
-    vertex_binding.offset = 0;
-    SDL_BindGPUVertexBuffers(args.frame.render_pass_ptr, 0, &vertex_binding, 1);
-    SDL_DrawGPUPrimitives(args.frame.render_pass_ptr, 3, 1, 0, 0);
+    renderer.aa_applied = renderer.aa;
+    Uint32 samples = brender::AA_OPTIONS[renderer.aa].samples;
+    if (samples == renderer.msaa_request)
+        return;
+    renderer.msaa_request = samples;
+    for (size_t i = 0; i < shader_manager.programs.values.size(); i++)
+        shader::build_program(renderer, shader_manager, shader_manager.programs.values[i].pipeline.file.name.c_str(),
+                              slot_map_handle_at(shader_manager.programs, i));
+}
+
+// Main thread: writes the view into the program's View block and derives the
+// culling rectangle from it: ndc = p * zoom + pan, so the view covers
+// [(-1 - pan) / zoom, (1 - pan) / zoom] in instance space. The params are
+// looked up again only after a reload changed the layout. The TAA jitter
+// moves the image, not the culling rectangle.
+static void update_view(brender::renderer& renderer, shader::program& program, view_params& params, brender::scene_desc& scene)
+{
+    float jitter[2];
+    brender::aa_jitter(renderer, jitter);
+    if (uniform_stale(program.uniforms, params.pan))
+    {
+        params.pan = uniform_find(program.uniforms, "View.pan");
+        params.zoom = uniform_find(program.uniforms, "View.zoom");
+    }
+    float zoom = SDL_max(renderer.view_zoom, 0.01f);
+    uniform_set_float2(program.uniforms, params.pan, renderer.view_pan[0] + jitter[0], renderer.view_pan[1] + jitter[1]);
+    uniform_set_float(program.uniforms, params.zoom, zoom);
+    scene.uniforms = program.uniforms;
+    for (int i = 0; i < 2; i++)
+    {
+        scene.view.min[i] = (-1.0f - renderer.view_pan[i]) / zoom;
+        scene.view.max[i] = (1.0f - renderer.view_pan[i]) / zoom;
+    }
+}
+
+// Instances on a square grid covering [-extent, extent]. A single instance
+// fills the view like the plain triangle.
+static std::vector<float> grid_instances(Uint32 count, float extent)
+{
+    std::vector<float> data((size_t)count * 3);
+    Uint32 side = 1;
+    while (side * side < count) side++;
+    float cell = 2.0f * extent / (float)side;
+    for (Uint32 i = 0; i < count; ++i)
+    {
+        data[i * 3 + 0] = side == 1 ? 0.0f : -extent + cell * ((float)(i % side) + 0.5f);
+        data[i * 3 + 1] = side == 1 ? 0.0f : -extent + cell * ((float)(i / side) + 0.5f);
+        data[i * 3 + 2] = 1.0f / (float)side;
+    }
+    return data;
+}
+
+// --bench N: renders N frames for each object count and cull mode, then logs
+// the render thread's CPU time per frame and quits. The grid spans twice the
+// view in each axis, so about a quarter of the objects survive culling.
+struct bench_state
+{
+    static constexpr Uint32 counts[3] = { 10000, 100000, 1000000 };
+    static constexpr Uint32 warmup = 16;
+    Uint32 frames = 0;
+    // Phases go through the anti-aliasing modes on the normal scene instead
+    // of object counts and culling modes.
+    bool aa = false;
+    Uint32 phase = 0;
+    Uint32 frame = 0;
+    std::vector<float> data[3];
+    brender::render_stats start;
+};
+
+static brender::render_stats stats_copy(brender::renderer& renderer)
+{
+    std::lock_guard<std::mutex> lock(renderer.stats_mutex);
+    return renderer.stats;
+}
+
+static void bench_begin_phase(bench_state& bench, brender::renderer& renderer, brender::scene_desc& scene)
+{
+    bench.frame = 0;
+    if (bench.aa)
+    {
+        renderer.aa = bench.phase;
+        return;
+    }
+    Uint32 c = bench.phase / 3;
+    scene.objects = bench.data[c].data();
+    scene.instance_count = bench_state::counts[c];
+    renderer.cull = (brender::cull_mode)(bench.phase % 3);
+    bench.frame = 0;
+}
+
+// Called once per published frame; returns false when the run is over.
+static bool bench_step(bench_state& bench, brender::renderer& renderer, brender::scene_desc& scene)
+{
+    bench.frame++;
+    if (bench.frame == bench_state::warmup)
+        bench.start = stats_copy(renderer);
+    if (bench.frame < bench_state::warmup + bench.frames)
+        return true;
+
+    brender::render_stats end = stats_copy(renderer);
+    Uint64 frames = SDL_max(end.frames - bench.start.frames, (Uint64)1);
+    const char* modes[] = { "none", "cpu", "gpu" };
+    char msg[192];
+    if (bench.aa)
+    {
+        Uint32 a = bench.phase;
+        Uint64 measured = SDL_max(end.aa_frames[a] - bench.start.aa_frames[a], (Uint64)1);
+        std::snprintf(msg, sizeof(msg), "bench aa %-5s: frame interval %.3f ms, render thread CPU %.3f ms (%llu frames)", brender::AA_OPTIONS[a].key,
+                      (double)(end.aa_interval_ns[a] - bench.start.aa_interval_ns[a]) / 1e6 / (double)measured,
+                      (double)(end.frame_ns_total - bench.start.frame_ns_total) / 1e6 / (double)frames, (unsigned long long)measured);
+        app_log(logui::level::info, msg);
+        std::printf("%s\n", msg);
+        if (++bench.phase == brender::AA_COUNT)
+            return false;
+        bench_begin_phase(bench, renderer, scene);
+        return true;
+    }
+    std::snprintf(msg, sizeof(msg), "bench %7u objects, cull %s, %s: scene %.3f ms, frame %.3f ms (render thread CPU, %llu frames)",
+                  scene.instance_count, modes[(int)renderer.cull], end.source == brender::object_source::storage ? "storage" : "stream",
+                  (double)(end.scene_ns_total - bench.start.scene_ns_total) / 1e6 / (double)frames,
+                  (double)(end.frame_ns_total - bench.start.frame_ns_total) / 1e6 / (double)frames,
+                  (unsigned long long)frames);
+    app_log(logui::level::info, msg);
+    std::printf("%s\n", msg);
+
+    if (++bench.phase == 9)
+        return false;
+    bench_begin_phase(bench, renderer, scene);
+    return true;
 }
 
 static SDL_HitTestResult SDLCALL window_hit_test(SDL_Window* win, const SDL_Point* pt, void* /*data*/)
@@ -1047,75 +2413,283 @@ static SDL_HitTestResult SDLCALL window_hit_test(SDL_Window* win, const SDL_Poin
 
 int main(int argc, char* argv[])
 {
+    heap_count_install();
+    const char* log_path = nullptr;
+    const char* mesh_path = nullptr;
+    const char* texture_dir = nullptr;
+    const char* dump_path = nullptr;
+    const char* post_chain = "post.chain.json";
+    const char* aa_key = nullptr;
+    bool post = false;
+    int texture_budget_mb = -1;
+    Uint32 instance_count = 1;
+    int record_threads = -1;
+    int job_workers = -1;
+    Uint32 sim_hz = 60;
+    bool simulate = false;
+    brender::cull_mode cull = brender::cull_mode::none;
+    brender::object_source source = brender::object_source::stream;
+    bench_state bench;
+#ifdef SDL_PLATFORM_APPLE
+    // SDL only supports swapchain acquisition on the window's thread there.
+    bool render_thread = false;
+#else
+    bool render_thread = true;
+#endif
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--log")
+            log_path = argv[i + 1];
+        if (std::string(argv[i]) == "--mesh")
+            mesh_path = argv[i + 1];
+        if (std::string(argv[i]) == "--textures")
+            texture_dir = argv[i + 1];
+        if (std::string(argv[i]) == "--dump")
+            dump_path = argv[i + 1];
+        if (std::string(argv[i]) == "--post")
+        {
+            post_chain = argv[i + 1];
+            post = true;
+        }
+        if (std::string(argv[i]) == "--texture-budget")
+            texture_budget_mb = SDL_max(1, SDL_atoi(argv[i + 1]));
+        if (std::string(argv[i]) == "--instances")
+            instance_count = (Uint32)SDL_max(1, SDL_atoi(argv[i + 1]));
+        if (std::string(argv[i]) == "--record-threads")
+            record_threads = SDL_max(0, SDL_atoi(argv[i + 1]));
+        if (std::string(argv[i]) == "--workers")
+            job_workers = SDL_max(0, SDL_atoi(argv[i + 1]));
+        if (std::string(argv[i]) == "--render-thread")
+            render_thread = SDL_atoi(argv[i + 1]) != 0;
+        if (std::string(argv[i]) == "--sim-hz")
+            sim_hz = (Uint32)SDL_clamp(SDL_atoi(argv[i + 1]), 1, 1000);
+        if (std::string(argv[i]) == "--simulate")
+            simulate = SDL_atoi(argv[i + 1]) != 0;
+        if (std::string(argv[i]) == "--cull")
+        {
+            std::string m = argv[i + 1];
+            cull = m == "gpu" ? brender::cull_mode::gpu : m == "cpu" ? brender::cull_mode::cpu : brender::cull_mode::none;
+        }
+        if (std::string(argv[i]) == "--object-data")
+            source = std::string(argv[i + 1]) == "storage" ? brender::object_source::storage : brender::object_source::stream;
+        if (std::string(argv[i]) == "--bench")
+            bench.frames = (Uint32)SDL_max(0, SDL_atoi(argv[i + 1]));
+        if (std::string(argv[i]) == "--bench-aa")
+        {
+            bench.frames = (Uint32)SDL_max(0, SDL_atoi(argv[i + 1]));
+            bench.aa = true;
+        }
+        if (std::string(argv[i]) == "--aa")
+            aa_key = argv[i + 1];
+    }
+    if (logui::init(log_path) == false)
+        std::fprintf(stderr, "cannot open log file %s, logging to stderr\n", log_path);
+
     brender::renderer renderer;
     brender::create_info create_info;
     brender::xinit(renderer, create_info);
 
     SDL_SetWindowMinimumSize(renderer.window_ptr, 640, 360);
 
-    float vertices[] =
+    // --dump PATH writes every rendered frame: PATH.y4m as one stream, any
+    // other PATH as the prefix of a numbered PPM sequence.
+    if (dump_path)
+    {
+        frame_dump_start(renderer.frame_dump, dump_path, 60);
+        app_log(logui::level::info, arena_printf(arena_scratch(), "dumping frames to %s", dump_path));
+    }
+
+    // --textures DIR streams every .bmp, .dds and .ktx2 in DIR into the
+    // Textures window.
+    if (texture_budget_mb > 0)
+        renderer.texture_streamer.budget_bytes.store((Uint64)texture_budget_mb << 20);
+    if (texture_dir)
+    {
+        for (const char* pattern : { "*.bmp", "*.dds", "*.ktx2" })
+        {
+            int count = 0;
+            char** names = SDL_GlobDirectory(texture_dir, pattern, SDL_GLOB_CASEINSENSITIVE, &count);
+            for (int i = 0; i < count; i++)
+                renderer.streamed_textures.push_back(texture_stream_request(renderer.texture_streamer, (std::string(texture_dir) + "/" + names[i]).c_str()));
+            SDL_free(names);
+        }
+        if (renderer.streamed_textures.empty())
+            app_log(logui::level::warn, arena_printf(arena_scratch(), "no .bmp, .dds or .ktx2 files in %s", texture_dir));
+    }
+
+    // One job worker per spare core unless --workers says otherwise.
+    if (job_workers < 0)
+        job_workers = SDL_clamp(SDL_GetNumLogicalCPUCores() - 1, 1, 15);
+    jobs::init((Uint32)job_workers);
+
+    // --record-threads N turns parallel recording on with up to N helper jobs
+    // besides the main thread; otherwise it starts off using every worker.
+    renderer.parallel_recording = record_threads >= 0;
+    if (record_threads < 0)
+        record_threads = job_workers;
+    parallel_recorder_init(renderer.recorder, renderer.device_ptr, (Uint32)record_threads);
+
+    // half2 position + ubyte4_norm color, see the manual layout in
+    // triangle.pipeline.json: 8 bytes per vertex instead of 20.
+    struct packed_vertex
     {
-        -0.5f, -0.5f, 1.0f, 0.2f, 0.2f,
-         0.5f, -0.5f, 0.2f, 1.0f, 0.2f,
-         0.0f,  0.5f, 0.2f, 0.2f, 1.0f
+        Uint16 pos[2];
+        Uint8 col[4];
+    };
+    packed_vertex vertices[] =
+    {
+        { { half_from_float(-0.5f), half_from_float(-0.5f) }, { 255,  51,  51, 255 } },
+        { { half_from_float( 0.5f), half_from_float(-0.5f) }, {  51, 255,  51, 255 } },
+        { { half_from_float( 0.0f), half_from_float( 0.5f) }, {  51,  51, 255, 255 } }
     };
 
-    SDL_GPUBufferCreateInfo vertex_buffer_info;
-    SDL_zero(vertex_buffer_info);
-    vertex_buffer_info.usage = SDL_GPU_BUFFERUSAGE_VERTEX;
-    vertex_buffer_info.size = sizeof(vertices);
-    SDL_GPUBuffer* vbo = SDL_CreateGPUBuffer(renderer.device_ptr, &vertex_buffer_info);
-    if (!vbo)
+    const Uint32 vertex_stride = sizeof(packed_vertex);
+    GpuAlloc triangle_vertices = gpu_pool_alloc(renderer.geometry, sizeof(vertices), vertex_stride);
+    if (!gpu_pool_upload(renderer.geometry, renderer.uploads, triangle_vertices, vertices, sizeof(vertices)))
         return 1;
 
-    SDL_GPUTransferBufferCreateInfo transfer_info;
-    SDL_zero(transfer_info);
-    transfer_info.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
-    transfer_info.size = sizeof(vertices);
-    SDL_GPUTransferBuffer* tbo = SDL_CreateGPUTransferBuffer(renderer.device_ptr, &transfer_info);
-    if (!tbo)
+    // All instances are drawn with a single instanced draw call. A bench run
+    // sizes the buffers for its largest object count up front.
+    std::vector<float> instance_data = grid_instances(instance_count, 1.0f);
+    Uint32 instance_capacity = instance_count;
+    if (bench.frames && !bench.aa)
+    {
+        for (Uint32 c = 0; c < 3; c++)
+            bench.data[c] = grid_instances(bench_state::counts[c], 2.0f);
+        instance_capacity = SDL_max(instance_capacity, bench_state::counts[2]);
+    }
+    brender::instance_buffer triangle_instances;
+    if (!brender::instance_buffer_create(renderer, triangle_instances, sizeof(float) * 3, instance_capacity))
         return 1;
-
-    void* mapped_ptr = SDL_MapGPUTransferBuffer(renderer.device_ptr, tbo, false);
-    if (!mapped_ptr)
+    if (!brender::instance_buffer_update(renderer, triangle_instances, instance_data.data(), instance_count))
         return 1;
-    SDL_memcpy(mapped_ptr, vertices, sizeof(vertices));
-    SDL_UnmapGPUTransferBuffer(renderer.device_ptr, tbo);
-
-    SDL_GPUCommandBuffer* copy_commands = SDL_AcquireGPUCommandBuffer(renderer.device_ptr);
-    SDL_GPUCopyPass* copy_pass = SDL_BeginGPUCopyPass(copy_commands);
-    SDL_GPUTransferBufferLocation source_location;
-    source_location.transfer_buffer = tbo;
-    source_location.offset = 0;
-    SDL_GPUBufferRegion destination_region;
-    destination_region.buffer = vbo;
-    destination_region.offset = 0;
-    destination_region.size = sizeof(vertices);
-    SDL_UploadToGPUBuffer(copy_pass, &source_location, &destination_region, true);
-    SDL_EndGPUCopyPass(copy_pass);
-    SDL_SubmitGPUCommandBuffer(copy_commands);
-
-    SDL_GPUBufferBinding vertex_binding;
-    vertex_binding.buffer = vbo;
-    vertex_binding.offset = 0;
-
-    static logui::ring console(2048);
-    g_console_ptr = &console;
+
+    static logui::Console console(2048);
 
     shader::manager shader_manager;
     shader::init(shader_manager);
 
-    shader::program& triangle_program = shader_manager.programs.emplace_back();
-    shader::build_program(renderer, shader_manager, "triangle.pipeline.json", &triangle_program);
+    Mesh mesh;
+    if (mesh_path && !mesh_load(mesh, renderer.geometry, renderer.uploads, mesh_path))
+    {
+        app_log(logui::level::error, arena_printf(arena_scratch(), "cannot load mesh %s", mesh_path));
+        mesh_path = nullptr;
+    }
+    // Programs are held by handle and looked up each frame; the manager may
+    // grow or drop programs without invalidating them.
+    shader::program_handle triangle_program =
+        shader::build_program(renderer, shader_manager, mesh_path ? "mesh.pipeline.json" : "triangle.pipeline.json");
+    shader::program_handle objects_program =
+        shader::build_program(renderer, shader_manager, mesh_path ? "mesh_objects.pipeline.json" : "triangle_objects.pipeline.json");
+
+    brender::scene_desc scene;
+    scene.vertices = triangle_vertices;
+    scene.vertex_stride = vertex_stride;
+    scene.instances = triangle_instances.alloc;
+    scene.instance_count = triangle_instances.count;
+    scene.mesh = mesh_path ? &mesh : nullptr;
+    scene.objects = instance_data.data();
+
+    // Culling bounds: a circle per instance, the model's xy extent times the
+    // instance scale. The triangle spans [-0.5, 0.5].
+    scene.view.bound_radius = 0.7072f;
+    if (scene.mesh)
+    {
+        scene.view.bound_radius = 0.0f;
+        for (const BMeshSubmesh& sm : mesh.submeshes)
+        {
+            float x = SDL_max(SDL_fabsf(sm.bounds_min[0]), SDL_fabsf(sm.bounds_max[0]));
+            float y = SDL_max(SDL_fabsf(sm.bounds_min[1]), SDL_fabsf(sm.bounds_max[1]));
+            scene.view.bound_radius = SDL_max(scene.view.bound_radius, SDL_sqrtf(x * x + y * y));
+        }
+    }
+    shader::compute_handle cull_program = shader::build_compute(renderer, shader_manager, "cull.comp");
+    Uint32 cull_commands = scene.mesh ? (Uint32)SDL_max(mesh.submeshes.size(), (size_t)1) : 1;
+    if (!gpu_cull_init(renderer.gpu_cull, renderer.device_ptr, instance_capacity, cull_commands))
+        app_log(logui::level::warn, "gpu_cull_init() failed, GPU culling unavailable");
+    if (!object_buffer_init(renderer.object_buffer, renderer.device_ptr, instance_capacity))
+        app_log(logui::level::warn, "object_buffer_init() failed, storage object data unavailable");
+    renderer.cull = cull;
+    renderer.source = source;
+    // --post NAME runs the chain file NAME from the shader directory from
+    // the start; the default chain is built either way for the checkbox.
+    shader::build_post_chain(renderer, renderer.post, shader_manager, post_chain);
+    shader::build_post_chain(renderer, renderer.fxaa, shader_manager, "fxaa.chain.json");
+    shader::build_post_chain(renderer, renderer.taa, shader_manager, "taa.chain.json");
+    renderer.post_enabled = post && !renderer.post.steps.empty();
+
+    // Anti-aliasing starts as the pipeline JSON's MSAA unless --aa names a
+    // mode (off, msaa2, msaa4, msaa8, fxaa, taa).
+    renderer.aa_applied = brender::find_aa(nullptr, 1u << (Uint32)renderer.msaa);
+    renderer.msaa_request = brender::AA_OPTIONS[renderer.aa_applied].samples;
+    renderer.aa = brender::find_aa(aa_key, brender::AA_OPTIONS[renderer.aa_applied].samples);
+    if (aa_key && SDL_strcasecmp(brender::AA_OPTIONS[renderer.aa].key, aa_key) != 0)
+        app_log(logui::level::warn, arena_printf(arena_scratch(), "unknown --aa mode %s", aa_key));
+    apply_aa(renderer, shader_manager);
+    // The AA bench runs uncapped where it can, so vsync does not hide the
+    // differences between modes.
+    if (bench.aa)
+    {
+        for (SDL_GPUPresentMode mode : { SDL_GPU_PRESENTMODE_IMMEDIATE, SDL_GPU_PRESENTMODE_MAILBOX })
+        {
+            if (SDL_WindowSupportsGPUPresentMode(renderer.device_ptr, renderer.window_ptr, mode) &&
+                SDL_SetGPUSwapchainParameters(renderer.device_ptr, renderer.window_ptr, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, mode))
+                break;
+        }
+    }
+    view_params view_uniforms[2];
 
-    struct draw_data_pack { brender::frame& frame; shader::program& program; SDL_GPUBuffer* vbo; } draw_data{ renderer.frame, triangle_program, vbo };
+    // The simulation starts paused so an untouched window can still go idle;
+    // --simulate 1 or the Run checkbox sets it going. Bench runs swap the
+    // object set under it, so they go without.
+    if (!bench.frames)
+    {
+        sim_start(renderer.sim, instance_data.data(), instance_count, sim_hz);
+        sim_set_running(renderer.sim, simulate);
+    }
+    else
+        bench_begin_phase(bench, renderer, scene);
+
+    // Three slots: one rendering, one queued, one being filled. From here on
+    // uploads, the geometry pool and command buffers belong to the render
+    // thread; without it the main thread renders each snapshot inline.
+    render_queue_init(renderer.render_queue, 3);
+    renderer.snapshots.resize(3);
+    if (render_thread)
+        renderer.render_thread = std::thread(render_thread_main, &renderer);
+
+    // Idle mode: with no input, no shader reload, nothing animating and an
+    // unchanged UI hash, the loop blocks in SDL_WaitEventTimeout and submits
+    // nothing. The timeout bounds how late tooltips and reloads show up.
+    const Sint32 idle_wait_ms = 250;
+    const Uint64 reload_check_ms = 250;
+    Uint64 next_reload_check = 0;
+    Uint32 last_ui_hash = 0;
+    int redraw_frames = 2;
+    bool idle = false;
 
     int running = 1;
     while (running)
     {
+        // Nothing allocated from scratch outlives the iteration; this also
+        // covers frames rendered inline.
+        arena_reset(arena_scratch());
+        {
+            // Counts every thread, so a frame's figure includes whatever the
+            // render thread and jobs allocated meanwhile.
+            Uint64 heap = heap_count();
+            if (!idle)
+                renderer.heap_last_frame = heap - renderer.heap_mark;
+            renderer.heap_mark = heap;
+        }
+        if (idle)
+            SDL_WaitEventTimeout(nullptr, idle_wait_ms);
+
+        bool had_events = false;
         SDL_Event event;
         while (SDL_PollEvent(&event))
         {
+            had_events = true;
             ImGui_ImplSDL3_ProcessEvent(&event);
             if (event.type == SDL_EVENT_QUIT) running = 0;
             if (event.type == SDL_EVENT_WINDOW_CLOSE_REQUESTED) running = 0;
@@ -1140,33 +2714,113 @@ int main(int argc, char* argv[])
             }
         }
 
-        for (shader::program& prog : shader_manager.programs)
+        bool reloaded = false;
+        Uint64 now = SDL_GetTicks();
+        if (now >= next_reload_check)
         {
-            bool pipeline_changed = shader::should_rebuild(prog.pipeline.file);
-            bool vertex_changed   = shader::should_rebuild(prog.vertex.file);
-            bool fragment_changed = shader::should_rebuild(prog.fragment.file);
-            if (pipeline_changed || vertex_changed || fragment_changed)
-                shader::build_program(renderer, shader_manager, prog.pipeline.file.name.c_str(), &prog);
+            next_reload_check = now + reload_check_ms;
+            reloaded = shader::reload_changed(renderer, shader_manager);
         }
+        jobs::pump_main();
+
+        // ImGui may need one more frame to settle after input (hover, layout).
+        TextureStreamStats streaming = texture_stream_stats(renderer.texture_streamer);
+        renderer.animating = renderer.sim.running.load() || bench.frames || frame_dump_active(renderer.frame_dump) || streaming.queued || streaming.decoding || streaming.promotions;
+        // TAA needs a few more to converge on the jittered samples.
+        if (had_events || reloaded || renderer.animating)
+            redraw_frames = brender::AA_OPTIONS[renderer.aa].post == brender::aa_post::taa ? 8 : 2;
 
-        brender::draw(renderer, &draw_function, console, &draw_data);
+        if (SDL_GetWindowFlags(renderer.window_ptr) & (SDL_WINDOW_MINIMIZED | SDL_WINDOW_OCCLUDED))
+        {
+            idle = true;
+            continue;
+        }
+
+        Uint32 ui_hash = brender::build_ui(renderer, console);
+        if (ui_hash != last_ui_hash && redraw_frames == 0)
+            redraw_frames = 1;
+        last_ui_hash = ui_hash;
+
+        idle = redraw_frames == 0;
+        if (idle)
+            continue;
+        redraw_frames--;
+        apply_aa(renderer, shader_manager);
+        shader::program& triangle = *shader::get(shader_manager, triangle_program);
+        shader::program& objects = *shader::get(shader_manager, objects_program);
+        const shader::compute_program& culling = *shader::get(shader_manager, cull_program);
+        scene.pipeline = shader::as_pipeline(triangle);
+        scene.cull = renderer.cull;
+        scene.source = renderer.source;
+        scene.object_pipeline = reads_object_buffer(objects) ? shader::as_pipeline(objects) : nullptr;
+        if (scene.source == brender::object_source::storage && scene.object_pipeline)
+            update_view(renderer, objects, view_uniforms[1], scene);
+        else
+            update_view(renderer, triangle, view_uniforms[0], scene);
+        scene.cull_pipeline = shader::as_compute(culling);
+        scene.cull_threads = culling.compute.data ? culling.compute.data->compute.threadcount_x : 64;
+        brender::schedule_frame_readbacks(renderer);
+        Uint32 slot = render_queue_acquire(renderer.render_queue);
+        capture_frame(renderer, renderer.snapshots[slot], scene);
+        render_queue_publish(renderer.render_queue, slot);
+        if (!renderer.render_thread.joinable() && render_queue_pop(renderer.render_queue, &slot))
+        {
+            render_frame(renderer, renderer.snapshots[slot]);
+            render_queue_complete(renderer.render_queue, renderer.device_ptr, slot);
+        }
+        if (bench.frames && !bench_step(bench, renderer, scene))
+            running = 0;
     }
 
-    brender::imgui_backend_shutdown();
+    render_queue_close(renderer.render_queue);
+    if (renderer.render_thread.joinable())
+        renderer.render_thread.join();
+    sim_stop(renderer.sim);
+    SDL_WaitForGPUIdle(renderer.device_ptr);
+    // Everything has completed; deliver the last frames' readbacks.
+    readback_ring_poll(renderer.readback, renderer.uploads);
+    readback_ring_destroy(renderer.readback);
+    if (frame_dump_active(renderer.frame_dump))
+    {
+        frame_dump_stop(renderer.frame_dump);
+        FrameDumpStats d = frame_dump_stats(renderer.frame_dump);
+        app_log(logui::level::info, arena_printf(arena_scratch(), "frame dump: %llu frames written, %llu dropped", (unsigned long long)d.written,
+                                                 (unsigned long long)d.dropped));
+    }
+    render_queue_drain(renderer.render_queue, renderer.device_ptr);
+    post_chain_destroy(renderer.post);
+    post_chain_destroy(renderer.fxaa);
+    post_chain_destroy(renderer.taa);
+    gpu_cull_destroy(renderer.gpu_cull);
+    object_buffer_destroy(renderer.object_buffer);
+    texture_stream_destroy(renderer.texture_streamer);
+    for (brender::frame_snapshot& snap : renderer.snapshots)
+        ui_snapshot_destroy(snap.ui);
+
+    brender::imgui_backend_shutdown(renderer);
     ImGui::DestroyContext();
-
-    shader::destroy_program(renderer, triangle_program);
-    SDL_ReleaseGPUTransferBuffer(renderer.device_ptr, tbo);
-    SDL_ReleaseGPUBuffer(renderer.device_ptr, vbo);
+    parallel_recorder_destroy(renderer.recorder);
+    jobs::shutdown();
+
+    for (shader::program& prog : shader_manager.programs.values)
+        shader::destroy_program(renderer, prog);
+    for (shader::compute_program& prog : shader_manager.compute_programs.values)
+        shader::destroy_compute(renderer, prog);
+    mesh_destroy(mesh, renderer.geometry);
+    brender::instance_buffer_destroy(renderer, triangle_instances);
+    gpu_pool_free(renderer.geometry, triangle_vertices);
+    gpu_pool_destroy(renderer.geometry);
+    upload_ring_destroy(renderer.uploads);
     if (renderer.msaa_color) SDL_ReleaseGPUTexture(renderer.device_ptr, renderer.msaa_color);
     if (renderer.scene_msaa) SDL_ReleaseGPUTexture(renderer.device_ptr, renderer.scene_msaa);
     if (renderer.scene_tex) SDL_ReleaseGPUTexture(renderer.device_ptr, renderer.scene_tex);
-    if (renderer.scene_sampler) SDL_ReleaseGPUSampler(renderer.device_ptr, renderer.scene_sampler);
+    state_cache_destroy(renderer.state_cache);
 
     SDL_ReleaseWindowFromGPUDevice(renderer.device_ptr, renderer.window_ptr);
     SDL_DestroyWindow(renderer.window_ptr);
     SDL_DestroyGPUDevice(renderer.device_ptr);
     SDL_Quit();
+    logui::shutdown();
     return 0;
 }
 
@@ -0,0 +1,37 @@
+#include "mapped_file.h"
+#include <SDL3/SDL.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool map_file(const char* path, MappedFile& out) {
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return false; }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    out.data = (const Uint8*)p;
+    out.size = (size_t)st.st_size;
+    return true;
+#else
+    out.data = (const Uint8*)SDL_LoadFile(path, &out.size);
+    return out.data != nullptr;
+#endif
+}
+
+void unmap_file(MappedFile& f) {
+    if (!f.data) return;
+#ifndef _WIN32
+    munmap((void*)f.data, f.size);
+#else
+    SDL_free((void*)f.data);
+#endif
+    f.data = nullptr;
+    f.size = 0;
+}
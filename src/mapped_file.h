@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <SDL3/SDL.h>
+
+// Read-only view of a whole file: mmap where available, a loaded copy
+// elsewhere.
+struct MappedFile {
+    const Uint8* data = nullptr;
+    size_t size = 0;
+};
+
+bool map_file(const char* path, MappedFile& out);
+void unmap_file(MappedFile& f);
+
+inline bool in_file(const MappedFile& f, Uint64 offset, Uint64 size) {
+    return offset <= f.size && size <= f.size - offset;
+}
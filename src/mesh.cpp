@@ -0,0 +1,96 @@
+#include "mesh.h"
+#include "mapped_file.h"
+#include "upload_ring.h"
+#include <SDL3/SDL.h>
+
+bool mesh_load(Mesh& out, GpuBufferPool& pool, UploadRing& uploads, const char* path) {
+    MappedFile f;
+    if (!map_file(path, f)) return false;
+    BMeshHeader h;
+    bool ok = f.size >= sizeof(h);
+    if (ok) {
+        SDL_memcpy(&h, f.data, sizeof(h));
+        ok = h.magic == BMESH_MAGIC && h.version == BMESH_VERSION && h.file_size == f.size &&
+             (h.index_size == 2 || h.index_size == 4) && h.stream_count > 0 && h.index_count > 0 &&
+             in_file(f, h.streams_offset, (Uint64)h.stream_count * sizeof(BMeshStream)) &&
+             in_file(f, h.submeshes_offset, (Uint64)h.submesh_count * sizeof(BMeshSubmesh)) &&
+             in_file(f, h.indices_offset, (Uint64)h.index_count * h.index_size);
+    }
+    if (!ok) {
+        unmap_file(f);
+        return false;
+    }
+
+    mesh_destroy(out, pool);
+    out.vertex_count = h.vertex_count;
+    out.index_count = h.index_count;
+    out.index_size = h.index_size == 2 ? SDL_GPU_INDEXELEMENTSIZE_16BIT : SDL_GPU_INDEXELEMENTSIZE_32BIT;
+    out.submeshes.resize(h.submesh_count);
+    if (h.submesh_count) SDL_memcpy(out.submeshes.data(), f.data + h.submeshes_offset, h.submesh_count * sizeof(BMeshSubmesh));
+    if (out.submeshes.empty()) {
+        BMeshSubmesh whole{};
+        whole.index_count = h.index_count;
+        out.submeshes.push_back(whole);
+    }
+
+    for (Uint32 i = 0; i < h.stream_count && ok; i++) {
+        BMeshStream s;
+        SDL_memcpy(&s, f.data + h.streams_offset + i * sizeof(BMeshStream), sizeof(s));
+        ok = s.stride > 0 && s.size == (Uint64)s.stride * h.vertex_count && in_file(f, s.offset, s.size);
+        if (!ok) break;
+        GpuAlloc a = gpu_pool_alloc(pool, (Uint32)s.size, s.stride);
+        ok = gpu_pool_upload(pool, uploads, a, f.data + s.offset, (Uint32)s.size);
+        out.streams.push_back(a);
+        out.strides.push_back(s.stride);
+    }
+    if (ok) {
+        Uint32 isize = h.index_count * h.index_size;
+        out.indices = gpu_pool_alloc(pool, isize, h.index_size);
+        ok = gpu_pool_upload(pool, uploads, out.indices, f.data + h.indices_offset, isize);
+    }
+    for (const auto& sm : out.submeshes) {
+        if ((Uint64)sm.first_index + sm.index_count > h.index_count) ok = false;
+        if (sm.vertex_offset < 0 || (Uint32)sm.vertex_offset >= h.vertex_count) ok = false;
+    }
+
+    unmap_file(f);
+    if (!ok) mesh_destroy(out, pool);
+    return ok;
+}
+
+void mesh_destroy(Mesh& mesh, GpuBufferPool& pool) {
+    for (GpuAlloc a : mesh.streams) gpu_pool_free(pool, a);
+    gpu_pool_free(pool, mesh.indices);
+    mesh = Mesh{};
+}
+
+bool mesh_submit(const Mesh& mesh, const GpuBufferPool& pool, const DrawItem& base, DrawList& list) {
+    DrawItem item = base;
+    Uint32 n = 0;
+    for (GpuAlloc a : mesh.streams) {
+        GpuRange r;
+        if (n >= DRAW_MAX_VERTEX_BUFFERS || !gpu_pool_resolve(pool, a, &r)) return false;
+        item.vertex[n].buffer = r.buffer;
+        item.vertex[n].offset = r.offset;
+        n++;
+    }
+    for (Uint32 i = 0; i < base.num_vertex; i++) {
+        if (n >= DRAW_MAX_VERTEX_BUFFERS) return false;
+        item.vertex[n++] = base.vertex[i];
+    }
+    item.num_vertex = n;
+    GpuRange ir;
+    if (!gpu_pool_resolve(pool, mesh.indices, &ir)) return false;
+    item.index.buffer = ir.buffer;
+    item.index.offset = ir.offset;
+    item.index_size = mesh.index_size;
+    for (size_t k = 0; k < mesh.submeshes.size(); k++) {
+        const BMeshSubmesh& sm = mesh.submeshes[k];
+        item.count = sm.index_count;
+        item.first = sm.first_index;
+        item.vertex_offset = sm.vertex_offset;
+        if (base.indirect) item.indirect_offset = base.indirect_offset + (Uint32)(k * sizeof(SDL_GPUIndexedIndirectDrawCommand));
+        draw_list_push(list, item);
+    }
+    return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+#include <SDL3/SDL_gpu.h>
+#include "draw_list.h"
+#include "gpu_pool.h"
+#include "mesh_format.h"
+
+struct UploadRing;
+
+struct Mesh {
+    std::vector<GpuAlloc> streams;
+    std::vector<Uint32> strides;
+    GpuAlloc indices;
+    SDL_GPUIndexElementSize index_size = SDL_GPU_INDEXELEMENTSIZE_16BIT;
+    Uint32 vertex_count = 0;
+    Uint32 index_count = 0;
+    std::vector<BMeshSubmesh> submeshes;
+};
+
+// Maps a .bmesh file and queues its vertex and index data for upload straight
+// from the mapping. The mapping is released before returning.
+bool mesh_load(Mesh& out, GpuBufferPool& pool, UploadRing& uploads, const char* path);
+void mesh_destroy(Mesh& mesh, GpuBufferPool& pool);
+
+// Pushes one indexed draw item per submesh. The mesh streams take vertex
+// buffer slots from 0; bindings already in `base` (e.g. instance data) are
+// moved after them. Key, pipeline and instance count come from `base`. With
+// base.indirect set, submesh k draws the k-th indexed indirect command after
+// base.indirect_offset.
+bool mesh_submit(const Mesh& mesh, const GpuBufferPool& pool, const DrawItem& base, DrawList& list);
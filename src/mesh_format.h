@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+// .bmesh: a header, then stream/submesh tables, then raw vertex and index
+// data at the offsets the tables give. Everything is little-endian and laid
+// out so the runtime can upload straight out of a memory mapping.
+static const uint32_t BMESH_MAGIC = 0x48534D42u;  // "BMSH"
+static const uint32_t BMESH_VERSION = 1;
+static const uint32_t BMESH_ALIGN = 16;
+
+struct BMeshHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t index_size;
+    uint32_t stream_count;
+    uint32_t submesh_count;
+    uint32_t reserved;
+    uint64_t streams_offset;
+    uint64_t submeshes_offset;
+    uint64_t indices_offset;
+    uint64_t file_size;
+};
+
+struct BMeshStream {
+    uint32_t stride;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct BMeshSubmesh {
+    uint32_t first_index;
+    uint32_t index_count;
+    int32_t vertex_offset;
+    uint32_t material;
+    float bounds_min[3];
+    float bounds_max[3];
+};
+
+static_assert(sizeof(BMeshHeader) == 64, "BMeshHeader layout");
+static_assert(sizeof(BMeshStream) == 24, "BMeshStream layout");
+static_assert(sizeof(BMeshSubmesh) == 40, "BMeshSubmesh layout");
+
+// The converter's single stream: float3 position, short4_norm normal,
+// half2 uv. Matches shaders/mesh.pipeline.json.
+struct BMeshVertex {
+    float position[3];
+    int16_t normal[4];
+    uint16_t uv[2];
+};
+
+static_assert(sizeof(BMeshVertex) == 24, "BMeshVertex layout");
+
+inline uint16_t half_from_float(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    int exponent = (int)((bits >> 23) & 0xffu) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffffu;
+    if (exponent <= 0) return (uint16_t)sign;
+    if (exponent >= 31) return (uint16_t)(sign | 0x7c00u);
+    return (uint16_t)(sign | ((uint32_t)exponent << 10) | (mantissa >> 13));
+}
@@ -0,0 +1,51 @@
+#include "object_buffer.h"
+#include "upload_ring.h"
+
+static void pack(const float* instances, Uint32 count, ObjectRecord* out) {
+    for (Uint32 i = 0; i < count; i++) {
+        const float* in = instances + (size_t)i * 3;
+        out[i].offset[0] = in[0];
+        out[i].offset[1] = in[1];
+        out[i].scale = in[2];
+        out[i].material = i % OBJECT_MATERIALS;
+    }
+}
+
+bool object_buffer_init(ObjectBuffer& objects, SDL_GPUDevice* device, Uint32 capacity) {
+    object_buffer_destroy(objects);
+    if (capacity == 0) return false;
+    SDL_GPUBufferCreateInfo info{};
+    info.usage = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ;
+    info.size = capacity * (Uint32)sizeof(ObjectRecord);
+    objects.buffer = SDL_CreateGPUBuffer(device, &info);
+    if (!objects.buffer) return false;
+    objects.device = device;
+    objects.capacity = capacity;
+    return true;
+}
+
+void object_buffer_destroy(ObjectBuffer& objects) {
+    if (objects.buffer) SDL_ReleaseGPUBuffer(objects.device, objects.buffer);
+    objects = ObjectBuffer{};
+}
+
+void object_pack(const float* instances, Uint32 count, std::vector<ObjectRecord>& out) {
+    out.resize(count);
+    pack(instances, count, out.data());
+}
+
+bool object_buffer_write(ObjectBuffer& objects, UploadRing& uploads, const float* instances, Uint32 count) {
+    if (count > objects.capacity) return false;
+    objects.count = count;
+    if (count == 0) return true;
+    void* dst = upload_buffer_map(uploads, objects.buffer, 0, count * (Uint32)sizeof(ObjectRecord));
+    if (!dst) return false;
+    pack(instances, count, (ObjectRecord*)dst);
+    return true;
+}
+
+bool object_buffer_upload(ObjectBuffer& objects, UploadRing& uploads, const void* records, Uint32 count) {
+    if (count > objects.capacity) return false;
+    objects.count = count;
+    return count == 0 || upload_buffer(uploads, objects.buffer, 0, records, count * (Uint32)sizeof(ObjectRecord));
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include <SDL3/SDL_gpu.h>
+
+struct UploadRing;
+
+// Per-object record as the *_objects.vert shaders read it (std430 struct
+// Object): instance transform and a material index into the shader's palette.
+struct ObjectRecord {
+    float offset[2];
+    float scale;
+    Uint32 material;
+};
+
+static_assert(sizeof(ObjectRecord) == 16, "ObjectRecord layout");
+
+static const Uint32 OBJECT_RECORD_WORDS = sizeof(ObjectRecord) / sizeof(Uint32);
+static const Uint32 OBJECT_MATERIALS = 4;
+
+// One structured storage buffer holding a record per drawn object, bound once
+// per pass with SDL_BindGPUVertexStorageBuffers and indexed by instance in
+// the vertex shader, in place of an instance-rate vertex stream.
+struct ObjectBuffer {
+    SDL_GPUDevice* device = nullptr;
+    SDL_GPUBuffer* buffer = nullptr;
+    Uint32 capacity = 0;
+    Uint32 count = 0;
+};
+
+bool object_buffer_init(ObjectBuffer& objects, SDL_GPUDevice* device, Uint32 capacity);
+void object_buffer_destroy(ObjectBuffer& objects);
+
+// Packs instance records (offset.xy, scale) into `out`; object i gets
+// material i % OBJECT_MATERIALS, so it keeps its material through culling.
+void object_pack(const float* instances, Uint32 count, std::vector<ObjectRecord>& out);
+// Packs straight into upload memory, skipping the intermediate copy.
+bool object_buffer_write(ObjectBuffer& objects, UploadRing& uploads, const float* instances, Uint32 count);
+bool object_buffer_upload(ObjectBuffer& objects, UploadRing& uploads, const void* records, Uint32 count);
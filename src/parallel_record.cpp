@@ -0,0 +1,112 @@
+#include "parallel_record.h"
+#include <SDL3/SDL.h>
+#include "jobs.h"
+
+namespace {
+
+void record_chunk(ParallelRecorder& rec, Uint32 chunk, Uint32 slot) {
+    Uint64 t0 = SDL_GetTicksNS();
+    Uint32 first = SDL_min(rec.begin + chunk * rec.chunk_size, rec.end);
+    Uint32 last = SDL_min(first + rec.chunk_size, rec.end);
+
+    SDL_GPUCommandBuffer* cb = SDL_AcquireGPUCommandBuffer(rec.device);
+    if (cb) {
+        bool is_first = chunk == 0;
+        bool is_last = chunk + 1 == rec.chunk_count;
+        SDL_GPUColorTargetInfo t{};
+        t.texture = rec.target.texture;
+        t.load_op = is_first ? SDL_GPU_LOADOP_CLEAR : SDL_GPU_LOADOP_LOAD;
+        t.clear_color = rec.target.clear_color;
+        t.store_op = SDL_GPU_STOREOP_STORE;
+        if (rec.target.resolve && is_last) {
+            t.store_op = SDL_GPU_STOREOP_RESOLVE;
+            t.resolve_texture = rec.target.resolve;
+        }
+        SDL_GPURenderPass* rp = SDL_BeginGPURenderPass(cb, &t, 1, nullptr);
+        draw_list_emit_range(*rec.list, cb, rp, first, last, rec.list_stats[slot]);
+        SDL_EndGPURenderPass(rp);
+    } else {
+        rec.failed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    RecordThreadStats& st = rec.thread_stats[slot];
+    st.chunks++;
+    st.items += last - first;
+    st.record_ns += SDL_GetTicksNS() - t0;
+
+    // Chunks are claimed in increasing order, so whoever holds an earlier
+    // ticket is already recording it and this wait always ends.
+    std::unique_lock<std::mutex> lock(rec.mutex);
+    rec.submit_cv.wait(lock, [&] { return rec.next_submit == chunk; });
+    if (cb) SDL_SubmitGPUCommandBuffer(cb);
+    rec.next_submit++;
+    rec.submit_cv.notify_all();
+}
+
+void record_chunks(ParallelRecorder& rec) {
+    Uint32 slot = SDL_min(jobs::thread_index(), (Uint32)rec.thread_stats.size() - 1);
+    for (;;) {
+        Uint32 chunk = rec.next_chunk.fetch_add(1, std::memory_order_relaxed);
+        if (chunk >= rec.chunk_count) return;
+        record_chunk(rec, chunk, slot);
+    }
+}
+
+// Helpers claim chunks from the shared counter instead of owning one each:
+// whoever holds the lowest unsubmitted chunk is always recording it, so the
+// in-order submit wait cannot deadlock however the helpers get scheduled.
+void record_job(void* user, Uint32) {
+    record_chunks(*static_cast<ParallelRecorder*>(user));
+}
+
+}
+
+bool parallel_recorder_init(ParallelRecorder& rec, SDL_GPUDevice* device, Uint32 max_helpers) {
+    Uint32 n = jobs::thread_count() + 1;
+    rec.device = device;
+    rec.max_helpers = max_helpers;
+    rec.thread_stats.assign(n, RecordThreadStats{});
+    rec.last_thread_stats = rec.thread_stats;
+    rec.list_stats.assign(n, DrawListStats{});
+    return true;
+}
+
+void parallel_recorder_destroy(ParallelRecorder& rec) {
+    rec.device = nullptr;
+    rec.thread_stats.clear();
+    rec.last_thread_stats.clear();
+    rec.list_stats.clear();
+}
+
+bool parallel_record(ParallelRecorder& rec, DrawList& list, Uint32 pass, const RecordTarget& target) {
+    if (!list.sorted) draw_list_sort(list);
+    Uint32 begin, end;
+    draw_list_pass_range(list, pass, &begin, &end);
+    Uint32 n = end - begin;
+    Uint32 helpers = SDL_min(rec.max_helpers, jobs::thread_count() ? jobs::thread_count() - 1 : 0u);
+    Uint32 max_chunks = helpers + 1;
+    Uint32 chunks = SDL_max(1u, SDL_min(max_chunks, n / SDL_max(1u, rec.min_chunk_items)));
+
+    for (auto& s : rec.thread_stats) s = RecordThreadStats{};
+    for (auto& s : rec.list_stats) s = DrawListStats{};
+    rec.list = &list;
+    rec.target = target;
+    rec.begin = begin;
+    rec.end = end;
+    rec.chunk_count = chunks;
+    rec.chunk_size = (n + chunks - 1) / chunks;
+    rec.next_submit = 0;
+    rec.next_chunk.store(0, std::memory_order_relaxed);
+    rec.failed.store(0, std::memory_order_relaxed);
+
+    // A single chunk is not worth a wake-up; record it right here.
+    jobs::Counter counter;
+    if (chunks > 1) jobs::run(record_job, &rec, chunks - 1, &counter);
+    record_chunks(rec);
+    jobs::wait(counter);
+
+    for (const auto& s : rec.list_stats) draw_list_stats_add(list.stats, s);
+    rec.last_thread_stats = rec.thread_stats;
+    rec.list = nullptr;
+    return rec.failed.load(std::memory_order_relaxed) == 0;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <SDL3/SDL_gpu.h>
+#include "draw_list.h"
+
+// The render pass every chunk records into. The first chunk clears, later
+// ones load; only the last one resolves when `resolve` is set.
+struct RecordTarget {
+    SDL_GPUTexture* texture = nullptr;
+    SDL_GPUTexture* resolve = nullptr;
+    SDL_FColor clear_color = {};
+};
+
+struct RecordThreadStats {
+    Uint32 chunks = 0;
+    Uint32 items = 0;
+    Uint64 record_ns = 0;
+};
+
+// Records chunks of a sorted draw list from job threads, each into a command
+// buffer of its own. Each chunk is submitted in chunk order, so the GPU sees
+// the same sequence as a single-threaded recording. The calling thread
+// records too.
+struct ParallelRecorder {
+    SDL_GPUDevice* device = nullptr;
+    Uint32 max_helpers = 0;
+    std::mutex mutex;
+    std::condition_variable submit_cv;
+
+    const DrawList* list = nullptr;
+    RecordTarget target;
+    Uint32 begin = 0;
+    Uint32 end = 0;
+    Uint32 chunk_size = 0;
+    Uint32 chunk_count = 0;
+    Uint32 next_submit = 0;
+    std::atomic<Uint32> next_chunk{ 0 };
+    std::atomic<Uint32> failed{ 0 };
+
+    // Smallest chunk worth a command buffer of its own.
+    Uint32 min_chunk_items = 64;
+    // Indexed by jobs::thread_index(); the last slot is for callers outside
+    // the pool, i.e. the render thread.
+    std::vector<RecordThreadStats> thread_stats;
+    std::vector<DrawListStats> list_stats;
+    std::vector<RecordThreadStats> last_thread_stats;
+};
+
+// Uses up to `max_helpers` job threads besides the caller. Call after
+// jobs::init.
+bool parallel_recorder_init(ParallelRecorder& rec, SDL_GPUDevice* device, Uint32 max_helpers);
+void parallel_recorder_destroy(ParallelRecorder& rec);
+// Records the items of `pass` into `target` and submits them. Blocks until
+// every chunk is submitted; bind counts are added to list.stats. Returns
+// false if a command buffer could not be acquired.
+bool parallel_record(ParallelRecorder& rec, DrawList& list, Uint32 pass, const RecordTarget& target);
@@ -66,6 +66,28 @@ static SDL_GPUBlendOp parse_bo(const std::string& s) {
     return SDL_GPU_BLENDOP_ADD;
 }
 
+static SDL_GPUVertexElementFormat parse_vfmt(const std::string& s) {
+    static const struct { const char* name; SDL_GPUVertexElementFormat fmt; } table[] = {
+        { "int", SDL_GPU_VERTEXELEMENTFORMAT_INT }, { "int2", SDL_GPU_VERTEXELEMENTFORMAT_INT2 },
+        { "int3", SDL_GPU_VERTEXELEMENTFORMAT_INT3 }, { "int4", SDL_GPU_VERTEXELEMENTFORMAT_INT4 },
+        { "uint", SDL_GPU_VERTEXELEMENTFORMAT_UINT }, { "uint2", SDL_GPU_VERTEXELEMENTFORMAT_UINT2 },
+        { "uint3", SDL_GPU_VERTEXELEMENTFORMAT_UINT3 }, { "uint4", SDL_GPU_VERTEXELEMENTFORMAT_UINT4 },
+        { "float", SDL_GPU_VERTEXELEMENTFORMAT_FLOAT }, { "float2", SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2 },
+        { "float3", SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3 }, { "float4", SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4 },
+        { "byte2", SDL_GPU_VERTEXELEMENTFORMAT_BYTE2 }, { "byte4", SDL_GPU_VERTEXELEMENTFORMAT_BYTE4 },
+        { "ubyte2", SDL_GPU_VERTEXELEMENTFORMAT_UBYTE2 }, { "ubyte4", SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4 },
+        { "byte2_norm", SDL_GPU_VERTEXELEMENTFORMAT_BYTE2_NORM }, { "byte4_norm", SDL_GPU_VERTEXELEMENTFORMAT_BYTE4_NORM },
+        { "ubyte2_norm", SDL_GPU_VERTEXELEMENTFORMAT_UBYTE2_NORM }, { "ubyte4_norm", SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM },
+        { "short2", SDL_GPU_VERTEXELEMENTFORMAT_SHORT2 }, { "short4", SDL_GPU_VERTEXELEMENTFORMAT_SHORT4 },
+        { "ushort2", SDL_GPU_VERTEXELEMENTFORMAT_USHORT2 }, { "ushort4", SDL_GPU_VERTEXELEMENTFORMAT_USHORT4 },
+        { "short2_norm", SDL_GPU_VERTEXELEMENTFORMAT_SHORT2_NORM }, { "short4_norm", SDL_GPU_VERTEXELEMENTFORMAT_SHORT4_NORM },
+        { "ushort2_norm", SDL_GPU_VERTEXELEMENTFORMAT_USHORT2_NORM }, { "ushort4_norm", SDL_GPU_VERTEXELEMENTFORMAT_USHORT4_NORM },
+        { "half2", SDL_GPU_VERTEXELEMENTFORMAT_HALF2 }, { "half4", SDL_GPU_VERTEXELEMENTFORMAT_HALF4 },
+    };
+    for (const auto& e : table) if (s == e.name) return e.fmt;
+    return SDL_GPU_VERTEXELEMENTFORMAT_INVALID;
+}
+
 SDL_GPUSampleCount map_samples(Uint32 n) {
     switch (n) {
         case 1: return SDL_GPU_SAMPLECOUNT_1;
@@ -86,10 +108,10 @@ SDL_GPUSampleCount choose_supported(SDL_GPUDevice* dev, SDL_GPUTextureFormat fmt
     return SDL_GPU_SAMPLECOUNT_1;
 }
 
-bool load_pipeline_config(const std::string& path, PipelineConfig& out, Uint32 reflected_color_attachments) {
+bool load_pipeline_config(const char* path, PipelineConfig& out, Uint32 reflected_color_attachments) {
     std::ifstream f(path);
     if (!f.is_open()) {
-        std::fprintf(stderr, "Pipeline config not found: %s\n", path.c_str());
+        std::fprintf(stderr, "Pipeline config not found: %s\n", path);
         return false;
     }
     if (!f.good()) {
@@ -141,6 +163,31 @@ bool load_pipeline_config(const std::string& path, PipelineConfig& out, Uint32 r
             const std::string v = j["vertex_layout"].get<std::string>();
             out.vertex_layout_auto = (v != "manual");
         }
+        out.vertex_streams.clear();
+        if (j.contains("vertex_streams") && j["vertex_streams"].is_array()) {
+            for (const auto& s : j["vertex_streams"]) {
+                VertexStream vs;
+                if (s.contains("slot")) vs.slot = s["slot"].get<Uint32>();
+                if (s.contains("rate") && s["rate"].get<std::string>() == "instance") vs.input_rate = SDL_GPU_VERTEXINPUTRATE_INSTANCE;
+                if (s.contains("pitch")) vs.pitch = s["pitch"].get<Uint32>();
+                if (s.contains("locations")) vs.locations = s["locations"].get<std::vector<Uint32>>();
+                if (s.contains("attributes") && s["attributes"].is_array()) {
+                    for (const auto& a : s["attributes"]) {
+                        VertexStream::Attribute va;
+                        va.location = a["location"].get<Uint32>();
+                        va.format = parse_vfmt(a["format"].get<std::string>());
+                        va.offset = a.contains("offset") ? a["offset"].get<Uint32>() : 0;
+                        vs.attributes.push_back(va);
+                    }
+                }
+                Uint32 step = s.contains("step_rate") ? s["step_rate"].get<Uint32>() : 1;
+                if (vs.input_rate == SDL_GPU_VERTEXINPUTRATE_INSTANCE && step != 1) {
+                    std::fprintf(stderr, "Pipeline config: instance step_rate %u unsupported, only 1\n", step);
+                    return false;
+                }
+                out.vertex_streams.push_back(std::move(vs));
+            }
+        }
         if (j.contains("shaderc")) {
             auto s = j["shaderc"];
             if (s.contains("optimization")) out.shaderc_optimization = s["optimization"].get<std::string>();
@@ -2,6 +2,7 @@
 #include <vector>
 #include <string>
 #include <SDL3/SDL_gpu.h>
+#include "shader_reflect.h"
 
 struct JsonDepth {
     bool enable = false;
@@ -45,9 +46,10 @@ struct PipelineConfig {
     };
 
     std::vector<Blend> blends;
+    std::vector<VertexStream> vertex_streams;
 };
 
-bool load_pipeline_config(const std::string& path, PipelineConfig& out, Uint32 reflected_color_attachments);
+bool load_pipeline_config(const char* path, PipelineConfig& out, Uint32 reflected_color_attachments);
 
 SDL_GPUSampleCount map_samples(Uint32 n);
 
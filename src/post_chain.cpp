@@ -0,0 +1,286 @@
+#include "post_chain.h"
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <utility>
+using nlohmann::json;
+
+static bool parse_scale(const std::string& s, Uint32* out) {
+    if (s == "full") *out = 1;
+    else if (s == "half") *out = 2;
+    else if (s == "quarter") *out = 4;
+    else return false;
+    return true;
+}
+
+static bool parse_format(const std::string& s, SDL_GPUTextureFormat* out) {
+    if (s == "scene") *out = SDL_GPU_TEXTUREFORMAT_INVALID;
+    else if (s == "rgba8") *out = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
+    else if (s == "rgb10a2") *out = SDL_GPU_TEXTUREFORMAT_R10G10B10A2_UNORM;
+    else if (s == "rgba16f") *out = SDL_GPU_TEXTUREFORMAT_R16G16B16A16_FLOAT;
+    else return false;
+    return true;
+}
+
+bool post_chain_load(const char* path, PostChainDesc& out, std::string* error) {
+    std::ifstream f(path);
+    if (!f) {
+        if (error) *error = std::string("cannot open ") + path;
+        return false;
+    }
+    try {
+        json j;
+        f >> j;
+        out.passes.clear();
+        if (!j.contains("passes") || !j["passes"].is_array()) {
+            if (error) *error = "no passes array";
+            return false;
+        }
+        for (const auto& p : j["passes"]) {
+            PostPassDesc pass;
+            pass.name = p["name"].get<std::string>();
+            pass.shader = p["shader"].get<std::string>();
+            if (p.contains("inputs")) pass.inputs = p["inputs"].get<std::vector<std::string>>();
+            if (p.contains("per_pixel")) pass.per_pixel = p["per_pixel"].get<bool>();
+            if (p.contains("scale") && !parse_scale(p["scale"].get<std::string>(), &pass.scale_div)) {
+                if (error) *error = pass.name + ": scale is full, half or quarter";
+                return false;
+            }
+            if (p.contains("format") && !parse_format(p["format"].get<std::string>(), &pass.format)) {
+                if (error) *error = pass.name + ": format is scene, rgba8, rgb10a2 or rgba16f";
+                return false;
+            }
+            if (p.contains("params")) {
+                std::vector<float> v = p["params"].get<std::vector<float>>();
+                for (size_t i = 0; i < v.size() && i < 4; i++) pass.params[i] = v[i];
+            }
+            out.passes.push_back(std::move(pass));
+        }
+        return true;
+    } catch (const std::exception& e) {
+        if (error) *error = e.what();
+        return false;
+    }
+}
+
+bool post_chain_plan(PostChain& chain, const PostChainDesc& desc, SDL_GPUTextureFormat scene_format, std::string* error) {
+    chain.steps.clear();
+    chain.targets.clear();
+    chain.passes = (Uint32)desc.passes.size();
+    const size_t n = desc.passes.size();
+
+    // Pass inputs as pass indices, and how many passes read each output.
+    std::vector<std::vector<int>> inputs(n);
+    std::vector<Uint32> readers(n, 0);
+    for (size_t i = 0; i < n; i++) {
+        const PostPassDesc& p = desc.passes[i];
+        if (p.inputs.empty())
+            inputs[i].push_back((int)i - 1);
+        for (const std::string& name : p.inputs) {
+            bool found = name == "scene" || name == "history";
+            int input = name == "scene" ? POST_INPUT_SCENE : POST_INPUT_HISTORY;
+            for (size_t k = 0; k < i && !found; k++)
+                if (desc.passes[k].name == name) {
+                    input = (int)k;
+                    found = true;
+                }
+            if (!found) {
+                if (error) *error = p.name + ": input " + name + " is not an earlier pass";
+                return false;
+            }
+            inputs[i].push_back(input);
+        }
+        if (inputs[i].size() > POST_MAX_INPUTS || (p.per_pixel && (inputs[i].size() != 1 || inputs[i][0] == POST_INPUT_HISTORY))) {
+            if (error) *error = p.name + (p.per_pixel ? ": per-pixel passes take one input, not history" : ": too many inputs");
+            return false;
+        }
+        for (int in : inputs[i])
+            if (in >= 0) readers[in]++;
+    }
+
+    // A per-pixel pass joins the previous step when that step ends in a
+    // per-pixel pass only it reads, at the same scale and format: the
+    // intermediate value then never leaves registers.
+    std::vector<int> step_of(n, -1);
+    for (size_t i = 0; i < n; i++) {
+        const PostPassDesc& p = desc.passes[i];
+        SDL_GPUTextureFormat format = p.format != SDL_GPU_TEXTUREFORMAT_INVALID ? p.format : scene_format;
+        if (p.per_pixel && i > 0 && inputs[i][0] == (int)i - 1 && desc.passes[i - 1].per_pixel && readers[i - 1] == 1) {
+            PostStep& prev = chain.steps.back();
+            if (prev.scale_div == p.scale_div && prev.format == format && prev.passes.size() < POST_MAX_PARAMS) {
+                SDL_memcpy(prev.params[prev.passes.size()], p.params, sizeof(p.params));
+                prev.passes.push_back((Uint32)i);
+                step_of[i] = (int)chain.steps.size() - 1;
+                continue;
+            }
+        }
+        PostStep step;
+        step.passes.push_back((Uint32)i);
+        step.scale_div = p.scale_div;
+        step.format = format;
+        for (int in : inputs[i]) {
+            step.inputs[step.num_inputs++] = in < 0 ? in : step_of[in];
+            step.history |= in == POST_INPUT_HISTORY;
+        }
+        SDL_memcpy(step.params[0], p.params, sizeof(p.params));
+        step_of[i] = (int)chain.steps.size();
+        chain.steps.push_back(std::move(step));
+    }
+
+    // Targets by lifetime: a step's target returns to the free list after
+    // its last reader has been assigned, never before, so no step samples
+    // the texture it renders to. The final output is never freed, and history
+    // steps get two targets of their own that outlive the frame.
+    const size_t steps = chain.steps.size();
+    std::vector<size_t> last_read(steps);
+    for (size_t s = 0; s < steps; s++) {
+        last_read[s] = s + 1 == steps ? steps : s;
+        for (size_t r = s + 1; r < steps; r++)
+            for (Uint32 k = 0; k < chain.steps[r].num_inputs; k++)
+                if (chain.steps[r].inputs[k] == (int)s) last_read[s] = r;
+    }
+    std::vector<Uint32> free_targets;
+    for (size_t s = 0; s < steps; s++) {
+        PostStep& step = chain.steps[s];
+        if (step.history) {
+            PostTarget t;
+            t.scale_div = step.scale_div;
+            t.format = step.format;
+            step.target = (Uint32)chain.targets.size();
+            step.history_target = step.target + 1;
+            chain.targets.push_back(t);
+            chain.targets.push_back(t);
+            continue;
+        }
+        auto it = free_targets.begin();
+        while (it != free_targets.end() &&
+               (chain.targets[*it].scale_div != step.scale_div || chain.targets[*it].format != step.format))
+            ++it;
+        if (it != free_targets.end()) {
+            step.target = *it;
+            free_targets.erase(it);
+        } else {
+            PostTarget t;
+            t.scale_div = step.scale_div;
+            t.format = step.format;
+            step.target = (Uint32)chain.targets.size();
+            chain.targets.push_back(t);
+        }
+        for (size_t r = 0; r <= s; r++)
+            if (last_read[r] == s && !chain.steps[r].history) free_targets.push_back(chain.steps[r].target);
+    }
+    return true;
+}
+
+std::string post_fused_source(const std::vector<std::string>& snippets) {
+    std::string src =
+        "#version 450\n"
+        "layout(location = 0) in vec2 v_uv;\n"
+        "layout(location = 0) out vec4 out_col;\n"
+        "layout(set = 2, binding = 0) uniform sampler2D input0;\n"
+        "layout(set = 3, binding = 0) uniform PostParams { vec4 params[" + std::to_string(POST_MAX_PARAMS) + "]; };\n";
+    for (size_t i = 0; i < snippets.size(); i++) {
+        src += "#define apply apply_" + std::to_string(i) + "\n";
+        src += "#line 1 " + std::to_string(i + 1) + "\n";
+        src += snippets[i];
+        src += "\n#undef apply\n";
+    }
+    src += "void main() {\n    vec4 c = texture(input0, v_uv);\n";
+    for (size_t i = 0; i < snippets.size(); i++)
+        src += "    c = apply_" + std::to_string(i) + "(c, params[" + std::to_string(i) + "]);\n";
+    src += "    out_col = c;\n}\n";
+    return src;
+}
+
+static void release_targets(PostChain& chain) {
+    for (PostTarget& t : chain.targets) {
+        if (t.texture) SDL_ReleaseGPUTexture(chain.device, t.texture);
+        t.texture = nullptr;
+    }
+    chain.width = 0;
+    chain.height = 0;
+}
+
+static bool create_targets(PostChain& chain, Uint32 width, Uint32 height) {
+    release_targets(chain);
+    for (PostTarget& t : chain.targets) {
+        SDL_GPUTextureCreateInfo info{};
+        info.type = SDL_GPU_TEXTURETYPE_2D;
+        info.format = t.format;
+        info.usage = SDL_GPU_TEXTUREUSAGE_COLOR_TARGET | SDL_GPU_TEXTUREUSAGE_SAMPLER;
+        info.width = SDL_max(1u, width / t.scale_div);
+        info.height = SDL_max(1u, height / t.scale_div);
+        info.layer_count_or_depth = 1;
+        info.num_levels = 1;
+        info.sample_count = SDL_GPU_SAMPLECOUNT_1;
+        t.texture = SDL_CreateGPUTexture(chain.device, &info);
+        if (!t.texture) {
+            release_targets(chain);
+            return false;
+        }
+    }
+    chain.width = width;
+    chain.height = height;
+    chain.history_valid = false;
+    return true;
+}
+
+SDL_GPUTexture* post_chain_record(PostChain& chain, SDL_GPUCommandBuffer* cb, SDL_GPUTexture* scene, Uint32 width, Uint32 height) {
+    if (chain.steps.empty() || !scene || !chain.sampler) return scene;
+    for (const PostStep& step : chain.steps)
+        if (!step.pipeline) return scene;
+    if ((width != chain.width || height != chain.height) && !create_targets(chain, width, height))
+        return scene;
+
+    for (PostStep& step : chain.steps) {
+        if (step.history)
+            step.params[POST_MAX_PARAMS - 1][0] = chain.history_valid ? 1.0f : 0.0f;
+        SDL_GPUColorTargetInfo t{};
+        t.texture = chain.targets[step.target].texture;
+        t.load_op = SDL_GPU_LOADOP_DONT_CARE;
+        t.store_op = SDL_GPU_STOREOP_STORE;
+        SDL_GPURenderPass* rp = SDL_BeginGPURenderPass(cb, &t, 1, nullptr);
+        SDL_BindGPUGraphicsPipeline(rp, step.pipeline);
+        SDL_GPUTextureSamplerBinding bindings[POST_MAX_INPUTS] = {};
+        for (Uint32 k = 0; k < step.num_inputs; k++) {
+            int in = step.inputs[k];
+            if (in == POST_INPUT_SCENE)
+                bindings[k].texture = scene;
+            else if (in == POST_INPUT_HISTORY)
+                bindings[k].texture = chain.targets[step.history_target].texture;
+            else
+                bindings[k].texture = chain.targets[chain.steps[in].target].texture;
+            bindings[k].sampler = chain.sampler;
+        }
+        SDL_BindGPUFragmentSamplers(rp, 0, bindings, step.num_inputs);
+        if (step.has_params)
+            SDL_PushGPUFragmentUniformData(cb, 0, step.params, sizeof(step.params));
+        SDL_DrawGPUPrimitives(rp, 3, 1, 0, 0);
+        SDL_EndGPURenderPass(rp);
+    }
+    SDL_GPUTexture* out = chain.targets[chain.steps.back().target].texture;
+    // What each history step wrote is next frame's history.
+    for (PostStep& step : chain.steps)
+        if (step.history) std::swap(step.target, step.history_target);
+    chain.history_valid = true;
+    return out;
+}
+
+void post_chain_destroy(PostChain& chain) {
+    release_targets(chain);
+    for (PostStep& step : chain.steps) {
+        if (step.pipeline) SDL_ReleaseGPUGraphicsPipeline(chain.device, step.pipeline);
+        step.pipeline = nullptr;
+    }
+}
+
+PostChainStats post_chain_stats(const PostChain& chain) {
+    PostChainStats st;
+    st.passes = chain.passes;
+    st.steps = (Uint32)chain.steps.size();
+    st.targets = (Uint32)chain.targets.size();
+    for (const PostTarget& t : chain.targets)
+        if (t.texture)
+            st.target_bytes += SDL_CalculateGPUTextureFormatSize(t.format, SDL_max(1u, chain.width / t.scale_div),
+                                                                 SDL_max(1u, chain.height / t.scale_div), 1);
+    return st;
+}
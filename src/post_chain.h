@@ -0,0 +1,100 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <SDL3/SDL_gpu.h>
+
+static const Uint32 POST_MAX_INPUTS = 4;
+// vec4s in a step's PostParams block; a fused step gives each pass one.
+static const Uint32 POST_MAX_PARAMS = 8;
+// Step input naming the scene texture rather than an earlier step.
+static const int POST_INPUT_SCENE = -1;
+// Step input naming the step's own output from the previous frame.
+static const int POST_INPUT_HISTORY = -2;
+
+// One fullscreen pass as written in the chain file. Full passes are fragment
+// shaders sampling their inputs at set 2, bindings 0..n-1, and reading
+// params[0] of the PostParams block at set 3. Per-pixel passes are snippets
+// defining `vec4 apply(vec4 color, vec4 params)` over their single input;
+// adjacent ones are fused into one shader and one target. A full pass may
+// also read "history", its own output from the previous frame; it then sees
+// params[POST_MAX_PARAMS - 1].x as 1 when that holds a frame at the current
+// size and 0 after a resize or reset.
+struct PostPassDesc {
+    std::string name;
+    std::string shader;
+    // "scene", "history" or the name of an earlier pass; empty means the
+    // previous pass.
+    std::vector<std::string> inputs;
+    Uint32 scale_div = 1;
+    // INVALID renders at the scene's format.
+    SDL_GPUTextureFormat format = SDL_GPU_TEXTUREFORMAT_INVALID;
+    bool per_pixel = false;
+    float params[4] = {};
+};
+
+struct PostChainDesc {
+    std::vector<PostPassDesc> passes;
+};
+
+bool post_chain_load(const char* path, PostChainDesc& out, std::string* error);
+
+// A draw of the chain: one full pass, or a run of fused per-pixel passes.
+struct PostStep {
+    std::vector<Uint32> passes;
+    int inputs[POST_MAX_INPUTS] = {};
+    Uint32 num_inputs = 0;
+    Uint32 target = 0;
+    // Steps reading their history own two targets and swap them each frame.
+    bool history = false;
+    Uint32 history_target = 0;
+    Uint32 scale_div = 1;
+    SDL_GPUTextureFormat format = SDL_GPU_TEXTUREFORMAT_INVALID;
+    // Filled in by the caller once the step's shader is built.
+    SDL_GPUGraphicsPipeline* pipeline = nullptr;
+    bool has_params = false;
+    float params[POST_MAX_PARAMS][4] = {};
+};
+
+struct PostTarget {
+    Uint32 scale_div = 1;
+    SDL_GPUTextureFormat format = SDL_GPU_TEXTUREFORMAT_INVALID;
+    SDL_GPUTexture* texture = nullptr;
+};
+
+struct PostChainStats {
+    Uint32 passes = 0;
+    Uint32 steps = 0;
+    Uint32 targets = 0;
+    Uint64 target_bytes = 0;
+};
+
+// Steps in recording order and the targets they render into. A target is
+// handed to the next step of its scale and format once its last reader has
+// run, so a linear chain ping-pongs between two textures per size.
+struct PostChain {
+    SDL_GPUDevice* device = nullptr;
+    SDL_GPUSampler* sampler = nullptr;
+    std::vector<PostStep> steps;
+    std::vector<PostTarget> targets;
+    Uint32 passes = 0;
+    Uint32 width = 0;
+    Uint32 height = 0;
+    // Render thread: cleared to make history steps start over.
+    bool history_valid = false;
+};
+
+// Splits `desc` into steps and assigns their targets; formats left INVALID
+// become `scene_format`.
+bool post_chain_plan(PostChain& chain, const PostChainDesc& desc, SDL_GPUTextureFormat scene_format, std::string* error);
+// Fragment shader running the per-pixel `snippets` in order over input 0.
+std::string post_fused_source(const std::vector<std::string>& snippets);
+
+// Render thread: runs every step over `scene`, creating the targets at its
+// size on first use and after a resize. Returns the last step's output, or
+// `scene` when the chain is empty or incomplete.
+SDL_GPUTexture* post_chain_record(PostChain& chain, SDL_GPUCommandBuffer* cb, SDL_GPUTexture* scene, Uint32 width, Uint32 height);
+// Releases the targets and step pipelines; the caller makes sure no frame
+// still uses them.
+void post_chain_destroy(PostChain& chain);
+
+PostChainStats post_chain_stats(const PostChain& chain);
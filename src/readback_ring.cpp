@@ -0,0 +1,143 @@
+#include "readback_ring.h"
+#include <SDL3/SDL.h>
+#include "arena.h"
+#include "upload_ring.h"
+
+static const Uint32 READBACK_ALIGN = 16;
+
+static Uint32 align_up(Uint32 v, Uint32 a) {
+    return (v + a - 1) & ~(a - 1);
+}
+
+static void release_slot(ReadbackRing& ring, ReadbackRing::Slot& s) {
+    if (s.buffer) SDL_ReleaseGPUTransferBuffer(ring.device, s.buffer);
+    s = ReadbackRing::Slot{};
+}
+
+bool readback_ring_init(ReadbackRing& ring, SDL_GPUDevice* device, Uint32 slot_count) {
+    readback_ring_destroy(ring);
+    ring.device = device;
+    ring.slots.assign(slot_count ? slot_count : 1, ReadbackRing::Slot{});
+    return true;
+}
+
+void readback_ring_destroy(ReadbackRing& ring) {
+    for (auto& s : ring.slots) release_slot(ring, s);
+    ring.slots.clear();
+    ring.current = 0;
+    ring.frame = 0;
+}
+
+// Transfer buffers grow to the largest frame seen and are kept.
+static bool reserve(ReadbackRing& ring, ReadbackRing::Slot& s, Uint32 size) {
+    if (s.buffer && s.size >= size) return true;
+    if (s.buffer) SDL_ReleaseGPUTransferBuffer(ring.device, s.buffer);
+    SDL_GPUTransferBufferCreateInfo tci{};
+    tci.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD;
+    tci.size = size;
+    s.buffer = SDL_CreateGPUTransferBuffer(ring.device, &tci);
+    s.size = s.buffer ? size : 0;
+    return s.buffer != nullptr;
+}
+
+void readback_ring_record(ReadbackRing& ring, UploadRing& uploads, SDL_GPUCommandBuffer* cb, const std::vector<ReadbackRequest>& requests,
+                          SDL_GPUTexture* frame_texture, SDL_GPUTextureFormat frame_format, Uint32 frame_w, Uint32 frame_h) {
+    ring.frame++;
+    ring.stats.requests += (Uint32)requests.size();
+    ReadbackRing::Slot* slot = ring.slots.empty() ? nullptr : &ring.slots[ring.current];
+    if (!requests.empty() && (!slot || !slot->items.empty())) {
+        ring.stats.dropped += (Uint32)requests.size();
+    } else if (!requests.empty()) {
+        ArenaScope scratch(arena_scratch());
+        ArenaVector<SDL_GPUTextureRegion> regions{ ArenaAllocator<SDL_GPUTextureRegion>(scratch.arena) };
+        Uint32 size = 0;
+        for (const ReadbackRequest& rq : requests) {
+            SDL_GPUTextureRegion region{};
+            ReadbackRing::Item item{};
+            region.texture = rq.texture;
+            item.format = rq.format;
+            int x = rq.rect.x, y = rq.rect.y, w = rq.rect.w, h = rq.rect.h;
+            if (!rq.texture) {
+                region.texture = frame_texture;
+                item.format = frame_format;
+                if (w <= 0 || h <= 0) x = 0, y = 0, w = (int)frame_w, h = (int)frame_h;
+                int x1 = SDL_min(x + w, (int)frame_w), y1 = SDL_min(y + h, (int)frame_h);
+                x = SDL_max(x, 0);
+                y = SDL_max(y, 0);
+                w = x1 - x;
+                h = y1 - y;
+            }
+            item.texel_size = SDL_GPUTextureFormatTexelBlockSize(item.format);
+            if (!region.texture || w <= 0 || h <= 0 || item.texel_size == 0) {
+                ring.stats.dropped++;
+                continue;
+            }
+            region.x = (Uint32)x;
+            region.y = (Uint32)y;
+            region.w = (Uint32)w;
+            region.h = (Uint32)h;
+            region.d = 1;
+            item.offset = align_up(size, READBACK_ALIGN);
+            item.width = region.w;
+            item.height = region.h;
+            item.callback = rq.callback;
+            item.user = rq.user;
+            size = item.offset + item.width * item.height * item.texel_size;
+            regions.push_back(region);
+            slot->items.push_back(item);
+        }
+
+        if (!slot->items.empty() && !reserve(ring, *slot, size)) {
+            ring.stats.dropped += (Uint32)slot->items.size();
+            slot->items.clear();
+        }
+        if (!slot->items.empty()) {
+            SDL_GPUCopyPass* pass = SDL_BeginGPUCopyPass(cb);
+            for (size_t i = 0; i < regions.size(); i++) {
+                const ReadbackRing::Item& item = slot->items[i];
+                SDL_GPUTextureTransferInfo dst{};
+                dst.transfer_buffer = slot->buffer;
+                dst.offset = item.offset;
+                dst.pixels_per_row = item.width;
+                dst.rows_per_layer = item.height;
+                SDL_DownloadFromGPUTexture(pass, &regions[i], &dst);
+            }
+            SDL_EndGPUCopyPass(pass);
+            slot->serial = upload_ring_request_fence(uploads);
+            slot->frame = ring.frame;
+            ring.stats.bytes += size;
+            ring.current = (ring.current + 1) % (Uint32)ring.slots.size();
+        }
+    }
+
+    ring.stats.slots_in_flight = 0;
+    for (const auto& s : ring.slots) ring.stats.slots_in_flight += !s.items.empty();
+    ring.last_stats = ring.stats;
+    ring.stats = ReadbackStats{};
+}
+
+void readback_ring_poll(ReadbackRing& ring, UploadRing& uploads) {
+    Uint64 completed = upload_ring_poll(uploads);
+    // Oldest slot first, so callbacks see frames in order.
+    Uint32 n = (Uint32)ring.slots.size();
+    for (Uint32 k = 0; k < n; k++) {
+        ReadbackRing::Slot& s = ring.slots[(ring.current + k) % n];
+        if (s.items.empty() || s.serial > completed) continue;
+        const Uint8* data = (const Uint8*)SDL_MapGPUTransferBuffer(ring.device, s.buffer, false);
+        for (const ReadbackRing::Item& item : s.items) {
+            if (!data || !item.callback) continue;
+            ReadbackResult result;
+            result.pixels = data + item.offset;
+            result.width = item.width;
+            result.height = item.height;
+            result.pitch = item.width * item.texel_size;
+            result.format = item.format;
+            result.frame = s.frame;
+            result.latency = (Uint32)(ring.frame - s.frame);
+            item.callback(item.user, result);
+            ring.stats.delivered++;
+        }
+        if (data) SDL_UnmapGPUTransferBuffer(ring.device, s.buffer);
+        s.items.clear();
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <vector>
+#include <SDL3/SDL_gpu.h>
+
+struct UploadRing;
+
+// One finished readback. `pixels` is only valid during the callback; rows
+// are tightly packed.
+struct ReadbackResult {
+    const Uint8* pixels = nullptr;
+    Uint32 width = 0;
+    Uint32 height = 0;
+    Uint32 pitch = 0;
+    SDL_GPUTextureFormat format = SDL_GPU_TEXTUREFORMAT_INVALID;
+    // Frame the copy was recorded in, and how many frames later it arrived.
+    Uint64 frame = 0;
+    Uint32 latency = 0;
+};
+
+typedef void (*ReadbackCallback)(void* user, const ReadbackResult& result);
+
+struct ReadbackRequest {
+    // nullptr reads the frame's final image (the swapchain texture), clipped
+    // to its size; an empty rect then reads all of it. Other textures need
+    // their format and a rect inside them.
+    SDL_GPUTexture* texture = nullptr;
+    SDL_GPUTextureFormat format = SDL_GPU_TEXTUREFORMAT_INVALID;
+    SDL_Rect rect{};
+    ReadbackCallback callback = nullptr;
+    void* user = nullptr;
+};
+
+struct ReadbackStats {
+    Uint32 requests = 0;
+    Uint32 delivered = 0;
+    // No free slot or transfer buffer; the request was skipped.
+    Uint32 dropped = 0;
+    Uint32 slots_in_flight = 0;
+    Uint64 bytes = 0;
+};
+
+// Download transfer buffers, one slot per frame in flight. Requests recorded
+// in a frame share its slot and its copy pass; the slot is read back and the
+// callbacks run once the frame's fence (see UploadRing) has signalled, a few
+// frames later. Nothing here waits on the GPU: when every slot is still in
+// flight, new requests are dropped.
+//
+// Render thread only; requests come from the main thread through the frame
+// snapshot.
+struct ReadbackRing {
+    struct Item {
+        Uint32 offset = 0;
+        Uint32 width = 0;
+        Uint32 height = 0;
+        Uint32 texel_size = 0;
+        SDL_GPUTextureFormat format = SDL_GPU_TEXTUREFORMAT_INVALID;
+        ReadbackCallback callback = nullptr;
+        void* user = nullptr;
+    };
+
+    struct Slot {
+        SDL_GPUTransferBuffer* buffer = nullptr;
+        Uint32 size = 0;
+        Uint64 serial = 0;
+        Uint64 frame = 0;
+        std::vector<Item> items;
+    };
+
+    SDL_GPUDevice* device = nullptr;
+    std::vector<Slot> slots;
+    Uint32 current = 0;
+    Uint64 frame = 0;
+    ReadbackStats stats{};
+    ReadbackStats last_stats{};
+};
+
+bool readback_ring_init(ReadbackRing& ring, SDL_GPUDevice* device, Uint32 slot_count = 4);
+void readback_ring_destroy(ReadbackRing& ring);
+
+// Records the copies for `requests` into one copy pass on `cb`, after
+// everything already recorded, and fences the submission through `uploads`.
+// `frame_texture` stands in for requests without a texture; `frame_w` and
+// `frame_h` are its size.
+void readback_ring_record(ReadbackRing& ring, UploadRing& uploads, SDL_GPUCommandBuffer* cb, const std::vector<ReadbackRequest>& requests,
+                          SDL_GPUTexture* frame_texture, SDL_GPUTextureFormat frame_format, Uint32 frame_w, Uint32 frame_h);
+// Delivers every slot whose submission has completed. Call once per frame.
+void readback_ring_poll(ReadbackRing& ring, UploadRing& uploads);
@@ -0,0 +1,163 @@
+#include "render_queue.h"
+#include "arena.h"
+
+void ui_snapshot_capture(UiSnapshot& snap, const ImDrawData* src) {
+    snap.valid = src && src->Valid;
+    if (!snap.valid) return;
+    int n = src->CmdListsCount;
+    while (snap.lists.Size < n) snap.lists.push_back(nullptr);
+    for (int i = 0; i < n; i++) {
+        const ImDrawList* from = src->CmdLists[i];
+        ImDrawList*& to = snap.lists[i];
+        if (!to) {
+            to = from->CloneOutput();
+            continue;
+        }
+        // ImVector assignment keeps the capacity, so steady state is a memcpy.
+        to->CmdBuffer = from->CmdBuffer;
+        to->IdxBuffer = from->IdxBuffer;
+        to->VtxBuffer = from->VtxBuffer;
+        to->Flags = from->Flags;
+    }
+    snap.data = *src;
+    for (int i = 0; i < n; i++) snap.data.CmdLists[i] = snap.lists[i];
+    // Both point into the live context; the backend needs neither.
+    snap.data.OwnerViewport = nullptr;
+    snap.data.Textures = nullptr;
+}
+
+void ui_snapshot_destroy(UiSnapshot& snap) {
+    for (ImDrawList* list : snap.lists) IM_DELETE(list);
+    snap.lists.clear();
+    snap.data = ImDrawData{};
+    snap.valid = false;
+}
+
+static void release(SDL_GPUDevice* device, const Retired& r) {
+    switch (r.kind) {
+    case RetireKind::texture: SDL_ReleaseGPUTexture(device, (SDL_GPUTexture*)r.object); break;
+    case RetireKind::sampler: SDL_ReleaseGPUSampler(device, (SDL_GPUSampler*)r.object); break;
+    case RetireKind::shader: SDL_ReleaseGPUShader(device, (SDL_GPUShader*)r.object); break;
+    case RetireKind::graphics_pipeline: SDL_ReleaseGPUGraphicsPipeline(device, (SDL_GPUGraphicsPipeline*)r.object); break;
+    case RetireKind::compute_pipeline: SDL_ReleaseGPUComputePipeline(device, (SDL_GPUComputePipeline*)r.object); break;
+    }
+}
+
+void render_queue_init(RenderQueue& q, Uint32 slots) {
+    std::lock_guard<std::mutex> lock(q.mutex);
+    q.free_slots.clear();
+    q.ready.clear();
+    for (Uint32 i = slots; i > 0; i--) q.free_slots.push_back(i - 1);
+    q.slot_serial.assign(slots, 0);
+    q.closed = false;
+}
+
+Uint32 render_queue_acquire(RenderQueue& q) {
+    std::unique_lock<std::mutex> lock(q.mutex);
+    if (q.free_slots.empty() && q.ready.empty()) {
+        q.stats.producer_waits++;
+        q.cv.wait(lock, [&] { return !q.free_slots.empty() || !q.ready.empty(); });
+    }
+    Uint32 slot;
+    if (!q.free_slots.empty()) {
+        slot = q.free_slots.back();
+        q.free_slots.pop_back();
+    } else {
+        slot = q.ready.front();
+        q.ready.pop_front();
+        q.stats.replaced++;
+    }
+    return slot;
+}
+
+Uint64 render_queue_publish(RenderQueue& q, Uint32 slot) {
+    Uint64 serial;
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        serial = ++q.published;
+        q.slot_serial[slot] = serial;
+        q.ready.push_back(slot);
+        q.stats.published++;
+    }
+    q.cv.notify_all();
+    return serial;
+}
+
+bool render_queue_pop(RenderQueue& q, Uint32* slot) {
+    bool dropped = false;
+    {
+        std::unique_lock<std::mutex> lock(q.mutex);
+        q.cv.wait(lock, [&] { return q.closed || !q.ready.empty(); });
+        if (q.closed) return false;
+        // Older snapshots are never rendered; retirement still waits on the
+        // newest serial's completion, which covers theirs.
+        while (q.ready.size() > 1) {
+            q.free_slots.push_back(q.ready.front());
+            q.ready.pop_front();
+            q.stats.replaced++;
+            dropped = true;
+        }
+        *slot = q.ready.front();
+        q.ready.pop_front();
+    }
+    if (dropped) q.cv.notify_all();
+    return true;
+}
+
+void render_queue_complete(RenderQueue& q, SDL_GPUDevice* device, Uint32 slot) {
+    ArenaScope scratch(arena_scratch());
+    ArenaVector<Retired> done{ ArenaAllocator<Retired>(scratch.arena) };
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.completed = SDL_max(q.completed, q.slot_serial[slot]);
+        q.free_slots.push_back(slot);
+        q.stats.rendered++;
+        size_t keep = 0;
+        for (const Retired& r : q.retired) {
+            if (r.serial <= q.completed) done.push_back(r);
+            else q.retired[keep++] = r;
+        }
+        q.retired.resize(keep);
+        q.stats.retired += done.size();
+    }
+    q.cv.notify_all();
+    for (const Retired& r : done) release(device, r);
+}
+
+void render_queue_retire(RenderQueue& q, SDL_GPUDevice* device, RetireKind kind, void* object) {
+    if (!object) return;
+    Retired r{ kind, object, 0 };
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        r.serial = q.published;
+        if (q.completed < q.published) {
+            q.retired.push_back(r);
+            return;
+        }
+        q.stats.retired++;
+    }
+    release(device, r);
+}
+
+void render_queue_close(RenderQueue& q) {
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.closed = true;
+    }
+    q.cv.notify_all();
+}
+
+void render_queue_drain(RenderQueue& q, SDL_GPUDevice* device) {
+    std::vector<Retired> done;
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        done.swap(q.retired);
+        q.completed = q.published;
+    }
+    for (const Retired& r : done) release(device, r);
+}
+
+RenderQueueStats render_queue_stats(RenderQueue& q) {
+    std::lock_guard<std::mutex> lock(q.mutex);
+    return q.stats;
+}
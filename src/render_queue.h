@@ -0,0 +1,71 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <SDL3/SDL_gpu.h>
+#include "imgui.h"
+
+// ImGui output copied out of the context, so it can be rendered while the
+// main thread builds the next frame. The lists are reused between captures.
+struct UiSnapshot {
+    ImDrawData data = {};
+    ImVector<ImDrawList*> lists;
+    bool valid = false;
+};
+
+void ui_snapshot_capture(UiSnapshot& snap, const ImDrawData* src);
+void ui_snapshot_destroy(UiSnapshot& snap);
+
+enum class RetireKind { texture, sampler, shader, graphics_pipeline, compute_pipeline };
+
+struct Retired {
+    RetireKind kind;
+    void* object;
+    Uint64 serial;
+};
+
+struct RenderQueueStats {
+    Uint64 published = 0;
+    Uint64 rendered = 0;
+    Uint64 replaced = 0;
+    Uint64 producer_waits = 0;
+    Uint64 retired = 0;
+};
+
+// Snapshot slots handed from the main thread to the render thread. A slot is
+// free, ready or being rendered; the main thread fills a free one, or takes
+// back the oldest ready one when none is free, so it never waits for the GPU.
+// The render thread takes the newest ready slot and frees any older ones, so
+// it always renders the latest frame.
+//
+// GPU objects the main thread replaces are retired rather than released:
+// snapshots up to the current serial may still name them, so they are
+// released once the render thread has completed that serial.
+struct RenderQueue {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Uint32> free_slots;
+    std::deque<Uint32> ready;
+    std::vector<Uint64> slot_serial;
+    std::vector<Retired> retired;
+    Uint64 published = 0;
+    Uint64 completed = 0;
+    bool closed = false;
+    RenderQueueStats stats;
+};
+
+void render_queue_init(RenderQueue& q, Uint32 slots);
+// Main thread: a slot to fill. Blocks only while every slot is rendering.
+Uint32 render_queue_acquire(RenderQueue& q);
+Uint64 render_queue_publish(RenderQueue& q, Uint32 slot);
+// Render thread: blocks for the next slot. False once closed.
+bool render_queue_pop(RenderQueue& q, Uint32* slot);
+// Render thread: hands the slot back and releases what nobody can name now.
+void render_queue_complete(RenderQueue& q, SDL_GPUDevice* device, Uint32 slot);
+// Any thread. Released at once when no published snapshot is outstanding.
+void render_queue_retire(RenderQueue& q, SDL_GPUDevice* device, RetireKind kind, void* object);
+void render_queue_close(RenderQueue& q);
+// After the render thread has stopped: releases everything still retired.
+void render_queue_drain(RenderQueue& q, SDL_GPUDevice* device);
+RenderQueueStats render_queue_stats(RenderQueue& q);
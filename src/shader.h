@@ -4,22 +4,20 @@
 #include <vector>
 #include <string>
 #include <filesystem>
+#include "logui.h"
 
 using std::string;
 
 namespace shader {
 
-static std::vector<string> g_log;
-static bool g_autoscroll = true;
-
 static void logf(const char* fmt, ...) {
     char buf[2048];
     va_list ap;
     va_start(ap, fmt);
-    vsnprintf(buf, sizeof(buf), fmt, ap);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
     va_end(ap);
-    g_log.emplace_back(buf);
-    if (g_log.size() > 2000) g_log.erase(g_log.begin(), g_log.begin() + 1000);
+    if (n < 0) return;
+    logui::write(logui::level::info, buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
 }
 
 static unsigned char* read_all(const char* path, size_t* out_size) {
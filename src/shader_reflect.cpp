@@ -1,6 +1,8 @@
 #include "shader_reflect.h"
 #include <algorithm>
+#include <cstdio>
 #include <spirv_reflect.h>
+#include "arena.h"
 
 static SDL_GPUVertexElementFormat map_spv_to_sdl(SpvReflectFormat f) {
     switch (f) {
@@ -16,11 +18,42 @@ static SDL_GPUVertexElementFormat map_spv_to_sdl(SpvReflectFormat f) {
         case SPV_REFLECT_FORMAT_R32G32_UINT: return SDL_GPU_VERTEXELEMENTFORMAT_UINT2;
         case SPV_REFLECT_FORMAT_R32G32B32_UINT: return SDL_GPU_VERTEXELEMENTFORMAT_UINT3;
         case SPV_REFLECT_FORMAT_R32G32B32A32_UINT: return SDL_GPU_VERTEXELEMENTFORMAT_UINT4;
+        case SPV_REFLECT_FORMAT_R16G16_SFLOAT: return SDL_GPU_VERTEXELEMENTFORMAT_HALF2;
+        case SPV_REFLECT_FORMAT_R16G16B16A16_SFLOAT: return SDL_GPU_VERTEXELEMENTFORMAT_HALF4;
         default: return SDL_GPU_VERTEXELEMENTFORMAT_INVALID;
     }
 }
 
-static uint32_t sdl_fmt_size(SDL_GPUVertexElementFormat f) {
+enum class FmtClass { invalid, floating, sint, uint };
+
+static FmtClass fmt_class(SDL_GPUVertexElementFormat f) {
+    switch (f) {
+        case SDL_GPU_VERTEXELEMENTFORMAT_INT:
+        case SDL_GPU_VERTEXELEMENTFORMAT_INT2:
+        case SDL_GPU_VERTEXELEMENTFORMAT_INT3:
+        case SDL_GPU_VERTEXELEMENTFORMAT_INT4:
+        case SDL_GPU_VERTEXELEMENTFORMAT_BYTE2:
+        case SDL_GPU_VERTEXELEMENTFORMAT_BYTE4:
+        case SDL_GPU_VERTEXELEMENTFORMAT_SHORT2:
+        case SDL_GPU_VERTEXELEMENTFORMAT_SHORT4:
+            return FmtClass::sint;
+        case SDL_GPU_VERTEXELEMENTFORMAT_UINT:
+        case SDL_GPU_VERTEXELEMENTFORMAT_UINT2:
+        case SDL_GPU_VERTEXELEMENTFORMAT_UINT3:
+        case SDL_GPU_VERTEXELEMENTFORMAT_UINT4:
+        case SDL_GPU_VERTEXELEMENTFORMAT_UBYTE2:
+        case SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4:
+        case SDL_GPU_VERTEXELEMENTFORMAT_USHORT2:
+        case SDL_GPU_VERTEXELEMENTFORMAT_USHORT4:
+            return FmtClass::uint;
+        case SDL_GPU_VERTEXELEMENTFORMAT_INVALID:
+            return FmtClass::invalid;
+        default:
+            return FmtClass::floating;
+    }
+}
+
+uint32_t vertex_format_size(SDL_GPUVertexElementFormat f) {
     switch (f) {
         case SDL_GPU_VERTEXELEMENTFORMAT_FLOAT:   return 4;
         case SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2:  return 8;
@@ -34,6 +67,24 @@ static uint32_t sdl_fmt_size(SDL_GPUVertexElementFormat f) {
         case SDL_GPU_VERTEXELEMENTFORMAT_UINT2:   return 8;
         case SDL_GPU_VERTEXELEMENTFORMAT_UINT3:   return 12;
         case SDL_GPU_VERTEXELEMENTFORMAT_UINT4:   return 16;
+        case SDL_GPU_VERTEXELEMENTFORMAT_BYTE2:
+        case SDL_GPU_VERTEXELEMENTFORMAT_UBYTE2:
+        case SDL_GPU_VERTEXELEMENTFORMAT_BYTE2_NORM:
+        case SDL_GPU_VERTEXELEMENTFORMAT_UBYTE2_NORM: return 2;
+        case SDL_GPU_VERTEXELEMENTFORMAT_BYTE4:
+        case SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4:
+        case SDL_GPU_VERTEXELEMENTFORMAT_BYTE4_NORM:
+        case SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM:
+        case SDL_GPU_VERTEXELEMENTFORMAT_SHORT2:
+        case SDL_GPU_VERTEXELEMENTFORMAT_USHORT2:
+        case SDL_GPU_VERTEXELEMENTFORMAT_SHORT2_NORM:
+        case SDL_GPU_VERTEXELEMENTFORMAT_USHORT2_NORM:
+        case SDL_GPU_VERTEXELEMENTFORMAT_HALF2: return 4;
+        case SDL_GPU_VERTEXELEMENTFORMAT_SHORT4:
+        case SDL_GPU_VERTEXELEMENTFORMAT_USHORT4:
+        case SDL_GPU_VERTEXELEMENTFORMAT_SHORT4_NORM:
+        case SDL_GPU_VERTEXELEMENTFORMAT_USHORT4_NORM:
+        case SDL_GPU_VERTEXELEMENTFORMAT_HALF4: return 8;
         default: return 0;
     }
 }
@@ -45,12 +96,104 @@ void pack_tight(ReflectedVertexInput& out) {
     for (auto& a : out.attributes) {
         a.buffer_slot = 0;
         a.offset = off;
-        off += sdl_fmt_size(a.format);
+        off += vertex_format_size(a.format);
+    }
+    SDL_GPUVertexBufferDescription d{};
+    d.slot = 0;
+    d.pitch = off;
+    d.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX;
+    d.instance_step_rate = 0;
+    out.buffers.assign(1, d);
+}
+
+bool pack_streams(ReflectedVertexInput& out, const std::vector<VertexStream>& streams) {
+    if (streams.empty()) {
+        pack_tight(out);
+        return true;
+    }
+    std::sort(out.attributes.begin(), out.attributes.end(),
+        [](const SDL_GPUVertexAttribute& a, const SDL_GPUVertexAttribute& b) { return a.location < b.location; });
+    for (const auto& s : streams)
+        for (uint32_t loc : s.locations)
+            if (std::none_of(out.attributes.begin(), out.attributes.end(), [&](const SDL_GPUVertexAttribute& a) { return a.location == loc; })) return false;
+
+    std::vector<uint32_t> offsets(streams.size(), 0);
+    for (auto& a : out.attributes) {
+        size_t si = 0;
+        bool found = false;
+        for (size_t i = 0; i < streams.size(); i++) {
+            if (std::find(streams[i].locations.begin(), streams[i].locations.end(), a.location) == streams[i].locations.end()) continue;
+            if (found) return false;
+            si = i;
+            found = true;
+        }
+        a.buffer_slot = streams[si].slot;
+        a.offset = offsets[si];
+        offsets[si] += vertex_format_size(a.format);
+    }
+
+    out.buffers.clear();
+    for (size_t i = 0; i < streams.size(); i++) {
+        if (offsets[i] == 0 || (streams[i].pitch && streams[i].pitch < offsets[i])) return false;
+        SDL_GPUVertexBufferDescription d{};
+        d.slot = streams[i].slot;
+        d.pitch = streams[i].pitch ? streams[i].pitch : offsets[i];
+        d.input_rate = streams[i].input_rate;
+        d.instance_step_rate = 0;
+        out.buffers.push_back(d);
+    }
+    return true;
+}
+
+static bool layout_error(std::string* error, const char* fmt, uint32_t a, uint32_t b = 0) {
+    if (error) {
+        char buf[160];
+        std::snprintf(buf, sizeof(buf), fmt, a, b);
+        *error = buf;
     }
-    out.buffer_desc.slot = 0;
-    out.buffer_desc.pitch = off;
-    out.buffer_desc.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX;
-    out.buffer_desc.instance_step_rate = 0;
+    return false;
+}
+
+// Replaces the reflected layout with the one spelled out in the pipeline JSON,
+// after checking it against what the shader actually consumes.
+bool apply_manual_layout(ReflectedVertexInput& out, const std::vector<VertexStream>& streams, std::string* error) {
+    std::vector<SDL_GPUVertexAttribute> attrs;
+    out.buffers.clear();
+    for (const auto& s : streams) {
+        uint32_t end = 0;
+        for (const auto& ma : s.attributes) {
+            auto it = std::find_if(out.attributes.begin(), out.attributes.end(),
+                [&](const SDL_GPUVertexAttribute& a) { return a.location == ma.location; });
+            if (it == out.attributes.end()) return layout_error(error, "location %u is not a vertex shader input", ma.location);
+            if (std::any_of(attrs.begin(), attrs.end(), [&](const SDL_GPUVertexAttribute& a) { return a.location == ma.location; }))
+                return layout_error(error, "location %u is laid out twice", ma.location);
+            uint32_t size = vertex_format_size(ma.format);
+            if (size == 0) return layout_error(error, "location %u has an invalid format", ma.location);
+            if (fmt_class(ma.format) != fmt_class(it->format))
+                return layout_error(error, "location %u: format does not match the shader input type", ma.location);
+            if (ma.offset % 4) return layout_error(error, "location %u: offset %u is not 4-byte aligned", ma.location, ma.offset);
+            SDL_GPUVertexAttribute a{};
+            a.location = ma.location;
+            a.buffer_slot = s.slot;
+            a.format = ma.format;
+            a.offset = ma.offset;
+            attrs.push_back(a);
+            end = std::max(end, ma.offset + size);
+        }
+        if (end == 0) return layout_error(error, "stream for slot %u has no attributes", s.slot);
+        if (s.pitch && s.pitch < end) return layout_error(error, "slot %u: pitch is smaller than its attributes (%u bytes)", s.slot, end);
+        SDL_GPUVertexBufferDescription d{};
+        d.slot = s.slot;
+        d.pitch = s.pitch ? s.pitch : (end + 3u) & ~3u;
+        d.input_rate = s.input_rate;
+        d.instance_step_rate = 0;
+        out.buffers.push_back(d);
+    }
+    for (const auto& a : out.attributes)
+        if (std::none_of(attrs.begin(), attrs.end(), [&](const SDL_GPUVertexAttribute& m) { return m.location == a.location; }))
+            return layout_error(error, "vertex shader input %u has no layout", a.location);
+    out.attributes = std::move(attrs);
+    return true;
 }
 
 bool reflect_vertex_input(const std::vector<uint32_t>& spirv, ReflectedVertexInput& out) {
@@ -59,7 +202,8 @@ bool reflect_vertex_input(const std::vector<uint32_t>& spirv, ReflectedVertexInp
     if (m.shader_stage != SPV_REFLECT_SHADER_STAGE_VERTEX_BIT) { spvReflectDestroyShaderModule(&m); return false; }
     uint32_t count = 0;
     spvReflectEnumerateInputVariables(&m, &count, nullptr);
-    std::vector<SpvReflectInterfaceVariable*> vars(count);
+    ArenaScope scratch(arena_scratch());
+    ArenaVector<SpvReflectInterfaceVariable*> vars(count, nullptr, ArenaAllocator<SpvReflectInterfaceVariable*>(scratch.arena));
     spvReflectEnumerateInputVariables(&m, &count, vars.data());
     vars.erase(std::remove_if(vars.begin(), vars.end(), [](auto* v){ return v->decoration_flags & SPV_REFLECT_DECORATION_BUILT_IN; }), vars.end());
     std::sort(vars.begin(), vars.end(), [](auto* a, auto* b){ return a->location < b->location; });
@@ -74,12 +218,14 @@ bool reflect_vertex_input(const std::vector<uint32_t>& spirv, ReflectedVertexInp
         a.format = fmt;
         a.offset = offset;
         out.attributes.push_back(a);
-        offset += sdl_fmt_size(fmt);
+        offset += vertex_format_size(fmt);
     }
-    out.buffer_desc.slot = 0;
-    out.buffer_desc.pitch = offset;
-    out.buffer_desc.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX;
-    out.buffer_desc.instance_step_rate = 0;
+    SDL_GPUVertexBufferDescription d{};
+    d.slot = 0;
+    d.pitch = offset;
+    d.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX;
+    d.instance_step_rate = 0;
+    out.buffers.assign(1, d);
     spvReflectDestroyShaderModule(&m);
     return true;
 }
@@ -89,7 +235,8 @@ bool reflect_resources(const std::vector<uint32_t>& spirv, ReflectedResources& o
     if (spvReflectCreateShaderModule(spirv.size() * 4, spirv.data(), &m) != SPV_REFLECT_RESULT_SUCCESS) return false;
     uint32_t bind_count = 0;
     spvReflectEnumerateDescriptorBindings(&m, &bind_count, nullptr);
-    std::vector<SpvReflectDescriptorBinding*> binds(bind_count);
+    ArenaScope scratch(arena_scratch());
+    ArenaVector<SpvReflectDescriptorBinding*> binds(bind_count, nullptr, ArenaAllocator<SpvReflectDescriptorBinding*>(scratch.arena));
     spvReflectEnumerateDescriptorBindings(&m, &bind_count, binds.data());
     for (auto* b : binds) {
         switch (b->descriptor_type) {
@@ -115,7 +262,7 @@ bool reflect_resources(const std::vector<uint32_t>& spirv, ReflectedResources& o
     uint32_t pc_count = 0;
     spvReflectEnumeratePushConstantBlocks(&m, &pc_count, nullptr);
     if (pc_count > 0) {
-        std::vector<SpvReflectBlockVariable*> pcs(pc_count);
+        ArenaVector<SpvReflectBlockVariable*> pcs(pc_count, nullptr, ArenaAllocator<SpvReflectBlockVariable*>(scratch.arena));
         spvReflectEnumeratePushConstantBlocks(&m, &pc_count, pcs.data());
         for (auto* pc : pcs) if (pc && pc->size > out.push_constant_size) out.push_constant_size = pc->size;
     }
@@ -152,3 +299,94 @@ static SDL_GPUSampleCount choose_supported(SDL_GPUDevice* device_ptr, SDL_GPUTex
     return SDL_GPU_SAMPLECOUNT_1;
 }
 
+
+bool reflect_compute(const std::vector<uint32_t>& spirv, ReflectedCompute& out, std::string* error) {
+    SpvReflectShaderModule m{};
+    if (spvReflectCreateShaderModule(spirv.size() * 4, spirv.data(), &m) != SPV_REFLECT_RESULT_SUCCESS)
+        return layout_error(error, "not a valid SPIR-V module", 0);
+    if (m.shader_stage != SPV_REFLECT_SHADER_STAGE_COMPUTE_BIT || m.entry_point_count == 0) {
+        spvReflectDestroyShaderModule(&m);
+        return layout_error(error, "not a compute shader", 0);
+    }
+    out = ReflectedCompute{};
+    out.threadcount_x = std::max(1u, m.entry_points[0].local_size.x);
+    out.threadcount_y = std::max(1u, m.entry_points[0].local_size.y);
+    out.threadcount_z = std::max(1u, m.entry_points[0].local_size.z);
+
+    uint32_t bind_count = 0;
+    spvReflectEnumerateDescriptorBindings(&m, &bind_count, nullptr);
+    ArenaScope scratch(arena_scratch());
+    ArenaVector<SpvReflectDescriptorBinding*> binds(bind_count, nullptr, ArenaAllocator<SpvReflectDescriptorBinding*>(scratch.arena));
+    spvReflectEnumerateDescriptorBindings(&m, &bind_count, binds.data());
+    bool ok = true;
+    for (auto* b : binds) {
+        switch (b->descriptor_type) {
+            case SPV_REFLECT_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+            case SPV_REFLECT_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+                if (b->set != 0) ok = layout_error(error, "sampler at binding %u must be in set 0, not %u", b->binding, b->set);
+                out.num_samplers += b->count;
+                break;
+            case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+                if (b->set == 0) out.num_readonly_storage_textures += b->count;
+                else if (b->set == 1) out.num_readwrite_storage_textures += b->count;
+                else ok = layout_error(error, "storage image at binding %u is in set %u", b->binding, b->set);
+                break;
+            case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+            case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+                if (b->set == 0) out.num_readonly_storage_buffers += b->count;
+                else if (b->set == 1) out.num_readwrite_storage_buffers += b->count;
+                else ok = layout_error(error, "storage buffer at binding %u is in set %u", b->binding, b->set);
+                break;
+            case SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            case SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+                if (b->set != 2) ok = layout_error(error, "uniform buffer at binding %u must be in set 2, not %u", b->binding, b->set);
+                out.num_uniform_buffers += b->count;
+                break;
+            default: break;
+        }
+        if (!ok) break;
+    }
+    spvReflectDestroyShaderModule(&m);
+    return ok;
+}
+
+static void flatten_members(const SpvReflectBlockVariable& block, const std::string& prefix, uint32_t base, std::vector<ReflectedUniformMember>& out) {
+    for (uint32_t i = 0; i < block.member_count; i++) {
+        const SpvReflectBlockVariable& m = block.members[i];
+        std::string name = prefix + (m.name ? m.name : "");
+        if (m.member_count && m.array.dims_count == 0) {
+            flatten_members(m, name + ".", base + m.offset, out);
+            continue;
+        }
+        ReflectedUniformMember r;
+        r.name = name;
+        r.offset = base + m.offset;
+        r.size = m.size;
+        out.push_back(r);
+    }
+}
+
+bool reflect_uniform_blocks(const std::vector<uint32_t>& spirv, std::vector<ReflectedUniformBlock>& out) {
+    SpvReflectShaderModule m{};
+    if (spvReflectCreateShaderModule(spirv.size() * 4, spirv.data(), &m) != SPV_REFLECT_RESULT_SUCCESS) return false;
+    uint32_t bind_count = 0;
+    spvReflectEnumerateDescriptorBindings(&m, &bind_count, nullptr);
+    ArenaScope scratch(arena_scratch());
+    ArenaVector<SpvReflectDescriptorBinding*> binds(bind_count, nullptr, ArenaAllocator<SpvReflectDescriptorBinding*>(scratch.arena));
+    spvReflectEnumerateDescriptorBindings(&m, &bind_count, binds.data());
+    out.clear();
+    for (auto* b : binds) {
+        if (b->descriptor_type != SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER) continue;
+        ReflectedUniformBlock block;
+        const char* type_name = b->type_description ? b->type_description->type_name : nullptr;
+        block.name = type_name ? type_name : (b->name ? b->name : "");
+        block.set = b->set;
+        block.slot = b->binding;
+        block.size = b->block.padded_size ? b->block.padded_size : b->block.size;
+        flatten_members(b->block, "", 0, block.members);
+        out.push_back(block);
+    }
+    std::sort(out.begin(), out.end(), [](const ReflectedUniformBlock& a, const ReflectedUniformBlock& b) { return a.slot < b.slot; });
+    spvReflectDestroyShaderModule(&m);
+    return true;
+}
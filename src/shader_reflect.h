@@ -1,11 +1,29 @@
 #pragma once
 #include <vector>
 #include <cstdint>
+#include <string>
 #include <SDL3/SDL_gpu.h>
 
 struct ReflectedVertexInput {
     std::vector<SDL_GPUVertexAttribute> attributes;
-    SDL_GPUVertexBufferDescription buffer_desc{};
+    std::vector<SDL_GPUVertexBufferDescription> buffers;
+};
+
+// One vertex buffer slot of a pipeline. With an automatic layout, reflected
+// attributes whose location is listed go to this slot and unlisted locations
+// go to the first stream. A manual layout spells out every attribute instead.
+struct VertexStream {
+    struct Attribute {
+        Uint32 location = 0;
+        SDL_GPUVertexElementFormat format = SDL_GPU_VERTEXELEMENTFORMAT_INVALID;
+        Uint32 offset = 0;
+    };
+
+    Uint32 slot = 0;
+    SDL_GPUVertexInputRate input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX;
+    Uint32 pitch = 0;
+    std::vector<Uint32> locations;
+    std::vector<Attribute> attributes;
 };
 
 struct ReflectedResources {
@@ -16,7 +34,43 @@ struct ReflectedResources {
     uint32_t push_constant_size = 0;
 };
 
+// Compute resources as SDL binds them from SPIR-V: set 0 holds samplers and
+// read-only storage, set 1 read-write storage, set 2 uniform buffers.
+struct ReflectedCompute {
+    uint32_t threadcount_x = 1;
+    uint32_t threadcount_y = 1;
+    uint32_t threadcount_z = 1;
+    uint32_t num_samplers = 0;
+    uint32_t num_readonly_storage_textures = 0;
+    uint32_t num_readonly_storage_buffers = 0;
+    uint32_t num_readwrite_storage_textures = 0;
+    uint32_t num_readwrite_storage_buffers = 0;
+    uint32_t num_uniform_buffers = 0;
+};
+
+// One uniform block member, nested struct members flattened as "outer.inner".
+struct ReflectedUniformMember {
+    std::string name;
+    uint32_t offset = 0;
+    uint32_t size = 0;
+};
+
+// A uniform block; `slot` is its binding, the slot SDL pushes it to.
+struct ReflectedUniformBlock {
+    std::string name;
+    // Descriptor set and binding.
+    uint32_t set = 0;
+    uint32_t slot = 0;
+    uint32_t size = 0;
+    std::vector<ReflectedUniformMember> members;
+};
+
 bool reflect_vertex_input(const std::vector<uint32_t>& spirv, ReflectedVertexInput& out);
 bool reflect_resources(const std::vector<uint32_t>& spirv, ReflectedResources& out);
+bool reflect_uniform_blocks(const std::vector<uint32_t>& spirv, std::vector<ReflectedUniformBlock>& out);
+bool reflect_compute(const std::vector<uint32_t>& spirv, ReflectedCompute& out, std::string* error = nullptr);
 
 void pack_tight(ReflectedVertexInput& out);
+bool pack_streams(ReflectedVertexInput& out, const std::vector<VertexStream>& streams);
+bool apply_manual_layout(ReflectedVertexInput& out, const std::vector<VertexStream>& streams, std::string* error = nullptr);
+uint32_t vertex_format_size(SDL_GPUVertexElementFormat f);
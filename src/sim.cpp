@@ -0,0 +1,146 @@
+#include "sim.h"
+#include <cmath>
+
+namespace {
+
+const Uint32 DIRTY = 4;
+
+// Each instance circles its grid cell and breathes a little; the step is a
+// plain integration of the phase so its cost is per tick, not per frame.
+void step(Simulation& sim, std::vector<float>& pose, float dt) {
+    Uint32 count = (Uint32)sim.phase.size();
+    for (Uint32 i = 0; i < count; i++) {
+        float w = 0.8f + 0.15f * (float)(i % 7);
+        sim.phase[i] += w * dt;
+        float s = sim.base[i * 3 + 2];
+        float r = 0.25f * s;
+        pose[i * 3 + 0] = sim.base[i * 3 + 0] + r * std::cos(sim.phase[i]);
+        pose[i * 3 + 1] = sim.base[i * 3 + 1] + r * std::sin(sim.phase[i]);
+        pose[i * 3 + 2] = s * (0.85f + 0.15f * std::sin(2.0f * sim.phase[i]));
+    }
+}
+
+void publish(Simulation& sim) {
+    Uint32 old = sim.middle.exchange(sim.back | DIRTY, std::memory_order_acq_rel);
+    sim.back = old & 3;
+}
+
+void sim_main(Simulation* sim) {
+    const Uint64 dt = sim->dt_ns;
+    const float dt_s = (float)((double)dt / 1e9);
+    std::vector<float> pose = sim->base;
+    Uint64 tick = 0;
+    Uint64 next = SDL_GetTicksNS();
+    Uint64 window_start = next;
+    Uint64 window_ticks = 0;
+
+    while (!sim->quit.load()) {
+        if (!sim->running.load()) {
+            SDL_Delay(10);
+            next = SDL_GetTicksNS();
+            window_start = next;
+            window_ticks = 0;
+            std::lock_guard<std::mutex> lock(sim->stats_mutex);
+            sim->stats.backlog = 0;
+            sim->stats.tick_hz = 0.0;
+            continue;
+        }
+        Uint64 now = SDL_GetTicksNS();
+        if (now < next) {
+            SDL_DelayNS(next - now);
+            continue;
+        }
+
+        Uint32 ran = 0;
+        Uint64 step_ns = 0;
+        while (next <= now && ran < sim->max_catchup) {
+            SimState& out = sim->states[sim->back];
+            out.prev = pose;
+            Uint64 t0 = SDL_GetTicksNS();
+            step(*sim, pose, dt_s);
+            step_ns += SDL_GetTicksNS() - t0;
+            out.curr = pose;
+            out.tick = ++tick;
+            out.time_ns = next;
+            publish(*sim);
+            next += dt;
+            ran++;
+        }
+
+        Uint64 behind = next <= now ? (now - next) / dt + 1 : 0;
+        Uint64 dropped = 0;
+        if (behind > sim->max_catchup) {
+            dropped = behind;
+            behind = 0;
+            next = now + dt;
+        }
+
+        window_ticks += ran;
+        std::lock_guard<std::mutex> lock(sim->stats_mutex);
+        SimStats& st = sim->stats;
+        st.ticks += ran;
+        st.dropped += dropped;
+        st.backlog = (Uint32)behind;
+        st.max_backlog = SDL_max(st.max_backlog, (Uint32)behind);
+        if (ran) st.step_ms = (double)step_ns / 1e6 / ran;
+        if (now - window_start >= 1000000000ull) {
+            st.tick_hz = (double)window_ticks * 1e9 / (double)(now - window_start);
+            window_start = now;
+            window_ticks = 0;
+        }
+    }
+}
+
+}
+
+bool sim_start(Simulation& sim, const float* instances, Uint32 count, Uint32 tick_hz) {
+    if (tick_hz == 0 || count == 0) return false;
+    sim_stop(sim);
+    sim.dt_ns = 1000000000ull / tick_hz;
+    sim.base.assign(instances, instances + (size_t)count * 3);
+    sim.phase.assign(count, 0.0f);
+    for (Uint32 i = 0; i < count; i++) sim.phase[i] = 0.61803f * (float)i;
+    for (SimState& s : sim.states) {
+        s.tick = 0;
+        s.time_ns = SDL_GetTicksNS();
+        s.prev = sim.base;
+        s.curr = sim.base;
+    }
+    sim.front = 0;
+    sim.middle.store(1);
+    sim.back = 2;
+    sim.quit.store(false);
+    sim.stats = SimStats{};
+    sim.thread = std::thread(sim_main, &sim);
+    return true;
+}
+
+void sim_stop(Simulation& sim) {
+    if (!sim.thread.joinable()) return;
+    sim.quit.store(true);
+    sim.thread.join();
+}
+
+void sim_set_running(Simulation& sim, bool running) {
+    sim.running.store(running);
+}
+
+const SimState& sim_acquire(Simulation& sim) {
+    if (sim.middle.load(std::memory_order_acquire) & DIRTY)
+        sim.front = sim.middle.exchange(sim.front, std::memory_order_acq_rel) & 3;
+    return sim.states[sim.front];
+}
+
+float sim_interpolate(const Simulation& sim, const SimState& state, Uint64 now_ns, std::vector<float>& out) {
+    float alpha = 1.0f;
+    if (now_ns < state.time_ns) alpha = 0.0f;
+    else if (now_ns - state.time_ns < sim.dt_ns) alpha = (float)((double)(now_ns - state.time_ns) / (double)sim.dt_ns);
+    out.resize(state.curr.size());
+    for (size_t i = 0; i < out.size(); i++) out[i] = state.prev[i] + (state.curr[i] - state.prev[i]) * alpha;
+    return alpha;
+}
+
+SimStats sim_stats(Simulation& sim) {
+    std::lock_guard<std::mutex> lock(sim.stats_mutex);
+    return sim.stats;
+}
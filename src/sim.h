@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <SDL3/SDL.h>
+
+// One published tick: instance data (offset.xy, scale) for this tick and the
+// one before it, so a reader can interpolate without keeping history.
+struct SimState {
+    Uint64 tick = 0;
+    Uint64 time_ns = 0;
+    std::vector<float> prev;
+    std::vector<float> curr;
+};
+
+struct SimStats {
+    double tick_hz = 0.0;
+    double step_ms = 0.0;
+    Uint32 backlog = 0;
+    Uint32 max_backlog = 0;
+    Uint64 ticks = 0;
+    Uint64 dropped = 0;
+};
+
+// Fixed-timestep simulation on its own thread. States go through a triple
+// buffer: the simulation writes one, the reader holds one, and the third is
+// the latest complete tick, swapped in by index so neither side waits.
+struct Simulation {
+    std::thread thread;
+    std::atomic<bool> quit{ false };
+    std::atomic<bool> running{ false };
+    Uint64 dt_ns = 0;
+    // Ticks the thread runs back to back before it gives up on catching up
+    // and drops the rest of the backlog.
+    Uint32 max_catchup = 8;
+
+    SimState states[3];
+    std::atomic<Uint32> middle{ 1 };
+    Uint32 back = 2;
+    Uint32 front = 0;
+
+    // Simulation-private: grid positions and per-instance phase.
+    std::vector<float> base;
+    std::vector<float> phase;
+
+    std::mutex stats_mutex;
+    SimStats stats;
+};
+
+// `instances` is count * (offset.xy, scale), the rest pose.
+bool sim_start(Simulation& sim, const float* instances, Uint32 count, Uint32 tick_hz);
+void sim_stop(Simulation& sim);
+void sim_set_running(Simulation& sim, bool running);
+
+// Reader side, one thread only: the newest complete state. Never blocks.
+const SimState& sim_acquire(Simulation& sim);
+// Blends prev -> curr, rendering one tick behind the newest tick so there is
+// always a state on each side of `now_ns`. Returns the blend factor.
+float sim_interpolate(const Simulation& sim, const SimState& state, Uint64 now_ns, std::vector<float>& out);
+
+SimStats sim_stats(Simulation& sim);
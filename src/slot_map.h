@@ -0,0 +1,88 @@
+#pragma once
+#include <utility>
+#include <vector>
+#include <SDL3/SDL.h>
+
+// Names a value in a SlotMap<T>: the slot it was issued from and the slot's
+// generation at the time. The zero handle is never issued.
+template <typename T>
+struct SlotHandle {
+    Uint32 index = 0;
+    Uint32 generation = 0;
+};
+
+template <typename T>
+bool slot_handle_valid(SlotHandle<T> h) {
+    return h.generation != 0;
+}
+
+// Values packed in `values`, in no particular order, for iteration; handles
+// stay valid across inserts and removals of other values. Removal moves the
+// last value into the hole and repoints its slot. Each removal bumps the
+// slot's generation, so a stale handle resolves to null rather than to a
+// later value reusing the slot. Pointers into `values` are only good until
+// the next insert or removal; hold handles instead.
+template <typename T>
+struct SlotMap {
+    struct Slot {
+        Uint32 dense = 0;
+        Uint32 generation = 1;
+    };
+    std::vector<T> values;
+    std::vector<Uint32> value_slots;
+    std::vector<Slot> slots;
+    std::vector<Uint32> free_slots;
+};
+
+template <typename T>
+SlotHandle<T> slot_map_insert(SlotMap<T>& map, T value) {
+    Uint32 index;
+    if (!map.free_slots.empty()) {
+        index = map.free_slots.back();
+        map.free_slots.pop_back();
+    } else {
+        index = (Uint32)map.slots.size();
+        map.slots.emplace_back();
+    }
+    map.slots[index].dense = (Uint32)map.values.size();
+    map.values.push_back(std::move(value));
+    map.value_slots.push_back(index);
+    return SlotHandle<T>{ index, map.slots[index].generation };
+}
+
+template <typename T>
+T* slot_map_get(SlotMap<T>& map, SlotHandle<T> h) {
+    if (h.index >= map.slots.size() || map.slots[h.index].generation != h.generation) return nullptr;
+    return &map.values[map.slots[h.index].dense];
+}
+
+template <typename T>
+const T* slot_map_get(const SlotMap<T>& map, SlotHandle<T> h) {
+    if (h.index >= map.slots.size() || map.slots[h.index].generation != h.generation) return nullptr;
+    return &map.values[map.slots[h.index].dense];
+}
+
+// Handle of the value at `values[dense]`.
+template <typename T>
+SlotHandle<T> slot_map_handle_at(const SlotMap<T>& map, size_t dense) {
+    Uint32 index = map.value_slots[dense];
+    return SlotHandle<T>{ index, map.slots[index].generation };
+}
+
+template <typename T>
+bool slot_map_remove(SlotMap<T>& map, SlotHandle<T> h) {
+    if (!slot_map_get(map, h)) return false;
+    Uint32 dense = map.slots[h.index].dense;
+    Uint32 last = (Uint32)map.values.size() - 1;
+    if (dense != last) {
+        map.values[dense] = std::move(map.values[last]);
+        map.value_slots[dense] = map.value_slots[last];
+        map.slots[map.value_slots[dense]].dense = dense;
+    }
+    map.values.pop_back();
+    map.value_slots.pop_back();
+    // Generation 0 is reserved for the zero handle.
+    if (++map.slots[h.index].generation == 0) map.slots[h.index].generation = 1;
+    map.free_slots.push_back(h.index);
+    return true;
+}
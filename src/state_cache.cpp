@@ -0,0 +1,80 @@
+#include "state_cache.h"
+#include <cstring>
+#include <SDL3/SDL.h>
+
+namespace {
+
+// Field by field, so padding bytes and props never split two equal infos.
+struct Key {
+    Uint32 words[12];
+    Uint32 count = 0;
+
+    void add(Uint32 v) { words[count++] = v; }
+    void add(float v) {
+        Uint32 bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        add(bits);
+    }
+    bool operator==(const Key& o) const { return count == o.count && std::memcmp(words, o.words, count * sizeof(Uint32)) == 0; }
+};
+
+Key key_of(const SDL_GPUSamplerCreateInfo& s) {
+    Key k;
+    k.add((Uint32)s.min_filter);
+    k.add((Uint32)s.mag_filter);
+    k.add((Uint32)s.mipmap_mode);
+    k.add((Uint32)s.address_mode_u);
+    k.add((Uint32)s.address_mode_v);
+    k.add((Uint32)s.address_mode_w);
+    k.add(s.mip_lod_bias);
+    k.add(s.enable_anisotropy ? s.max_anisotropy : 0.0f);
+    k.add(s.enable_compare ? (Uint32)s.compare_op : 0u);
+    k.add(s.min_lod);
+    k.add(s.max_lod);
+    k.add((Uint32)s.enable_anisotropy | (Uint32)s.enable_compare << 1);
+    return k;
+}
+
+}
+
+void state_cache_init(StateCache& cache, SDL_GPUDevice* device) {
+    state_cache_destroy(cache);
+    cache.device = device;
+}
+
+void state_cache_destroy(StateCache& cache) {
+    for (SDL_GPUSampler* s : cache.samplers)
+        if (s) SDL_ReleaseGPUSampler(cache.device, s);
+    cache.samplers.clear();
+    cache.infos.clear();
+    cache.index.clear();
+    cache.hits = 0;
+}
+
+Uint32 state_cache_sampler(StateCache& cache, const SDL_GPUSamplerCreateInfo& info) {
+    Key key = key_of(info);
+    Uint32 hash = SDL_murmur3_32(key.words, key.count * sizeof(Uint32), 0);
+    auto range = cache.index.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (key_of(cache.infos[it->second]) == key) {
+            cache.hits++;
+            // A failed creation stays cached as null so it is not retried every call.
+            return cache.samplers[it->second] ? it->second + 1 : 0;
+        }
+    }
+    cache.infos.push_back(info);
+    cache.samplers.push_back(SDL_CreateGPUSampler(cache.device, &info));
+    cache.index.emplace(hash, (Uint32)cache.samplers.size() - 1);
+    return cache.samplers.back() ? (Uint32)cache.samplers.size() : 0;
+}
+
+SDL_GPUSampler* state_cache_get_sampler(const StateCache& cache, Uint32 id) {
+    return id && id <= cache.samplers.size() ? cache.samplers[id - 1] : nullptr;
+}
+
+StateCacheStats state_cache_stats(const StateCache& cache) {
+    StateCacheStats st;
+    st.samplers = (Uint32)cache.samplers.size();
+    st.hits = cache.hits;
+    return st;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include <SDL3/SDL_gpu.h>
+
+struct StateCacheStats {
+    Uint32 samplers = 0;
+    // Lookups answered by an existing entry.
+    Uint64 hits = 0;
+};
+
+// Deduplicates samplers: driver objects, created once per distinct
+// SDL_GPUSamplerCreateInfo. Ids start at 1 and stay valid until the cache is
+// destroyed. Main thread only.
+struct StateCache {
+    SDL_GPUDevice* device = nullptr;
+    std::unordered_multimap<Uint32, Uint32> index;
+    std::vector<SDL_GPUSamplerCreateInfo> infos;
+    std::vector<SDL_GPUSampler*> samplers;
+    Uint64 hits = 0;
+};
+
+void state_cache_init(StateCache& cache, SDL_GPUDevice* device);
+// Releases every sampler; the caller makes sure no frame still uses them.
+void state_cache_destroy(StateCache& cache);
+
+// 0 when the sampler cannot be created.
+Uint32 state_cache_sampler(StateCache& cache, const SDL_GPUSamplerCreateInfo& info);
+SDL_GPUSampler* state_cache_get_sampler(const StateCache& cache, Uint32 id);
+
+StateCacheStats state_cache_stats(const StateCache& cache);
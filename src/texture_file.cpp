@@ -0,0 +1,316 @@
+#include "texture_file.h"
+#include <cstring>
+#include <SDL3/SDL.h>
+
+namespace {
+
+struct FormatInfo {
+    SDL_GPUTextureFormat format;
+    const char* name;
+    Uint32 block_w, block_h, block_bytes;
+    Uint32 dxgi;
+    Uint32 vk;
+};
+
+#define ASTC(w, h, vk) \
+    { SDL_GPU_TEXTUREFORMAT_ASTC_##w##x##h##_UNORM, "ASTC " #w "x" #h, w, h, 16, 0, vk }, \
+    { SDL_GPU_TEXTUREFORMAT_ASTC_##w##x##h##_UNORM_SRGB, "ASTC " #w "x" #h " sRGB", w, h, 16, 0, vk + 1 }
+
+// DXGI_FORMAT and VkFormat values of the formats this loader accepts.
+const FormatInfo FORMATS[] = {
+    { SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM, "RGBA8", 1, 1, 4, 28, 37 },
+    { SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM_SRGB, "RGBA8 sRGB", 1, 1, 4, 29, 43 },
+    { SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM, "BC1", 4, 4, 8, 71, 133 },
+    { SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM, "BC1", 4, 4, 8, 0, 131 },
+    { SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM_SRGB, "BC1 sRGB", 4, 4, 8, 72, 134 },
+    { SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM_SRGB, "BC1 sRGB", 4, 4, 8, 0, 132 },
+    { SDL_GPU_TEXTUREFORMAT_BC2_RGBA_UNORM, "BC2", 4, 4, 16, 74, 135 },
+    { SDL_GPU_TEXTUREFORMAT_BC2_RGBA_UNORM_SRGB, "BC2 sRGB", 4, 4, 16, 75, 136 },
+    { SDL_GPU_TEXTUREFORMAT_BC3_RGBA_UNORM, "BC3", 4, 4, 16, 77, 137 },
+    { SDL_GPU_TEXTUREFORMAT_BC3_RGBA_UNORM_SRGB, "BC3 sRGB", 4, 4, 16, 78, 138 },
+    { SDL_GPU_TEXTUREFORMAT_BC4_R_UNORM, "BC4", 4, 4, 8, 80, 139 },
+    { SDL_GPU_TEXTUREFORMAT_BC5_RG_UNORM, "BC5", 4, 4, 16, 83, 141 },
+    { SDL_GPU_TEXTUREFORMAT_BC6H_RGB_UFLOAT, "BC6H", 4, 4, 16, 95, 143 },
+    { SDL_GPU_TEXTUREFORMAT_BC6H_RGB_FLOAT, "BC6H signed", 4, 4, 16, 96, 144 },
+    { SDL_GPU_TEXTUREFORMAT_BC7_RGBA_UNORM, "BC7", 4, 4, 16, 98, 145 },
+    { SDL_GPU_TEXTUREFORMAT_BC7_RGBA_UNORM_SRGB, "BC7 sRGB", 4, 4, 16, 99, 146 },
+    ASTC(4, 4, 157), ASTC(5, 4, 159), ASTC(5, 5, 161), ASTC(6, 5, 163), ASTC(6, 6, 165),
+    ASTC(8, 5, 167), ASTC(8, 6, 169), ASTC(8, 8, 171), ASTC(10, 5, 173), ASTC(10, 6, 175),
+    ASTC(10, 8, 177), ASTC(10, 10, 179), ASTC(12, 10, 181), ASTC(12, 12, 183),
+};
+
+#undef ASTC
+
+const FormatInfo* find_dxgi(Uint32 dxgi) {
+    // DXGI_FORMAT_UNKNOWN, which is also how rows without a DXGI code are
+    // marked.
+    if (dxgi == 0) return nullptr;
+    for (const FormatInfo& f : FORMATS)
+        if (f.dxgi == dxgi) return &f;
+    return nullptr;
+}
+
+const FormatInfo* find_vk(Uint32 vk) {
+    for (const FormatInfo& f : FORMATS)
+        if (f.vk == vk) return &f;
+    return nullptr;
+}
+
+const FormatInfo* find_format(SDL_GPUTextureFormat format) {
+    for (const FormatInfo& f : FORMATS)
+        if (f.format == format) return &f;
+    return nullptr;
+}
+
+Uint32 u32(const Uint8* p) {
+    Uint32 v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+Uint64 u64(const Uint8* p) {
+    Uint64 v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+constexpr Uint32 fourcc(char a, char b, char c, char d) {
+    return (Uint32)(Uint8)a | (Uint32)(Uint8)b << 8 | (Uint32)(Uint8)c << 16 | (Uint32)(Uint8)d << 24;
+}
+
+bool fail(std::string* error, const char* msg) {
+    if (error) *error = msg;
+    return false;
+}
+
+Uint32 level_bytes(const FormatInfo& f, Uint32 w, Uint32 h) {
+    return ((w + f.block_w - 1) / f.block_w) * ((h + f.block_h - 1) / f.block_h) * f.block_bytes;
+}
+
+void set_format(TextureFile& out, const FormatInfo& f, Uint32 w, Uint32 h) {
+    out.format = f.format;
+    out.format_name = f.name;
+    out.block_w = f.block_w;
+    out.block_h = f.block_h;
+    out.block_bytes = f.block_bytes;
+    out.width = w;
+    out.height = h;
+    out.levels = 0;
+}
+
+// Appends level `l` unless it is smaller than a block or does not fit.
+bool add_level(TextureFile& out, const FormatInfo& f, Uint64 offset, Uint64 available, size_t file_size) {
+    Uint32 l = out.levels;
+    Uint32 w = SDL_max(out.width >> l, 1u), h = SDL_max(out.height >> l, 1u);
+    if (l >= TEXTURE_FILE_MAX_LEVELS || w % f.block_w || h % f.block_h) return false;
+    Uint32 size = level_bytes(f, w, h);
+    if (size > available || offset > file_size || size > file_size - offset) return false;
+    out.level[l] = TextureFileLevel{ offset, size, w, h };
+    out.levels++;
+    return true;
+}
+
+bool parse_dds(const Uint8* data, size_t size, TextureFile& out, std::string* error) {
+    if (size < 128 || u32(data + 4) != 124) return fail(error, "truncated DDS header");
+    Uint32 flags = u32(data + 8);
+    Uint32 height = u32(data + 12), width = u32(data + 16);
+    Uint32 mips = (flags & 0x20000) ? SDL_max(u32(data + 28), 1u) : 1;
+    Uint32 pf_flags = u32(data + 80), code = u32(data + 84);
+    Uint32 caps2 = u32(data + 112);
+    if (caps2 & (0x200 | 0x200000)) return fail(error, "DDS cube maps and volumes are not supported");
+
+    const FormatInfo* f = nullptr;
+    Uint64 offset = 128;
+    if ((pf_flags & 0x4) && code == fourcc('D', 'X', '1', '0')) {
+        if (size < 148) return fail(error, "truncated DDS DX10 header");
+        if (u32(data + 132) != 3 || (u32(data + 136) & 0x4) || u32(data + 140) > 1)
+            return fail(error, "only single 2D DDS textures are supported");
+        f = find_dxgi(u32(data + 128));
+        offset = 148;
+    } else if (pf_flags & 0x4) {
+        if (code == fourcc('D', 'X', 'T', '1')) f = find_dxgi(71);
+        else if (code == fourcc('D', 'X', 'T', '3')) f = find_dxgi(74);
+        else if (code == fourcc('D', 'X', 'T', '5')) f = find_dxgi(77);
+        else if (code == fourcc('A', 'T', 'I', '1') || code == fourcc('B', 'C', '4', 'U')) f = find_dxgi(80);
+        else if (code == fourcc('A', 'T', 'I', '2') || code == fourcc('B', 'C', '5', 'U')) f = find_dxgi(83);
+    } else if ((pf_flags & 0x40) && u32(data + 88) == 32 && u32(data + 92) == 0xff && u32(data + 96) == 0xff00 &&
+               u32(data + 100) == 0xff0000 && u32(data + 104) == 0xff000000u) {
+        f = find_dxgi(28);
+    }
+    if (!f) return fail(error, "unsupported DDS pixel format");
+    if (width == 0 || height == 0) return fail(error, "empty DDS texture");
+
+    set_format(out, *f, width, height);
+    for (Uint32 l = 0; l < mips; l++) {
+        Uint32 w = SDL_max(width >> l, 1u), h = SDL_max(height >> l, 1u);
+        Uint32 bytes = level_bytes(*f, w, h);
+        if (l == out.levels && !add_level(out, *f, offset, bytes, size)) break;
+        offset += bytes;
+    }
+    return out.levels ? true : fail(error, "DDS size is not a multiple of the block size or data is truncated");
+}
+
+bool parse_ktx2(const Uint8* data, size_t size, TextureFile& out, std::string* error) {
+    if (size < 80) return fail(error, "truncated KTX2 header");
+    Uint32 vk = u32(data + 12);
+    Uint32 width = u32(data + 20), height = u32(data + 24), depth = u32(data + 28);
+    Uint32 layers = u32(data + 32), faces = u32(data + 36), mips = SDL_max(u32(data + 40), 1u);
+    Uint32 supercompression = u32(data + 44);
+    if (supercompression != 0) return fail(error, "supercompressed KTX2 (Basis, zstd) is not supported");
+    if (depth > 1 || layers > 1 || faces != 1 || height == 0 || width == 0)
+        return fail(error, "only single 2D KTX2 textures are supported");
+    const FormatInfo* f = find_vk(vk);
+    if (!f) return fail(error, "unsupported KTX2 vkFormat");
+    if (size < 80 + (Uint64)mips * 24) return fail(error, "truncated KTX2 level index");
+
+    set_format(out, *f, width, height);
+    for (Uint32 l = 0; l < mips; l++) {
+        const Uint8* entry = data + 80 + (size_t)l * 24;
+        if (!add_level(out, *f, u64(entry), u64(entry + 8), size)) break;
+    }
+    return out.levels ? true : fail(error, "KTX2 size is not a multiple of the block size or data is truncated");
+}
+
+void rgb565(Uint16 c, Uint8* out) {
+    out[0] = (Uint8)(((c >> 11) & 31) * 255 / 31);
+    out[1] = (Uint8)(((c >> 5) & 63) * 255 / 63);
+    out[2] = (Uint8)((c & 31) * 255 / 31);
+    out[3] = 255;
+}
+
+// Colour half of BC1-BC3. `opaque` forces the four-colour mode, as BC2 and
+// BC3 do.
+void decode_color(const Uint8* b, bool opaque, Uint8 texels[16][4]) {
+    Uint16 c0 = (Uint16)(b[0] | b[1] << 8), c1 = (Uint16)(b[2] | b[3] << 8);
+    Uint8 pal[4][4];
+    rgb565(c0, pal[0]);
+    rgb565(c1, pal[1]);
+    bool four = opaque || c0 > c1;
+    for (int k = 0; k < 3; k++) {
+        pal[2][k] = four ? (Uint8)((2 * pal[0][k] + pal[1][k]) / 3) : (Uint8)((pal[0][k] + pal[1][k]) / 2);
+        pal[3][k] = four ? (Uint8)((pal[0][k] + 2 * pal[1][k]) / 3) : 0;
+    }
+    pal[2][3] = 255;
+    pal[3][3] = four ? 255 : 0;
+    Uint32 idx = u32(b + 4);
+    for (int i = 0; i < 16; i++) std::memcpy(texels[i], pal[(idx >> (2 * i)) & 3], 4);
+}
+
+// BC4 block: one channel from two endpoints and 3-bit indices.
+void decode_channel(const Uint8* b, Uint8 texels[16][4], int channel) {
+    Uint8 pal[8];
+    pal[0] = b[0];
+    pal[1] = b[1];
+    if (pal[0] > pal[1]) {
+        for (int i = 1; i < 7; i++) pal[i + 1] = (Uint8)(((7 - i) * pal[0] + i * pal[1]) / 7);
+    } else {
+        for (int i = 1; i < 5; i++) pal[i + 1] = (Uint8)(((5 - i) * pal[0] + i * pal[1]) / 5);
+        pal[6] = 0;
+        pal[7] = 255;
+    }
+    Uint64 idx = 0;
+    for (int i = 0; i < 6; i++) idx |= (Uint64)b[2 + i] << (8 * i);
+    for (int i = 0; i < 16; i++) texels[i][channel] = pal[(idx >> (3 * i)) & 7];
+}
+
+void decode_block(SDL_GPUTextureFormat format, const Uint8* b, Uint8 texels[16][4]) {
+    switch (format) {
+    case SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM:
+    case SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM_SRGB:
+        decode_color(b, false, texels);
+        break;
+    case SDL_GPU_TEXTUREFORMAT_BC2_RGBA_UNORM:
+    case SDL_GPU_TEXTUREFORMAT_BC2_RGBA_UNORM_SRGB:
+        decode_color(b + 8, true, texels);
+        for (int i = 0; i < 16; i++) texels[i][3] = (Uint8)(((b[i / 2] >> (4 * (i & 1))) & 15) * 17);
+        break;
+    case SDL_GPU_TEXTUREFORMAT_BC3_RGBA_UNORM:
+    case SDL_GPU_TEXTUREFORMAT_BC3_RGBA_UNORM_SRGB:
+        decode_color(b + 8, true, texels);
+        decode_channel(b, texels, 3);
+        break;
+    case SDL_GPU_TEXTUREFORMAT_BC4_R_UNORM:
+        for (int i = 0; i < 16; i++) texels[i][1] = texels[i][2] = 0, texels[i][3] = 255;
+        decode_channel(b, texels, 0);
+        break;
+    case SDL_GPU_TEXTUREFORMAT_BC5_RG_UNORM:
+        for (int i = 0; i < 16; i++) texels[i][2] = 0, texels[i][3] = 255;
+        decode_channel(b, texels, 0);
+        decode_channel(b + 8, texels, 1);
+        break;
+    default:
+        break;
+    }
+}
+
+}
+
+const SDL_GPUTextureFormat TEXTURE_FILE_BLOCK_FORMATS[] = {
+#define X(f) SDL_GPU_TEXTUREFORMAT_##f
+    X(BC1_RGBA_UNORM), X(BC1_RGBA_UNORM_SRGB), X(BC2_RGBA_UNORM), X(BC2_RGBA_UNORM_SRGB),
+    X(BC3_RGBA_UNORM), X(BC3_RGBA_UNORM_SRGB), X(BC4_R_UNORM), X(BC5_RG_UNORM),
+    X(BC6H_RGB_UFLOAT), X(BC6H_RGB_FLOAT), X(BC7_RGBA_UNORM), X(BC7_RGBA_UNORM_SRGB),
+    X(ASTC_4x4_UNORM), X(ASTC_5x4_UNORM), X(ASTC_5x5_UNORM), X(ASTC_6x5_UNORM), X(ASTC_6x6_UNORM),
+    X(ASTC_8x5_UNORM), X(ASTC_8x6_UNORM), X(ASTC_8x8_UNORM), X(ASTC_10x5_UNORM), X(ASTC_10x6_UNORM),
+    X(ASTC_10x8_UNORM), X(ASTC_10x10_UNORM), X(ASTC_12x10_UNORM), X(ASTC_12x12_UNORM),
+    X(ASTC_4x4_UNORM_SRGB), X(ASTC_5x4_UNORM_SRGB), X(ASTC_5x5_UNORM_SRGB), X(ASTC_6x5_UNORM_SRGB),
+    X(ASTC_6x6_UNORM_SRGB), X(ASTC_8x5_UNORM_SRGB), X(ASTC_8x6_UNORM_SRGB), X(ASTC_8x8_UNORM_SRGB),
+    X(ASTC_10x5_UNORM_SRGB), X(ASTC_10x6_UNORM_SRGB), X(ASTC_10x8_UNORM_SRGB), X(ASTC_10x10_UNORM_SRGB),
+    X(ASTC_12x10_UNORM_SRGB), X(ASTC_12x12_UNORM_SRGB),
+#undef X
+};
+const Uint32 TEXTURE_FILE_BLOCK_FORMAT_COUNT = SDL_arraysize(TEXTURE_FILE_BLOCK_FORMATS);
+
+bool texture_file_parse(const Uint8* data, size_t size, TextureFile& out, std::string* error) {
+    static const Uint8 KTX2_ID[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    out = TextureFile{};
+    if (size >= 4 && u32(data) == fourcc('D', 'D', 'S', ' ')) return parse_dds(data, size, out, error);
+    if (size >= 12 && std::memcmp(data, KTX2_ID, 12) == 0) return parse_ktx2(data, size, out, error);
+    return fail(error, "not a DDS or KTX2 file");
+}
+
+bool texture_file_can_decode(SDL_GPUTextureFormat format) {
+    switch (format) {
+    case SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM:
+    case SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM_SRGB:
+    case SDL_GPU_TEXTUREFORMAT_BC2_RGBA_UNORM:
+    case SDL_GPU_TEXTUREFORMAT_BC2_RGBA_UNORM_SRGB:
+    case SDL_GPU_TEXTUREFORMAT_BC3_RGBA_UNORM:
+    case SDL_GPU_TEXTUREFORMAT_BC3_RGBA_UNORM_SRGB:
+    case SDL_GPU_TEXTUREFORMAT_BC4_R_UNORM:
+    case SDL_GPU_TEXTUREFORMAT_BC5_RG_UNORM:
+        return true;
+    default:
+        return false;
+    }
+}
+
+SDL_GPUTextureFormat texture_file_decoded_format(SDL_GPUTextureFormat format) {
+    switch (format) {
+    case SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM_SRGB:
+    case SDL_GPU_TEXTUREFORMAT_BC2_RGBA_UNORM_SRGB:
+    case SDL_GPU_TEXTUREFORMAT_BC3_RGBA_UNORM_SRGB:
+        return SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM_SRGB;
+    default:
+        return SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+bool texture_file_decode_level(const TextureFile& file, const Uint8* data, Uint32 level, Uint8* out) {
+    const FormatInfo* f = find_format(file.format);
+    if (!f || level >= file.levels || !texture_file_can_decode(file.format)) return false;
+    const TextureFileLevel& lv = file.level[level];
+    const Uint8* src = data + lv.offset;
+    Uint32 bx_count = (lv.width + 3) / 4, by_count = (lv.height + 3) / 4;
+    Uint8 texels[16][4];
+    for (Uint32 by = 0; by < by_count; by++) {
+        for (Uint32 bx = 0; bx < bx_count; bx++, src += f->block_bytes) {
+            decode_block(file.format, src, texels);
+            for (Uint32 i = 0; i < 16; i++) {
+                Uint32 x = bx * 4 + (i & 3), y = by * 4 + (i >> 2);
+                if (x < lv.width && y < lv.height) std::memcpy(out + ((size_t)y * lv.width + x) * 4, texels[i], 4);
+            }
+        }
+    }
+    return true;
+}
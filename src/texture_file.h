@@ -0,0 +1,43 @@
+#pragma once
+#include <string>
+#include <SDL3/SDL_gpu.h>
+
+static const Uint32 TEXTURE_FILE_MAX_LEVELS = 16;
+
+struct TextureFileLevel {
+    Uint64 offset = 0;
+    Uint32 size = 0;
+    Uint32 width = 0;
+    Uint32 height = 0;
+};
+
+// A 2D texture's mip chain as stored in a DDS or KTX2 file. Levels point into
+// the file, nothing is copied or decoded. Levels smaller than a block are
+// dropped, so every level can be a texture's first level on any backend.
+struct TextureFile {
+    SDL_GPUTextureFormat format = SDL_GPU_TEXTUREFORMAT_INVALID;
+    const char* format_name = "";
+    Uint32 width = 0;
+    Uint32 height = 0;
+    Uint32 levels = 0;
+    Uint32 block_w = 1;
+    Uint32 block_h = 1;
+    Uint32 block_bytes = 4;
+    TextureFileLevel level[TEXTURE_FILE_MAX_LEVELS];
+};
+
+// Recognizes DDS (legacy FourCC and DX10 headers) and KTX2 without
+// supercompression holding BC1-BC7, ASTC or RGBA8 data.
+bool texture_file_parse(const Uint8* data, size_t size, TextureFile& out, std::string* error);
+
+// CPU fallback for devices without the block format: decodes one level to
+// RGBA8 (width * height * 4 bytes). Covers BC1-BC5; BC6H, BC7 and ASTC have
+// no decoder here and return false.
+bool texture_file_can_decode(SDL_GPUTextureFormat format);
+bool texture_file_decode_level(const TextureFile& file, const Uint8* data, Uint32 level, Uint8* out);
+// The RGBA8 format a decoded level is uploaded as (sRGB stays sRGB).
+SDL_GPUTextureFormat texture_file_decoded_format(SDL_GPUTextureFormat format);
+
+// Block formats the loader can produce, for querying device support up front.
+extern const SDL_GPUTextureFormat TEXTURE_FILE_BLOCK_FORMATS[];
+extern const Uint32 TEXTURE_FILE_BLOCK_FORMAT_COUNT;
@@ -0,0 +1,372 @@
+#include "texture_stream.h"
+#include <algorithm>
+#include <cstring>
+#include <SDL3/SDL.h>
+#include "arena.h"
+#include "texture_file.h"
+#include "upload_ring.h"
+
+namespace {
+
+Uint32 level_size(Uint32 size, Uint32 level) {
+    return SDL_max(size >> level, 1u);
+}
+
+Uint32 level_bytes(const StreamTexture& t, Uint32 level) {
+    return t.level_length[level];
+}
+
+Uint64 levels_bytes(const StreamTexture& t, Uint32 base) {
+    Uint64 bytes = 0;
+    for (Uint32 l = base; l < t.levels; l++) bytes += level_bytes(t, l);
+    return bytes;
+}
+
+// 2x2 box filter; an odd edge repeats its last texel.
+void downsample(const Uint8* src, Uint32 sw, Uint32 sh, Uint8* dst, Uint32 dw, Uint32 dh) {
+    for (Uint32 y = 0; y < dh; y++) {
+        Uint32 y0 = SDL_min(y * 2, sh - 1), y1 = SDL_min(y * 2 + 1, sh - 1);
+        for (Uint32 x = 0; x < dw; x++) {
+            Uint32 x0 = SDL_min(x * 2, sw - 1), x1 = SDL_min(x * 2 + 1, sw - 1);
+            const Uint8* a = src + ((size_t)y0 * sw + x0) * 4;
+            const Uint8* b = src + ((size_t)y0 * sw + x1) * 4;
+            const Uint8* c = src + ((size_t)y1 * sw + x0) * 4;
+            const Uint8* d = src + ((size_t)y1 * sw + x1) * 4;
+            Uint8* o = dst + ((size_t)y * dw + x) * 4;
+            for (int k = 0; k < 4; k++) o[k] = (Uint8)((a[k] + b[k] + c[k] + d[k] + 2) / 4);
+        }
+    }
+}
+
+bool fail(StreamTexture* t, const char* error) {
+    t->error = error;
+    t->state.store(StreamState::failed, std::memory_order_release);
+    return false;
+}
+
+bool has_extension(const std::string& path, const char* ext) {
+    size_t n = std::strlen(ext);
+    return path.size() >= n && SDL_strcasecmp(path.c_str() + path.size() - n, ext) == 0;
+}
+
+bool load_bmp(StreamTexture* t) {
+    SDL_Surface* loaded = SDL_LoadBMP(t->path.c_str());
+    SDL_Surface* rgba = loaded ? SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_RGBA32) : nullptr;
+    if (loaded) SDL_DestroySurface(loaded);
+    if (!rgba || rgba->w <= 0 || rgba->h <= 0) {
+        if (rgba) SDL_DestroySurface(rgba);
+        return fail(t, SDL_GetError());
+    }
+
+    Uint32 w = (Uint32)rgba->w, h = (Uint32)rgba->h;
+    Uint32 levels = 1;
+    while (levels < STREAM_MAX_LEVELS && (w >> levels || h >> levels)) levels++;
+    Uint32 total = 0;
+    for (Uint32 l = 0; l < levels; l++) {
+        t->level_offset[l] = total;
+        t->level_length[l] = level_size(w, l) * level_size(h, l) * 4;
+        total += t->level_length[l];
+    }
+    t->pixels.resize(total);
+    for (Uint32 y = 0; y < h; y++)
+        std::memcpy(t->pixels.data() + (size_t)y * w * 4, (const Uint8*)rgba->pixels + (size_t)y * rgba->pitch, (size_t)w * 4);
+    SDL_DestroySurface(rgba);
+    for (Uint32 l = 1; l < levels; l++)
+        downsample(t->pixels.data() + t->level_offset[l - 1], level_size(w, l - 1), level_size(h, l - 1),
+                   t->pixels.data() + t->level_offset[l], level_size(w, l), level_size(h, l));
+    t->data = t->pixels.data();
+    t->width = w;
+    t->height = h;
+    t->levels = levels;
+    return true;
+}
+
+// DDS and KTX2 keep their mapping: the levels are already in the layout the
+// upload wants. Block formats the device cannot sample are decoded to RGBA8.
+bool load_container(StreamTexture* t) {
+    if (!map_file(t->path.c_str(), t->mapping)) return fail(t, "cannot read file");
+    TextureFile file;
+    std::string error;
+    if (!texture_file_parse(t->mapping.data, t->mapping.size, file, &error)) {
+        unmap_file(t->mapping);
+        return fail(t, error.c_str());
+    }
+    const std::vector<SDL_GPUTextureFormat>& supported = t->owner->block_formats;
+    bool is_block = file.block_w > 1;
+    bool sampled = !is_block || std::find(supported.begin(), supported.end(), file.format) != supported.end();
+    Uint32 levels = SDL_min(file.levels, STREAM_MAX_LEVELS);
+    t->format = file.format;
+    t->format_name = file.format_name;
+    t->width = file.width;
+    t->height = file.height;
+    if (sampled) {
+        for (Uint32 l = 0; l < levels; l++) {
+            t->level_offset[l] = file.level[l].offset;
+            t->level_length[l] = file.level[l].size;
+        }
+        t->data = t->mapping.data;
+        t->levels = levels;
+        return true;
+    }
+
+    if (!texture_file_can_decode(file.format)) {
+        unmap_file(t->mapping);
+        return fail(t, "block format not supported by the device and no CPU decoder for it");
+    }
+    Uint32 total = 0;
+    for (Uint32 l = 0; l < levels; l++) {
+        t->level_offset[l] = total;
+        t->level_length[l] = file.level[l].width * file.level[l].height * 4;
+        total += t->level_length[l];
+    }
+    t->pixels.resize(total);
+    for (Uint32 l = 0; l < levels; l++) texture_file_decode_level(file, t->mapping.data, l, t->pixels.data() + t->level_offset[l]);
+    unmap_file(t->mapping);
+    t->format = texture_file_decoded_format(file.format);
+    t->transcoded = true;
+    t->data = t->pixels.data();
+    t->levels = levels;
+    return true;
+}
+
+void decode_job(void* user, Uint32) {
+    StreamTexture* t = (StreamTexture*)user;
+    if (t->owner->cancel.load()) {
+        fail(t, "cancelled");
+        return;
+    }
+    bool container = has_extension(t->path, ".dds") || has_extension(t->path, ".ktx2");
+    if (container ? load_container(t) : load_bmp(t)) t->state.store(StreamState::ready, std::memory_order_release);
+}
+
+// Lowest level whose larger side still covers the on-screen extent; off
+// screen, the first level within the tail size.
+Uint32 wanted_level(const StreamTexture& t, Uint32 screen_px) {
+    Uint32 target = screen_px ? screen_px : STREAM_TAIL_SIZE;
+    Uint32 level = 0;
+    while (level + 1 < t.levels && SDL_max(level_size(t.width, level + 1), level_size(t.height, level + 1)) >= target) level++;
+    return level;
+}
+
+// Replaces t's GPU texture with one holding levels [base, levels): levels
+// both hold are copied on the GPU, new ones uploaded from the CPU chain. The
+// old texture is released next frame, after the copy pass that reads it.
+bool resize(TextureStreamer& ts, UploadRing& uploads, StreamTexture& t, Uint32 base) {
+    Uint32 old_base = t.resident_base.load();
+    SDL_GPUTexture* tex = nullptr;
+    if (base < t.levels) {
+        SDL_GPUTextureCreateInfo info{};
+        info.type = SDL_GPU_TEXTURETYPE_2D;
+        info.format = t.format;
+        info.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER;
+        info.width = level_size(t.width, base);
+        info.height = level_size(t.height, base);
+        info.layer_count_or_depth = 1;
+        info.num_levels = t.levels - base;
+        tex = SDL_CreateGPUTexture(ts.device, &info);
+        if (!tex) return false;
+        for (Uint32 l = base; l < t.levels; l++) {
+            SDL_GPUTextureRegion dst{};
+            dst.texture = tex;
+            dst.mip_level = l - base;
+            dst.w = level_size(t.width, l);
+            dst.h = level_size(t.height, l);
+            dst.d = 1;
+            if (t.texture && l >= old_base) {
+                SDL_GPUTextureLocation src{};
+                src.texture = t.texture;
+                src.mip_level = l - old_base;
+                copy_texture(uploads, src, dst);
+                continue;
+            }
+            if (!upload_texture(uploads, dst, t.data + t.level_offset[l], level_bytes(t, l))) {
+                SDL_ReleaseGPUTexture(ts.device, tex);
+                return false;
+            }
+            ts.stats.uploaded_bytes += level_bytes(t, l);
+        }
+    }
+    if (t.texture) ts.release.push_back(t.texture);
+    ts.resident_bytes -= old_base < t.levels ? levels_bytes(t, old_base) : 0;
+    ts.resident_bytes += base < t.levels ? levels_bytes(t, base) : 0;
+    t.texture = tex;
+    t.resident_base.store(base < t.levels ? base : STREAM_MAX_LEVELS);
+    return true;
+}
+
+Uint32 resident_base(const StreamTexture& t) {
+    return SDL_min(t.resident_base.load(), t.levels);
+}
+
+// Drops the top level of the lowest-priority resident texture below
+// `priority`, holding more than it wants first.
+bool evict_one(TextureStreamer& ts, UploadRing& uploads, Uint32 priority) {
+    StreamTexture* victim = nullptr;
+    for (StreamTexture* t : ts.scratch) {
+        if (!t->texture || t->priority >= priority) continue;
+        bool excess = resident_base(*t) < t->wanted;
+        if (!victim) { victim = t; continue; }
+        bool victim_excess = resident_base(*victim) < victim->wanted;
+        if (excess != victim_excess ? excess : t->priority < victim->priority) victim = t;
+    }
+    if (!victim || !resize(ts, uploads, *victim, resident_base(*victim) + 1)) return false;
+    ts.stats.evictions++;
+    return true;
+}
+
+}
+
+bool texture_stream_init(TextureStreamer& ts, SDL_GPUDevice* device, UploadRing& uploads) {
+    ts.device = device;
+    ts.cancel.store(false);
+    ts.block_formats.clear();
+    for (Uint32 i = 0; i < TEXTURE_FILE_BLOCK_FORMAT_COUNT; i++)
+        if (SDL_GPUTextureSupportsFormat(device, TEXTURE_FILE_BLOCK_FORMATS[i], SDL_GPU_TEXTURETYPE_2D, SDL_GPU_TEXTUREUSAGE_SAMPLER))
+            ts.block_formats.push_back(TEXTURE_FILE_BLOCK_FORMATS[i]);
+    SDL_GPUTextureCreateInfo info{};
+    info.type = SDL_GPU_TEXTURETYPE_2D;
+    info.format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
+    info.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER;
+    info.width = 1;
+    info.height = 1;
+    info.layer_count_or_depth = 1;
+    info.num_levels = 1;
+    ts.placeholder = SDL_CreateGPUTexture(device, &info);
+    if (!ts.placeholder) return false;
+    const Uint8 grey[4] = { 96, 96, 96, 255 };
+    SDL_GPUTextureRegion dst{};
+    dst.texture = ts.placeholder;
+    dst.w = 1;
+    dst.h = 1;
+    dst.d = 1;
+    return upload_texture(uploads, dst, grey, sizeof(grey));
+}
+
+void texture_stream_destroy(TextureStreamer& ts) {
+    ts.cancel.store(true);
+    while (!jobs::done(ts.decodes)) {
+        jobs::pump_main();
+        SDL_Delay(1);
+    }
+    for (auto& t : ts.textures) {
+        if (t->texture) SDL_ReleaseGPUTexture(ts.device, t->texture);
+        unmap_file(t->mapping);
+    }
+    for (SDL_GPUTexture* tex : ts.release) SDL_ReleaseGPUTexture(ts.device, tex);
+    if (ts.placeholder) SDL_ReleaseGPUTexture(ts.device, ts.placeholder);
+    ts.textures.clear();
+    ts.release.clear();
+    ts.scratch.clear();
+    ts.placeholder = nullptr;
+    ts.resident_bytes = 0;
+}
+
+Uint32 texture_stream_request(TextureStreamer& ts, const char* path) {
+    auto t = std::make_unique<StreamTexture>();
+    t->owner = &ts;
+    t->path = path;
+    std::lock_guard<std::mutex> lock(ts.mutex);
+    ts.textures.push_back(std::move(t));
+    return (Uint32)ts.textures.size();
+}
+
+void texture_stream_set_screen_size(TextureStreamer& ts, Uint32 handle, Uint32 pixels) {
+    if (StreamTexture* t = (StreamTexture*)texture_stream_get(ts, handle)) t->screen_px.store(pixels, std::memory_order_relaxed);
+}
+
+Uint64 texture_stream_imgui_id(Uint32 handle) {
+    return ((Uint64)handle << 1) | 1;
+}
+
+const StreamTexture* texture_stream_get(TextureStreamer& ts, Uint32 handle) {
+    std::lock_guard<std::mutex> lock(ts.mutex);
+    return handle && handle <= ts.textures.size() ? ts.textures[handle - 1].get() : nullptr;
+}
+
+void texture_stream_update(TextureStreamer& ts, UploadRing& uploads) {
+    for (SDL_GPUTexture* tex : ts.release) SDL_ReleaseGPUTexture(ts.device, tex);
+    ts.release.clear();
+    Uint64 total_evictions = ts.stats.total_evictions;
+    ts.stats = TextureStreamStats{};
+    ts.stats.total_evictions = total_evictions;
+    {
+        std::lock_guard<std::mutex> lock(ts.mutex);
+        ts.scratch.clear();
+        for (auto& t : ts.textures) ts.scratch.push_back(t.get());
+    }
+
+    // Decode slots go to the largest on-screen textures first.
+    ArenaScope scratch(arena_scratch());
+    ArenaVector<StreamTexture*> queued{ ArenaAllocator<StreamTexture*>(scratch.arena) };
+    Uint32 decoding = 0;
+    for (StreamTexture* t : ts.scratch) {
+        StreamState s = t->state.load(std::memory_order_acquire);
+        t->priority = t->screen_px.load(std::memory_order_relaxed);
+        if (s == StreamState::queued) queued.push_back(t);
+        if (s == StreamState::decoding) decoding++;
+        if (s == StreamState::failed) ts.stats.failed++;
+        if (s != StreamState::ready) continue;
+        t->wanted = wanted_level(*t, t->priority);
+        ts.stats.wanted_bytes += levels_bytes(*t, t->wanted);
+    }
+    std::stable_sort(queued.begin(), queued.end(), [](const StreamTexture* a, const StreamTexture* b) { return a->priority > b->priority; });
+    Uint32 dispatched = 0;
+    for (StreamTexture* t : queued) {
+        if (decoding >= ts.max_decodes) break;
+        t->state.store(StreamState::decoding);
+        jobs::run_background(decode_job, t, 1, &ts.decodes);
+        decoding++;
+        dispatched++;
+    }
+
+    // Only ready textures take part in residency from here on.
+    ts.scratch.erase(std::remove_if(ts.scratch.begin(), ts.scratch.end(),
+                                    [](const StreamTexture* t) { return t->state.load(std::memory_order_acquire) != StreamState::ready; }),
+                     ts.scratch.end());
+    std::stable_sort(ts.scratch.begin(), ts.scratch.end(), [](const StreamTexture* a, const StreamTexture* b) { return a->priority > b->priority; });
+
+    const Uint64 budget = ts.budget_bytes.load();
+    const Uint32 frame_bytes = ts.upload_bytes_per_frame.load();
+    Uint32 resizes = 0;
+    for (StreamTexture* t : ts.scratch) {
+        // One level per step, smallest first, so a texture sharpens over a few
+        // frames instead of stalling on its top level.
+        while (resident_base(*t) > t->wanted && resizes < ts.max_resizes) {
+            Uint32 base = resident_base(*t) - 1;
+            Uint32 need = level_bytes(*t, base);
+            if (ts.stats.uploaded_bytes + need > frame_bytes && ts.stats.uploaded_bytes > 0) break;
+            while (ts.resident_bytes + need > budget && resizes < ts.max_resizes && evict_one(ts, uploads, t->priority)) resizes++;
+            if (ts.resident_bytes + need > budget || resizes >= ts.max_resizes || !resize(ts, uploads, *t, base)) break;
+            resizes++;
+            ts.stats.promotions++;
+        }
+    }
+    // The budget may have shrunk; give back the lowest priorities' levels.
+    while (ts.resident_bytes > budget && resizes < ts.max_resizes && evict_one(ts, uploads, UINT32_MAX)) resizes++;
+
+    ts.stats.total_evictions += ts.stats.evictions;
+    ts.stats.textures = (Uint32)ts.textures.size();
+    ts.stats.decoding = decoding;
+    ts.stats.queued = (Uint32)queued.size() - SDL_min((Uint32)queued.size(), dispatched);
+    ts.stats.resident_bytes = ts.resident_bytes;
+    for (StreamTexture* t : ts.scratch) ts.stats.resident += t->texture != nullptr;
+
+    // Resolve looks handles up in scratch by index again.
+    std::lock_guard<std::mutex> lock(ts.mutex);
+    ts.scratch.clear();
+    for (auto& t : ts.textures) ts.scratch.push_back(t.get());
+    ts.last_stats = ts.stats;
+}
+
+SDL_GPUTexture* texture_stream_resolve(TextureStreamer& ts, Uint64 id) {
+    if (!(id & 1)) return nullptr;
+    Uint64 handle = id >> 1;
+    if (handle == 0 || handle > ts.scratch.size()) return ts.placeholder;
+    StreamTexture* t = ts.scratch[handle - 1];
+    return t->texture ? t->texture : ts.placeholder;
+}
+
+TextureStreamStats texture_stream_stats(TextureStreamer& ts) {
+    std::lock_guard<std::mutex> lock(ts.mutex);
+    return ts.last_stats;
+}
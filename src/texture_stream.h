@@ -0,0 +1,124 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <SDL3/SDL_gpu.h>
+#include "jobs.h"
+#include "mapped_file.h"
+
+struct UploadRing;
+
+static const Uint32 STREAM_MAX_LEVELS = 16;
+// Levels at or below this size stay wanted while a texture is off screen, so
+// it has something to show the moment it appears.
+static const Uint32 STREAM_TAIL_SIZE = 64;
+
+enum class StreamState : Uint32 { queued, decoding, ready, failed };
+
+struct TextureStreamer;
+
+// One streamed texture. The decode job fills the mip chain once and
+// publishes it through `state`; after that the CPU copy is read-only and is
+// what levels are uploaded from again after an eviction. The GPU texture holds
+// levels [base, levels) of the chain and grows or shrinks one level at a time.
+//
+// BMPs are decoded into `pixels` with generated mips. DDS and KTX2 files stay
+// mapped and their levels are uploaded straight from the mapping, unless the
+// device lacks the block format and they were transcoded into `pixels`.
+struct StreamTexture {
+    TextureStreamer* owner = nullptr;
+    std::string path;
+    std::atomic<StreamState> state{ StreamState::queued };
+    std::string error;
+    std::vector<Uint8> pixels;
+    MappedFile mapping;
+    // pixels.data() or mapping.data.
+    const Uint8* data = nullptr;
+    Uint64 level_offset[STREAM_MAX_LEVELS] = {};
+    Uint32 level_length[STREAM_MAX_LEVELS] = {};
+    SDL_GPUTextureFormat format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
+    const char* format_name = "RGBA8";
+    bool transcoded = false;
+    Uint32 width = 0;
+    Uint32 height = 0;
+    Uint32 levels = 0;
+    // Main thread: largest on-screen extent in pixels, 0 when not drawn.
+    std::atomic<Uint32> screen_px{ 0 };
+    // Render thread owned; resident_base is also read by the UI.
+    SDL_GPUTexture* texture = nullptr;
+    std::atomic<Uint32> resident_base{ STREAM_MAX_LEVELS };
+    Uint32 wanted = 0;
+    Uint32 priority = 0;
+};
+
+struct TextureStreamStats {
+    Uint32 textures = 0;
+    Uint32 queued = 0;
+    Uint32 decoding = 0;
+    Uint32 failed = 0;
+    Uint32 resident = 0;
+    Uint64 resident_bytes = 0;
+    // GPU bytes if every texture held its wanted levels.
+    Uint64 wanted_bytes = 0;
+    // This frame.
+    Uint64 uploaded_bytes = 0;
+    Uint32 promotions = 0;
+    Uint32 evictions = 0;
+    Uint64 total_evictions = 0;
+};
+
+// Streams textures from disk: BMP decode, DDS/KTX2 parsing and mip generation
+// run as background jobs, levels are uploaded smallest first through the
+// upload ring (one copy pass per frame) within a per-frame byte budget, and
+// when the resident set would exceed the GPU budget the top levels of the
+// lowest-priority textures are dropped. Priority is on-screen size.
+//
+// Requests and screen sizes come from the main thread; everything touching
+// GPU textures happens in texture_stream_update on the render thread. UI code
+// draws a texture through its ImTextureID, which the ImGui backend resolves
+// with texture_stream_resolve when it records the frame.
+struct TextureStreamer {
+    SDL_GPUDevice* device = nullptr;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<StreamTexture>> textures;
+    std::atomic<Uint64> budget_bytes{ 256ull << 20 };
+    std::atomic<Uint32> upload_bytes_per_frame{ 4u << 20 };
+    // Texture re-creations per frame; each is an allocation plus a copy of
+    // the levels already resident.
+    Uint32 max_resizes = 16;
+    Uint32 max_decodes = 4;
+    SDL_GPUTexture* placeholder = nullptr;
+    jobs::Counter decodes;
+    std::atomic<bool> cancel{ false };
+    // Block formats the device samples, queried once at init.
+    std::vector<SDL_GPUTextureFormat> block_formats;
+
+    // Render thread.
+    std::vector<StreamTexture*> scratch;
+    std::vector<SDL_GPUTexture*> release;
+    Uint64 resident_bytes = 0;
+    TextureStreamStats stats;
+    TextureStreamStats last_stats;
+};
+
+bool texture_stream_init(TextureStreamer& ts, SDL_GPUDevice* device, UploadRing& uploads);
+// Main thread, after the render thread has stopped.
+void texture_stream_destroy(TextureStreamer& ts);
+
+// Main thread. Handles start at 1. Decodes start a few at a time, largest
+// on-screen size first.
+Uint32 texture_stream_request(TextureStreamer& ts, const char* path);
+void texture_stream_set_screen_size(TextureStreamer& ts, Uint32 handle, Uint32 pixels);
+// Tagged so the ImGui backend can tell it from a plain SDL_GPUTexture*.
+Uint64 texture_stream_imgui_id(Uint32 handle);
+const StreamTexture* texture_stream_get(TextureStreamer& ts, Uint32 handle);
+
+// Render thread, once per frame before the uploads are flushed.
+void texture_stream_update(TextureStreamer& ts, UploadRing& uploads);
+// Render thread: the current GPU texture for an ImTextureID made by
+// texture_stream_imgui_id, the placeholder while nothing is resident, or
+// nullptr when `id` is not a stream id.
+SDL_GPUTexture* texture_stream_resolve(TextureStreamer& ts, Uint64 id);
+TextureStreamStats texture_stream_stats(TextureStreamer& ts);
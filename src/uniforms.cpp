@@ -0,0 +1,115 @@
+#include "uniforms.h"
+#include <algorithm>
+#include <cstring>
+
+// SDL_GPU takes vertex uniform blocks from set 1 and fragment ones from set 3.
+static bool add_blocks(UniformLayout& out, const std::vector<ReflectedUniformBlock>& blocks, UniformStage stage) {
+    const Uint32 set = stage == UniformStage::vertex ? 1 : 3;
+    for (const ReflectedUniformBlock& b : blocks) {
+        if (b.set != set || b.slot >= 4 || b.size == 0) return false;
+        UniformBlockLayout bl;
+        bl.name = b.name;
+        bl.stage = stage;
+        bl.slot = b.slot;
+        bl.size = b.size;
+        bl.offset = out.size;
+        for (const ReflectedUniformMember& m : b.members) {
+            UniformParamLayout p;
+            p.name = b.name + "." + m.name;
+            p.block = (Uint32)out.blocks.size();
+            p.offset = bl.offset + m.offset;
+            p.size = m.size;
+            out.params.push_back(p);
+        }
+        // 16-byte aligned starts keep every block std140-aligned in place.
+        out.size += (b.size + 15u) & ~15u;
+        out.blocks.push_back(bl);
+    }
+    return true;
+}
+
+bool uniform_layout_build(UniformLayout& out, const std::vector<ReflectedUniformBlock>& vs, const std::vector<ReflectedUniformBlock>& fs) {
+    out = UniformLayout{};
+    if (!add_blocks(out, vs, UniformStage::vertex) || !add_blocks(out, fs, UniformStage::fragment)) return false;
+    std::sort(out.params.begin(), out.params.end(), [](const UniformParamLayout& a, const UniformParamLayout& b) { return a.name < b.name; });
+    return true;
+}
+
+static const UniformParamLayout* find_param(const UniformLayout& layout, const char* name) {
+    auto it = std::lower_bound(layout.params.begin(), layout.params.end(), name,
+        [](const UniformParamLayout& p, const char* n) { return p.name.compare(n) < 0; });
+    if (it == layout.params.end() || it->name != name) return nullptr;
+    return &*it;
+}
+
+void uniform_values_reset(UniformValues& values, std::shared_ptr<const UniformLayout> layout) {
+    std::vector<Uint8> data(layout ? layout->size : 0, 0);
+    if (values.layout && layout) {
+        for (const UniformParamLayout& p : layout->params) {
+            const UniformParamLayout* old = find_param(*values.layout, p.name.c_str());
+            if (old && old->size == p.size) std::memcpy(data.data() + p.offset, values.data.data() + old->offset, p.size);
+        }
+    }
+    values.layout = std::move(layout);
+    values.data.swap(data);
+    values.generation++;
+}
+
+UniformParam uniform_find(const UniformValues& values, const char* name) {
+    UniformParam out;
+    out.generation = values.generation;
+    const UniformParamLayout* p = values.layout ? find_param(*values.layout, name) : nullptr;
+    if (p) {
+        out.offset = p->offset;
+        out.size = p->size;
+    }
+    return out;
+}
+
+bool uniform_set(UniformValues& values, UniformParam param, const void* data, Uint32 size) {
+    if (param.size == 0 || uniform_stale(values, param) || size > param.size || param.offset + param.size > values.data.size()) return false;
+    std::memcpy(values.data.data() + param.offset, data, size);
+    return true;
+}
+
+bool uniform_set_float(UniformValues& values, UniformParam param, float v) {
+    return uniform_set(values, param, &v, sizeof(v));
+}
+
+bool uniform_set_float2(UniformValues& values, UniformParam param, float x, float y) {
+    float v[2] = { x, y };
+    return uniform_set(values, param, v, sizeof(v));
+}
+
+bool uniform_set_float4(UniformValues& values, UniformParam param, float x, float y, float z, float w) {
+    float v[4] = { x, y, z, w };
+    return uniform_set(values, param, v, sizeof(v));
+}
+
+bool uniform_set_mat4(UniformValues& values, UniformParam param, const float* m) {
+    return uniform_set(values, param, m, sizeof(float) * 16);
+}
+
+bool uniform_set_int(UniformValues& values, UniformParam param, Sint32 v) {
+    return uniform_set(values, param, &v, sizeof(v));
+}
+
+bool uniform_set_uint(UniformValues& values, UniformParam param, Uint32 v) {
+    return uniform_set(values, param, &v, sizeof(v));
+}
+
+bool uniform_bind(const UniformValues& values, DrawList& list, DrawItem& item) {
+    item.num_uniforms = 0;
+    if (!values.layout || values.layout->blocks.empty()) return true;
+    const UniformLayout& layout = *values.layout;
+    if (layout.blocks.size() > DRAW_MAX_UNIFORMS) return false;
+    Uint32 base = draw_list_stage_uniforms(list, values.data.data(), (Uint32)values.data.size());
+    for (const UniformBlockLayout& b : layout.blocks) {
+        DrawUniform& u = item.uniforms[item.num_uniforms++];
+        u.fragment = b.stage == UniformStage::fragment;
+        u.slot = b.slot;
+        u.offset = base + b.offset;
+        u.size = b.size;
+    }
+    return true;
+}
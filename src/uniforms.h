@@ -0,0 +1,78 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <SDL3/SDL_gpu.h>
+#include "draw_list.h"
+#include "shader_reflect.h"
+
+enum class UniformStage : Uint8 { vertex, fragment };
+
+struct UniformBlockLayout {
+    std::string name;
+    UniformStage stage = UniformStage::vertex;
+    Uint32 slot = 0;
+    Uint32 size = 0;
+    // Where the block starts in UniformValues::data.
+    Uint32 offset = 0;
+};
+
+struct UniformParamLayout {
+    std::string name;
+    Uint32 block = 0;
+    Uint32 offset = 0;
+    Uint32 size = 0;
+};
+
+// Every uniform block of a program, laid out back to back, and its members
+// by name. Built from reflection; immutable once shared.
+struct UniformLayout {
+    std::vector<UniformBlockLayout> blocks;
+    std::vector<UniformParamLayout> params;
+    Uint32 size = 0;
+};
+
+// Resolved once by name, then set without lookups. size == 0 means the
+// program has no such member, and sets through it are ignored. A param is
+// tied to the layout generation it was found in; resolve again after a
+// reload.
+struct UniformParam {
+    Uint32 generation = 0;
+    Uint32 offset = 0;
+    Uint32 size = 0;
+};
+
+// Current contents of a program's uniform blocks, one contiguous area.
+// Cheap to copy into a frame snapshot.
+struct UniformValues {
+    std::shared_ptr<const UniformLayout> layout;
+    std::vector<Uint8> data;
+    // Bumped by every reset. A new layout may be allocated where a freed one
+    // was, so params are checked against this rather than the pointer.
+    Uint32 generation = 0;
+};
+
+// Member names are "Block.member"; `vs` and `fs` go to the vertex and
+// fragment stages. False if a block is outside its stage's uniform set (1 for
+// vertex, 3 for fragment) or would exceed SDL's four slots.
+bool uniform_layout_build(UniformLayout& out, const std::vector<ReflectedUniformBlock>& vs, const std::vector<ReflectedUniformBlock>& fs);
+// Switches to `layout`, keeping the value of every member that still exists
+// with the same size (a shader reload keeps its parameters).
+void uniform_values_reset(UniformValues& values, std::shared_ptr<const UniformLayout> layout);
+
+UniformParam uniform_find(const UniformValues& values, const char* name);
+inline bool uniform_stale(const UniformValues& values, UniformParam param) {
+    return param.generation != values.generation;
+}
+bool uniform_set(UniformValues& values, UniformParam param, const void* data, Uint32 size);
+bool uniform_set_float(UniformValues& values, UniformParam param, float v);
+bool uniform_set_float2(UniformValues& values, UniformParam param, float x, float y);
+bool uniform_set_float4(UniformValues& values, UniformParam param, float x, float y, float z, float w);
+bool uniform_set_mat4(UniformValues& values, UniformParam param, const float* m);
+bool uniform_set_int(UniformValues& values, UniformParam param, Sint32 v);
+bool uniform_set_uint(UniformValues& values, UniformParam param, Uint32 v);
+
+// Stages the values in the list's per-frame uniform area and points the item
+// at each block. Values equal to the ones staged just before are not copied
+// again, and their pushes are skipped at emission.
+bool uniform_bind(const UniformValues& values, DrawList& list, DrawItem& item);
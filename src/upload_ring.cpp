@@ -0,0 +1,210 @@
+#include "upload_ring.h"
+#include <cstddef>
+#include <cstring>
+
+static const Uint32 UPLOAD_ALIGN = 16;
+
+static Uint32 align_up(Uint32 v, Uint32 a) {
+    return (v + a - 1) & ~(a - 1);
+}
+
+bool upload_ring_init(UploadRing& ring, SDL_GPUDevice* device, Uint32 slot_size, Uint32 slot_count) {
+    ring.device = device;
+    ring.slot_size = align_up(slot_size, UPLOAD_ALIGN);
+    ring.slots.assign(slot_count ? slot_count : 1, UploadRing::Slot{});
+    for (auto& s : ring.slots) {
+        SDL_GPUTransferBufferCreateInfo tci{};
+        tci.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
+        tci.size = ring.slot_size;
+        s.buffer = SDL_CreateGPUTransferBuffer(device, &tci);
+        if (!s.buffer) { upload_ring_destroy(ring); return false; }
+    }
+    ring.pending.reserve(64);
+    ring.current = 0;
+    ring.head = 0;
+    ring.mapped = nullptr;
+    ring.submitted_slot = -1;
+    return true;
+}
+
+void upload_ring_destroy(UploadRing& ring) {
+    if (ring.mapped) SDL_UnmapGPUTransferBuffer(ring.device, ring.slots[ring.current].buffer);
+    ring.mapped = nullptr;
+    for (auto* tb : ring.overflow) {
+        SDL_UnmapGPUTransferBuffer(ring.device, tb);
+        SDL_ReleaseGPUTransferBuffer(ring.device, tb);
+    }
+    ring.overflow.clear();
+    for (auto& s : ring.slots)
+        if (s.buffer) SDL_ReleaseGPUTransferBuffer(ring.device, s.buffer);
+    for (auto& f : ring.fences)
+        if (f.fence) SDL_ReleaseGPUFence(ring.device, f.fence);
+    ring.slots.clear();
+    ring.fences.clear();
+    ring.pending.clear();
+}
+
+static Uint8* map_current(UploadRing& ring) {
+    UploadRing::Slot& s = ring.slots[ring.current];
+    bool cycle = s.serial > upload_ring_poll(ring);
+    if (cycle) ring.stats.cycled_maps++;
+    s.serial = 0;
+    return (Uint8*)SDL_MapGPUTransferBuffer(ring.device, s.buffer, cycle);
+}
+
+static void* ring_alloc(UploadRing& ring, Uint32 size, SDL_GPUTransferBuffer** out_buffer, Uint32* out_offset) {
+    Uint32 off = align_up(ring.head, UPLOAD_ALIGN);
+    if (!ring.slots.empty() && size <= ring.slot_size && off + size <= ring.slot_size) {
+        if (!ring.mapped) ring.mapped = map_current(ring);
+        if (!ring.mapped) return nullptr;
+        ring.head = off + size;
+        *out_buffer = ring.slots[ring.current].buffer;
+        *out_offset = off;
+        return ring.mapped + off;
+    }
+
+    SDL_GPUTransferBufferCreateInfo tci{};
+    tci.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
+    tci.size = size;
+    SDL_GPUTransferBuffer* tb = SDL_CreateGPUTransferBuffer(ring.device, &tci);
+    if (!tb) return nullptr;
+    void* p = SDL_MapGPUTransferBuffer(ring.device, tb, false);
+    if (!p) { SDL_ReleaseGPUTransferBuffer(ring.device, tb); return nullptr; }
+    ring.overflow.push_back(tb);
+    ring.stats.overflow_buffers++;
+    *out_buffer = tb;
+    *out_offset = 0;
+    return p;
+}
+
+void* upload_buffer_map(UploadRing& ring, SDL_GPUBuffer* dst, Uint32 dst_offset, Uint32 size, bool cycle) {
+    if (!dst || size == 0) return nullptr;
+    UploadRing::Copy c{};
+    void* p = ring_alloc(ring, size, &c.src, &c.src_offset);
+    if (!p) return nullptr;
+    c.buffer = dst;
+    c.buffer_offset = dst_offset;
+    c.size = size;
+    c.cycle = cycle;
+    ring.pending.push_back(c);
+    ring.stats.bytes += size;
+    ring.stats.copies++;
+    return p;
+}
+
+bool upload_buffer(UploadRing& ring, SDL_GPUBuffer* dst, Uint32 dst_offset, const void* data, Uint32 size, bool cycle) {
+    void* p = upload_buffer_map(ring, dst, dst_offset, size, cycle);
+    if (!p) return false;
+    std::memcpy(p, data, size);
+    return true;
+}
+
+bool upload_texture(UploadRing& ring, const SDL_GPUTextureRegion& dst, const void* data, Uint32 size, Uint32 pixels_per_row, Uint32 rows_per_layer) {
+    if (!dst.texture || size == 0) return false;
+    UploadRing::Copy c{};
+    void* p = ring_alloc(ring, size, &c.src, &c.src_offset);
+    if (!p) return false;
+    std::memcpy(p, data, size);
+    c.texture = dst;
+    c.pixels_per_row = pixels_per_row;
+    c.rows_per_layer = rows_per_layer;
+    c.size = size;
+    ring.pending.push_back(c);
+    ring.stats.bytes += size;
+    ring.stats.copies++;
+    return true;
+}
+
+void copy_texture(UploadRing& ring, const SDL_GPUTextureLocation& src, const SDL_GPUTextureRegion& dst) {
+    if (!src.texture || !dst.texture) return;
+    UploadRing::Copy c{};
+    c.texture = dst;
+    c.copy_from = src;
+    ring.pending.push_back(c);
+    ring.stats.copies++;
+}
+
+void upload_ring_flush(UploadRing& ring, SDL_GPUCommandBuffer* cb) {
+    ring.submitted_slot = -1;
+    if (ring.mapped) {
+        SDL_UnmapGPUTransferBuffer(ring.device, ring.slots[ring.current].buffer);
+        ring.mapped = nullptr;
+    }
+    for (auto* tb : ring.overflow) SDL_UnmapGPUTransferBuffer(ring.device, tb);
+
+    if (!ring.pending.empty()) {
+        SDL_GPUCopyPass* pass = SDL_BeginGPUCopyPass(cb);
+        for (const auto& c : ring.pending) {
+            if (c.buffer) {
+                SDL_GPUTransferBufferLocation src{};
+                src.transfer_buffer = c.src;
+                src.offset = c.src_offset;
+                SDL_GPUBufferRegion dst{};
+                dst.buffer = c.buffer;
+                dst.offset = c.buffer_offset;
+                dst.size = c.size;
+                SDL_UploadToGPUBuffer(pass, &src, &dst, c.cycle);
+            } else if (c.copy_from.texture) {
+                SDL_GPUTextureLocation dst{};
+                dst.texture = c.texture.texture;
+                dst.mip_level = c.texture.mip_level;
+                dst.layer = c.texture.layer;
+                dst.x = c.texture.x;
+                dst.y = c.texture.y;
+                dst.z = c.texture.z;
+                SDL_CopyGPUTextureToTexture(pass, &c.copy_from, &dst, c.texture.w, c.texture.h, c.texture.d, false);
+            } else {
+                SDL_GPUTextureTransferInfo src{};
+                src.transfer_buffer = c.src;
+                src.offset = c.src_offset;
+                src.pixels_per_row = c.pixels_per_row;
+                src.rows_per_layer = c.rows_per_layer;
+                SDL_UploadToGPUTexture(pass, &src, &c.texture, false);
+            }
+        }
+        SDL_EndGPUCopyPass(pass);
+    }
+
+    for (auto* tb : ring.overflow) SDL_ReleaseGPUTransferBuffer(ring.device, tb);
+    ring.overflow.clear();
+    ring.pending.clear();
+
+    if (ring.head > 0) {
+        ring.submitted_slot = (int)ring.current;
+        ring.current = (ring.current + 1) % (Uint32)ring.slots.size();
+        ring.head = 0;
+    }
+    ring.last_stats = ring.stats;
+    ring.stats = UploadRingStats{};
+}
+
+bool upload_ring_submit(UploadRing& ring, SDL_GPUCommandBuffer* cb) {
+    if (ring.submitted_slot < 0 && !ring.fence_requested) return SDL_SubmitGPUCommandBuffer(cb);
+    // A failed submission keeps its serial with no fence, which counts as
+    // signalled: nothing it referenced is in use.
+    SDL_GPUFence* fence = SDL_SubmitGPUCommandBufferAndAcquireFence(cb);
+    Uint64 serial = ++ring.submitted_serial;
+    ring.fences.push_back(UploadRing::Fence{ serial, fence });
+    if (ring.submitted_slot >= 0) ring.slots[(size_t)ring.submitted_slot].serial = serial;
+    ring.submitted_slot = -1;
+    ring.fence_requested = false;
+    return fence != nullptr;
+}
+
+Uint64 upload_ring_request_fence(UploadRing& ring) {
+    ring.fence_requested = true;
+    return ring.submitted_serial + 1;
+}
+
+Uint64 upload_ring_poll(UploadRing& ring) {
+    size_t done = 0;
+    while (done < ring.fences.size()) {
+        UploadRing::Fence& f = ring.fences[done];
+        if (f.fence && !SDL_QueryGPUFence(ring.device, f.fence)) break;
+        if (f.fence) SDL_ReleaseGPUFence(ring.device, f.fence);
+        ring.completed_serial = f.serial;
+        done++;
+    }
+    ring.fences.erase(ring.fences.begin(), ring.fences.begin() + (std::ptrdiff_t)done);
+    return ring.completed_serial;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include <SDL3/SDL_gpu.h>
+
+struct UploadRingStats {
+    Uint32 bytes = 0;
+    Uint32 copies = 0;
+    Uint32 overflow_buffers = 0;
+    Uint32 cycled_maps = 0;
+};
+
+// Persistent upload transfer buffers, one slot per frame in flight. Each frame
+// sub-allocates linearly from the current slot and records the copies; the
+// copies are issued in a single copy pass by upload_ring_flush and the slot is
+// reused once the submission that consumed it has completed.
+//
+// The ring also owns the frame fences. Fenced submissions are numbered in
+// order, so other per-frame resources (readbacks) can ask for the next
+// submission to be fenced and later compare its serial with the completed one
+// instead of holding a fence of their own.
+struct UploadRing {
+    struct Slot {
+        SDL_GPUTransferBuffer* buffer = nullptr;
+        Uint64 serial = 0;
+    };
+
+    struct Fence {
+        Uint64 serial = 0;
+        SDL_GPUFence* fence = nullptr;
+    };
+
+    struct Copy {
+        SDL_GPUTransferBuffer* src = nullptr;
+        Uint32 src_offset = 0;
+        SDL_GPUBuffer* buffer = nullptr;
+        Uint32 buffer_offset = 0;
+        Uint32 size = 0;
+        bool cycle = false;
+        SDL_GPUTextureRegion texture{};
+        // Set for a GPU-side copy into `texture` instead of an upload.
+        SDL_GPUTextureLocation copy_from{};
+        Uint32 pixels_per_row = 0;
+        Uint32 rows_per_layer = 0;
+    };
+
+    SDL_GPUDevice* device = nullptr;
+    std::vector<Slot> slots;
+    std::vector<Copy> pending;
+    std::vector<SDL_GPUTransferBuffer*> overflow;
+    Uint32 slot_size = 0;
+    Uint32 current = 0;
+    Uint32 head = 0;
+    Uint8* mapped = nullptr;
+    int submitted_slot = -1;
+    std::vector<Fence> fences;
+    Uint64 submitted_serial = 0;
+    Uint64 completed_serial = 0;
+    bool fence_requested = false;
+    UploadRingStats stats{};
+    UploadRingStats last_stats{};
+};
+
+bool upload_ring_init(UploadRing& ring, SDL_GPUDevice* device, Uint32 slot_size, Uint32 slot_count = 3);
+void upload_ring_destroy(UploadRing& ring);
+
+void* upload_buffer_map(UploadRing& ring, SDL_GPUBuffer* dst, Uint32 dst_offset, Uint32 size, bool cycle = false);
+bool upload_buffer(UploadRing& ring, SDL_GPUBuffer* dst, Uint32 dst_offset, const void* data, Uint32 size, bool cycle = false);
+bool upload_texture(UploadRing& ring, const SDL_GPUTextureRegion& dst, const void* data, Uint32 size, Uint32 pixels_per_row = 0, Uint32 rows_per_layer = 0);
+// Texture-to-texture copy of dst's extent, recorded in the same copy pass and
+// ordered with the uploads around it.
+void copy_texture(UploadRing& ring, const SDL_GPUTextureLocation& src, const SDL_GPUTextureRegion& dst);
+
+void upload_ring_flush(UploadRing& ring, SDL_GPUCommandBuffer* cb);
+bool upload_ring_submit(UploadRing& ring, SDL_GPUCommandBuffer* cb);
+// Fences the next upload_ring_submit and returns the serial it will get.
+Uint64 upload_ring_request_fence(UploadRing& ring);
+// Releases signalled fences, oldest first, and returns the serial of the last
+// submission known to have completed. Never blocks.
+Uint64 upload_ring_poll(UploadRing& ring);
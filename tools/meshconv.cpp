@@ -0,0 +1,452 @@
+// meshconv: Wavefront OBJ -> .bmesh
+//
+// Triangles are reordered per submesh for the post-transform vertex cache
+// (Forsyth), clusters of the result are ordered front-to-back from the mesh
+// centre to cut overdraw, and vertices are renumbered in first-use order for
+// fetch locality.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "mesh_format.h"
+
+namespace {
+
+struct Vec3 {
+    float x = 0, y = 0, z = 0;
+};
+
+static Vec3 sub(Vec3 a, Vec3 b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+static Vec3 add(Vec3 a, Vec3 b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+static Vec3 scale(Vec3 a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+static float dot(Vec3 a, Vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+static Vec3 cross(Vec3 a, Vec3 b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+static Vec3 normalize(Vec3 a) {
+    float l = std::sqrt(dot(a, a));
+    return l > 0 ? scale(a, 1.0f / l) : Vec3{ 0, 0, 1 };
+}
+
+struct SrcVertex {
+    Vec3 pos;
+    Vec3 normal;
+    float uv[2] = { 0, 0 };
+};
+
+struct Submesh {
+    std::string name;
+    std::vector<uint32_t> indices;
+};
+
+struct Model {
+    std::vector<SrcVertex> vertices;
+    std::vector<Submesh> submeshes;
+    bool has_normals = false;
+};
+
+struct Options {
+    bool reorder = true;
+    bool overdraw = true;
+    uint32_t cache_size = 32;
+    float overdraw_threshold = 1.05f;
+};
+
+// ---- OBJ ------------------------------------------------------------------
+
+static int resolve_index(int i, size_t count) {
+    return i < 0 ? (int)count + i : i - 1;
+}
+
+static bool load_obj(const char* path, Model& out) {
+    std::ifstream f(path);
+    if (!f) return false;
+    std::vector<Vec3> pos, nrm;
+    std::vector<std::pair<float, float>> uv;
+    std::unordered_map<std::string, uint32_t> dedup;
+    out.submeshes.push_back({ "default", {} });
+    std::string line;
+    while (std::getline(f, line)) {
+        std::istringstream ls(line);
+        std::string tag;
+        ls >> tag;
+        if (tag == "v") {
+            Vec3 v; ls >> v.x >> v.y >> v.z; pos.push_back(v);
+        } else if (tag == "vn") {
+            Vec3 v; ls >> v.x >> v.y >> v.z; nrm.push_back(v);
+        } else if (tag == "vt") {
+            float u = 0, v = 0; ls >> u >> v; uv.push_back({ u, v });
+        } else if (tag == "usemtl" || tag == "o" || tag == "g") {
+            std::string name; ls >> name;
+            if (out.submeshes.back().indices.empty()) out.submeshes.back().name = name;
+            else out.submeshes.push_back({ name, {} });
+        } else if (tag == "f") {
+            std::vector<uint32_t> poly;
+            std::string tok;
+            while (ls >> tok) {
+                auto it = dedup.find(tok);
+                if (it != dedup.end()) { poly.push_back(it->second); continue; }
+                int vi = 0, ti = 0, ni = 0;
+                const char* s = tok.c_str();
+                vi = std::atoi(s);
+                const char* a = std::strchr(s, '/');
+                if (a) {
+                    if (a[1] != '/') ti = std::atoi(a + 1);
+                    const char* b = std::strchr(a + 1, '/');
+                    if (b) ni = std::atoi(b + 1);
+                }
+                SrcVertex v;
+                int p = resolve_index(vi, pos.size());
+                if (p < 0 || p >= (int)pos.size()) return false;
+                v.pos = pos[(size_t)p];
+                if (ti) {
+                    int t = resolve_index(ti, uv.size());
+                    if (t >= 0 && t < (int)uv.size()) { v.uv[0] = uv[(size_t)t].first; v.uv[1] = uv[(size_t)t].second; }
+                }
+                if (ni) {
+                    int n = resolve_index(ni, nrm.size());
+                    if (n >= 0 && n < (int)nrm.size()) { v.normal = nrm[(size_t)n]; out.has_normals = true; }
+                }
+                uint32_t idx = (uint32_t)out.vertices.size();
+                out.vertices.push_back(v);
+                dedup.emplace(tok, idx);
+                poly.push_back(idx);
+            }
+            for (size_t i = 2; i < poly.size(); i++) {
+                out.submeshes.back().indices.push_back(poly[0]);
+                out.submeshes.back().indices.push_back(poly[i - 1]);
+                out.submeshes.back().indices.push_back(poly[i]);
+            }
+        }
+    }
+    out.submeshes.erase(std::remove_if(out.submeshes.begin(), out.submeshes.end(),
+        [](const Submesh& s) { return s.indices.empty(); }), out.submeshes.end());
+    return !out.vertices.empty() && !out.submeshes.empty();
+}
+
+static void compute_normals(Model& m) {
+    for (auto& v : m.vertices) v.normal = Vec3{};
+    for (const auto& sm : m.submeshes) {
+        for (size_t i = 0; i + 2 < sm.indices.size(); i += 3) {
+            SrcVertex& a = m.vertices[sm.indices[i]];
+            SrcVertex& b = m.vertices[sm.indices[i + 1]];
+            SrcVertex& c = m.vertices[sm.indices[i + 2]];
+            Vec3 n = cross(sub(b.pos, a.pos), sub(c.pos, a.pos));
+            a.normal = add(a.normal, n);
+            b.normal = add(b.normal, n);
+            c.normal = add(c.normal, n);
+        }
+    }
+}
+
+// ---- vertex cache ----------------------------------------------------------
+
+// Average cache miss ratio of an LRU cache of the given size.
+static float acmr(const std::vector<uint32_t>& indices, uint32_t cache_size) {
+    if (indices.empty()) return 0;
+    std::vector<uint32_t> cache;
+    size_t misses = 0;
+    for (uint32_t i : indices) {
+        auto it = std::find(cache.begin(), cache.end(), i);
+        if (it == cache.end()) {
+            misses++;
+            cache.insert(cache.begin(), i);
+            if (cache.size() > cache_size) cache.pop_back();
+        } else {
+            cache.erase(it);
+            cache.insert(cache.begin(), i);
+        }
+    }
+    return (float)misses / (float)(indices.size() / 3);
+}
+
+// Tom Forsyth, "Linear-Speed Vertex Cache Optimisation".
+static const int FORSYTH_CACHE = 32;
+
+static float forsyth_score(int cache_pos, uint32_t remaining) {
+    if (remaining == 0) return -1.0f;
+    float score = 0;
+    if (cache_pos >= 0) {
+        if (cache_pos < 3) score = 0.75f;
+        else score = std::pow(1.0f - (float)(cache_pos - 3) / (float)(FORSYTH_CACHE - 3), 1.5f);
+    }
+    return score + 2.0f * std::pow((float)remaining, -0.5f);
+}
+
+static std::vector<uint32_t> forsyth_reorder(const std::vector<uint32_t>& indices, uint32_t vertex_count) {
+    size_t tri_count = indices.size() / 3;
+    std::vector<uint32_t> remaining(vertex_count, 0);
+    for (uint32_t i : indices) remaining[i]++;
+    std::vector<uint32_t> first(vertex_count + 1, 0);
+    for (uint32_t v = 0; v < vertex_count; v++) first[v + 1] = first[v] + remaining[v];
+    std::vector<uint32_t> tris_of(indices.size());
+    std::vector<uint32_t> fill(first.begin(), first.end() - 1);
+    for (size_t t = 0; t < tri_count; t++)
+        for (int k = 0; k < 3; k++) tris_of[fill[indices[t * 3 + k]]++] = (uint32_t)t;
+
+    std::vector<int> cache_pos(vertex_count, -1);
+    std::vector<float> vscore(vertex_count);
+    for (uint32_t v = 0; v < vertex_count; v++) vscore[v] = forsyth_score(-1, remaining[v]);
+    std::vector<float> tscore(tri_count);
+    std::vector<char> emitted(tri_count, 0);
+    for (size_t t = 0; t < tri_count; t++)
+        tscore[t] = vscore[indices[t * 3]] + vscore[indices[t * 3 + 1]] + vscore[indices[t * 3 + 2]];
+
+    std::vector<uint32_t> out;
+    out.reserve(indices.size());
+    std::vector<uint32_t> cache;
+    size_t scan = 0;
+    long best = -1;
+    for (size_t n = 0; n < tri_count; n++) {
+        if (best < 0) {
+            float bs = -1;
+            for (size_t t = scan; t < tri_count; t++) {
+                if (emitted[t]) { if (t == scan) scan++; continue; }
+                if (tscore[t] > bs) { bs = tscore[t]; best = (long)t; }
+            }
+        }
+        size_t t = (size_t)best;
+        emitted[t] = 1;
+        std::vector<uint32_t> next;
+        for (int k = 0; k < 3; k++) {
+            uint32_t v = indices[t * 3 + k];
+            out.push_back(v);
+            next.push_back(v);
+            uint32_t* b = &tris_of[first[v]];
+            uint32_t* e = b + remaining[v];
+            std::swap(*std::find(b, e, (uint32_t)t), *(e - 1));
+            remaining[v]--;
+        }
+        for (uint32_t v : cache)
+            if (std::find(next.begin(), next.end(), v) == next.end()) next.push_back(v);
+        for (size_t i = FORSYTH_CACHE; i < next.size(); i++) {
+            cache_pos[next[i]] = -1;
+            vscore[next[i]] = forsyth_score(-1, remaining[next[i]]);
+        }
+        if (next.size() > (size_t)FORSYTH_CACHE) next.resize(FORSYTH_CACHE);
+        cache.swap(next);
+
+        best = -1;
+        float bs = -1;
+        for (size_t i = 0; i < cache.size(); i++) {
+            uint32_t v = cache[i];
+            cache_pos[v] = (int)i;
+            vscore[v] = forsyth_score((int)i, remaining[v]);
+        }
+        for (uint32_t v : cache) {
+            for (uint32_t j = 0; j < remaining[v]; j++) {
+                uint32_t tt = tris_of[first[v] + j];
+                tscore[tt] = vscore[indices[tt * 3]] + vscore[indices[tt * 3 + 1]] + vscore[indices[tt * 3 + 2]];
+                if (tscore[tt] > bs) { bs = tscore[tt]; best = (long)tt; }
+            }
+        }
+    }
+    return out;
+}
+
+// ---- overdraw --------------------------------------------------------------
+
+// Splits the cache-ordered triangles into clusters (Sander et al., "Fast
+// Triangle Reordering for Vertex Locality and Reduced Overdraw"): hard
+// boundaries where the simulated cache restarts anyway (all three vertices
+// miss), soft ones where the cluster so far is within `threshold` of the
+// mesh's ACMR. Clusters are then sorted so those facing away from the mesh
+// centre come first and occlude what is drawn after them.
+static std::vector<uint32_t> overdraw_reorder(const std::vector<uint32_t>& indices, const std::vector<SrcVertex>& verts,
+                                              uint32_t cache_size, float threshold) {
+    size_t tri_count = indices.size() / 3;
+    float mesh_acmr = acmr(indices, cache_size);
+    std::vector<size_t> starts{ 0 };
+    std::vector<uint32_t> cache;
+    const size_t min_cluster = 16;
+    size_t cluster_misses = 0;
+    for (size_t t = 0; t < tri_count; t++) {
+        int misses = 0;
+        for (int k = 0; k < 3; k++) {
+            uint32_t v = indices[t * 3 + k];
+            auto it = std::find(cache.begin(), cache.end(), v);
+            if (it == cache.end()) misses++;
+            else cache.erase(it);
+            cache.insert(cache.begin(), v);
+            if (cache.size() > cache_size) cache.pop_back();
+        }
+        size_t size = t - starts.back();
+        if (misses == 3 && size >= min_cluster) {
+            starts.push_back(t);
+            cluster_misses = 0;
+            size = 0;
+        }
+        cluster_misses += (size_t)misses;
+        size++;
+        if (size >= min_cluster && t + 1 < tri_count && (float)cluster_misses / (float)size <= threshold * mesh_acmr) {
+            starts.push_back(t + 1);
+            cluster_misses = 0;
+            cache.clear();
+        }
+    }
+    starts.push_back(tri_count);
+
+    Vec3 centre;
+    for (uint32_t i : indices) centre = add(centre, verts[i].pos);
+    centre = scale(centre, 1.0f / (float)indices.size());
+
+    struct Cluster { size_t begin, end; float key; };
+    std::vector<Cluster> clusters;
+    for (size_t c = 0; c + 1 < starts.size(); c++) {
+        Vec3 mid, normal;
+        float area = 0;
+        for (size_t t = starts[c]; t < starts[c + 1]; t++) {
+            Vec3 a = verts[indices[t * 3]].pos, b = verts[indices[t * 3 + 1]].pos, d = verts[indices[t * 3 + 2]].pos;
+            Vec3 n = cross(sub(b, a), sub(d, a));
+            float w = std::sqrt(dot(n, n));
+            normal = add(normal, n);
+            mid = add(mid, scale(add(add(a, b), d), w / 3.0f));
+            area += w;
+        }
+        if (area > 0) mid = scale(mid, 1.0f / area);
+        clusters.push_back({ starts[c], starts[c + 1], dot(sub(mid, centre), normalize(normal)) });
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.key > b.key; });
+
+    std::vector<uint32_t> out;
+    out.reserve(indices.size());
+    for (const auto& c : clusters) out.insert(out.end(), indices.begin() + (long)c.begin * 3, indices.begin() + (long)c.end * 3);
+    return out;
+}
+
+// ---- output ----------------------------------------------------------------
+
+static uint64_t align_up(uint64_t v) {
+    return (v + BMESH_ALIGN - 1) & ~(uint64_t)(BMESH_ALIGN - 1);
+}
+
+static int16_t snorm16(float v) {
+    v = std::max(-1.0f, std::min(1.0f, v));
+    return (int16_t)std::lround(v * 32767.0f);
+}
+
+static bool write_bmesh(const char* path, const Model& m) {
+    // Renumber vertices in first-use order for fetch locality.
+    std::vector<uint32_t> remap(m.vertices.size(), UINT32_MAX);
+    std::vector<BMeshVertex> verts;
+    verts.reserve(m.vertices.size());
+    std::vector<uint32_t> indices;
+    std::vector<BMeshSubmesh> subs;
+    for (const auto& sm : m.submeshes) {
+        BMeshSubmesh s{};
+        s.first_index = (uint32_t)indices.size();
+        s.index_count = (uint32_t)sm.indices.size();
+        s.bounds_min[0] = s.bounds_min[1] = s.bounds_min[2] = INFINITY;
+        s.bounds_max[0] = s.bounds_max[1] = s.bounds_max[2] = -INFINITY;
+        for (uint32_t i : sm.indices) {
+            if (remap[i] == UINT32_MAX) {
+                remap[i] = (uint32_t)verts.size();
+                const SrcVertex& src = m.vertices[i];
+                Vec3 n = normalize(src.normal);
+                BMeshVertex v{};
+                v.position[0] = src.pos.x;
+                v.position[1] = src.pos.y;
+                v.position[2] = src.pos.z;
+                v.normal[0] = snorm16(n.x);
+                v.normal[1] = snorm16(n.y);
+                v.normal[2] = snorm16(n.z);
+                v.normal[3] = 0;
+                v.uv[0] = half_from_float(src.uv[0]);
+                v.uv[1] = half_from_float(src.uv[1]);
+                verts.push_back(v);
+            }
+            indices.push_back(remap[i]);
+            const float p[3] = { m.vertices[i].pos.x, m.vertices[i].pos.y, m.vertices[i].pos.z };
+            for (int k = 0; k < 3; k++) {
+                s.bounds_min[k] = std::min(s.bounds_min[k], p[k]);
+                s.bounds_max[k] = std::max(s.bounds_max[k], p[k]);
+            }
+        }
+        subs.push_back(s);
+    }
+
+    uint32_t index_size = verts.size() <= 0xffff ? 2 : 4;
+    BMeshHeader h{};
+    h.magic = BMESH_MAGIC;
+    h.version = BMESH_VERSION;
+    h.vertex_count = (uint32_t)verts.size();
+    h.index_count = (uint32_t)indices.size();
+    h.index_size = index_size;
+    h.stream_count = 1;
+    h.submesh_count = (uint32_t)subs.size();
+    h.streams_offset = align_up(sizeof(h));
+    h.submeshes_offset = align_up(h.streams_offset + sizeof(BMeshStream));
+    BMeshStream st{};
+    st.stride = sizeof(BMeshVertex);
+    st.offset = align_up(h.submeshes_offset + subs.size() * sizeof(BMeshSubmesh));
+    st.size = verts.size() * sizeof(BMeshVertex);
+    h.indices_offset = align_up(st.offset + st.size);
+    h.file_size = h.indices_offset + (uint64_t)indices.size() * index_size;
+
+    std::vector<uint8_t> file((size_t)h.file_size, 0);
+    std::memcpy(&file[0], &h, sizeof(h));
+    std::memcpy(&file[h.streams_offset], &st, sizeof(st));
+    if (!subs.empty()) std::memcpy(&file[h.submeshes_offset], subs.data(), subs.size() * sizeof(BMeshSubmesh));
+    std::memcpy(&file[st.offset], verts.data(), st.size);
+    for (size_t i = 0; i < indices.size(); i++) {
+        if (index_size == 2) {
+            uint16_t v = (uint16_t)indices[i];
+            std::memcpy(&file[h.indices_offset + i * 2], &v, 2);
+        } else {
+            std::memcpy(&file[h.indices_offset + i * 4], &indices[i], 4);
+        }
+    }
+    FILE* f = std::fopen(path, "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(file.data(), 1, file.size(), f) == file.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+static void usage() {
+    std::fprintf(stderr, "usage: meshconv input.obj output.bmesh [--no-reorder] [--no-overdraw] [--cache N] [--overdraw-threshold F]\n");
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+    Options opt;
+    for (int i = 3; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "--no-reorder") opt.reorder = false;
+        else if (a == "--no-overdraw") opt.overdraw = false;
+        else if (a == "--cache" && i + 1 < argc) opt.cache_size = (uint32_t)std::max(4, std::atoi(argv[++i]));
+        else if (a == "--overdraw-threshold" && i + 1 < argc) opt.overdraw_threshold = (float)std::atof(argv[++i]);
+        else { usage(); return 1; }
+    }
+
+    Model m;
+    if (!load_obj(argv[1], m)) {
+        std::fprintf(stderr, "meshconv: cannot read %s\n", argv[1]);
+        return 1;
+    }
+    if (!m.has_normals) compute_normals(m);
+
+    for (auto& sm : m.submeshes) {
+        float before = acmr(sm.indices, opt.cache_size);
+        if (opt.reorder) sm.indices = forsyth_reorder(sm.indices, (uint32_t)m.vertices.size());
+        float reordered = acmr(sm.indices, opt.cache_size);
+        if (opt.reorder && opt.overdraw) sm.indices = overdraw_reorder(sm.indices, m.vertices, opt.cache_size, opt.overdraw_threshold);
+        float after = acmr(sm.indices, opt.cache_size);
+        std::printf("%s: %zu tris, ACMR %.3f -> %.3f (cache order) -> %.3f (overdraw order)\n",
+            sm.name.c_str(), sm.indices.size() / 3, before, reordered, after);
+    }
+
+    if (!write_bmesh(argv[2], m)) {
+        std::fprintf(stderr, "meshconv: cannot write %s\n", argv[2]);
+        return 1;
+    }
+    return 0;
+}